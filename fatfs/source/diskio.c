@@ -17,6 +17,7 @@
 #include "ffconf.h"     /* FatFs configuration options */
 #include "ff.h"			/* Obtains integer types */
 #include "diskio.h"		/* Declarations of disk functions */
+#include "sector_cache.h"	/* FAT and directory sectors kept in RAM */
 
 #ifdef RAM_DISK_ENABLE
 #include "fsl_ram_disk.h"
@@ -28,6 +29,7 @@
 
 #ifdef SD_DISK_ENABLE
 #include "fsl_sd_disk.h"
+#include "sd_async.h"		/* Non-blocking transfers sharing the host */
 #endif
 
 #ifdef MMC_DISK_ENABLE
@@ -145,7 +147,7 @@ DSTATUS disk_initialize (
 /* Read Sector(s)                                                        */
 /*-----------------------------------------------------------------------*/
 
-DRESULT disk_read (
+static DRESULT disk_read_media (
 	BYTE pdrv,		/* Physical drive nmuber to identify the drive */
 	BYTE *buff,		/* Data buffer to store read data */
 	LBA_t sector,	/* Start sector in LBA */
@@ -167,6 +169,7 @@ DRESULT disk_read (
 #endif
 #ifdef SD_DISK_ENABLE
         case SDDISK:
+            sd_async_wait();	/* Card and host free for this transfer */
             res = sd_disk_read(pdrv, buff, sector, count);
             return res;
 #endif
@@ -200,7 +203,7 @@ DRESULT disk_read (
 /*-----------------------------------------------------------------------*/
 
 #if FF_FS_READONLY == 0
-DRESULT disk_write (
+static DRESULT disk_write_media (
 	BYTE pdrv,			/* Physical drive nmuber to identify the drive */
 	const BYTE *buff,	/* Data to be written */
 	LBA_t sector,		/* Start sector in LBA */
@@ -222,6 +225,7 @@ DRESULT disk_write (
 #endif
 #ifdef SD_DISK_ENABLE
         case SDDISK:
+            sd_async_wait();	/* Card and host free for this transfer */
             res = sd_disk_write(pdrv, buff, sector, count);
             return res;
 #endif
@@ -249,6 +253,57 @@ DRESULT disk_write (
 #endif
 
 
+/*-----------------------------------------------------------------------*/
+/* Sector cache between FatFs and the drives (sector_cache.h)            */
+/*-----------------------------------------------------------------------*/
+
+#if SECTOR_CACHE_ENTRIES > 0
+int sector_cache_media_read (uint8_t drive, uint8_t *buf, uint32_t sector, uint32_t count)
+{
+    return (int)disk_read_media(drive, buf, (LBA_t)sector, (UINT)count);
+}
+
+int sector_cache_media_write (uint8_t drive, const uint8_t *buf, uint32_t sector, uint32_t count)
+{
+#if FF_FS_READONLY == 0
+    return (int)disk_write_media(drive, buf, (LBA_t)sector, (UINT)count);
+#else
+    return (int)RES_WRPRT;
+#endif
+}
+#endif
+
+DRESULT disk_read (
+	BYTE pdrv,		/* Physical drive nmuber to identify the drive */
+	BYTE *buff,		/* Data buffer to store read data */
+	LBA_t sector,	/* Start sector in LBA */
+	UINT count		/* Number of sectors to read */
+)
+{
+#if SECTOR_CACHE_ENTRIES > 0
+    return (DRESULT)sector_cache_read(pdrv, buff, (uint32_t)sector, count);
+#else
+    return disk_read_media(pdrv, buff, sector, count);
+#endif
+}
+
+#if FF_FS_READONLY == 0
+DRESULT disk_write (
+	BYTE pdrv,			/* Physical drive nmuber to identify the drive */
+	const BYTE *buff,	/* Data to be written */
+	LBA_t sector,		/* Start sector in LBA */
+	UINT count			/* Number of sectors to write */
+)
+{
+#if SECTOR_CACHE_ENTRIES > 0
+    return (DRESULT)sector_cache_write(pdrv, buff, (uint32_t)sector, count);
+#else
+    return disk_write_media(pdrv, buff, sector, count);
+#endif
+}
+#endif
+
+
 /*-----------------------------------------------------------------------*/
 /* Miscellaneous Functions                                               */
 /*-----------------------------------------------------------------------*/
@@ -260,6 +315,17 @@ DRESULT disk_ioctl (
 )
 {
 	DRESULT res;
+#if SECTOR_CACHE_ENTRIES > 0
+    if (cmd == CTRL_SYNC)
+    {
+        /* Dirty FAT and directory sectors first, then the drive's own sync */
+        res = (DRESULT)sector_cache_flush(pdrv);
+        if (res != RES_OK)
+        {
+            return res;
+        }
+    }
+#endif
     switch (pdrv)
     {
 #ifdef RAM_DISK_ENABLE
@@ -274,6 +340,7 @@ DRESULT disk_ioctl (
 #endif
 #ifdef SD_DISK_ENABLE
         case SDDISK:
+            sd_async_wait();	/* Card and host free for this transfer */
             res = sd_disk_ioctl(pdrv, cmd, buff);
             return res;
 #endif
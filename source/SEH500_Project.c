@@ -15,171 +15,481 @@
 #include "fsl_clock.h"
 #include "fsl_common.h"
 #include "fsl_uart.h"
-
-// External assembly function prototypes
-void setup_leds(void);
-void func_green_led_on(void);
-void func_green_led_off(void);
-void func_red_led_on(void);
-void func_red_led_off(void);
+#include "cycle_counter.h"
+#include "event_queue.h"
+#include "trace_log.h"
+#include "alert_fsm.h"
+#include "timer_service.h"
+#include "latency_probe.h"
+#include "latency_bench.h"
+#include "power_governor.h"
+#include "clock_mode.h"
+#include "led_driver.h"
+#include "sd_storage.h"
+#include "sd_async.h"
+#include "audio_player.h"
+#include "audio_mixer.h"
+#include "boot_sequence.h"
 
 // Forward declarations
 static void setup_button_interrupts(void);
 static void setup_uart_interrupts(void);
-static void handle_water_alert(void);
-static void handle_washroom_alert(void);
+static void apply_alert_input(alert_id_t input, const app_event_t *event);
+static void adjust_alert_volume(uint8_t ch);
+static void handle_event(const app_event_t *event);
+static void handle_keyboard_input(const app_event_t *event);
+static void wake_console(void);
+static void post_button_events(uint32_t port_index, GPIO_Type *gpio);
+static void debounce_timer_callback(sw_timer_t *timer, void *arg);
+static void print_startup_report(void);
+static bool boot_events(void);
+static bool boot_pins(void);
+static bool boot_buttons(void);
+static bool boot_clocks(void);
+static bool boot_peripherals(void);
+static bool boot_console(void);
+static bool boot_keyboard(void);
+static bool boot_timers(void);
+static bool boot_leds(void);
+static bool boot_audio(void);
+static bool boot_audio_done(void);
+static bool boot_power(void);
+static bool boot_clip_bank(void);
+static bool boot_clock_mode(void);
+
+// Alert categories - one entry per need. Adding a need is one line here
+// plus its log messages in trace_messages.h; no new handler or ISR branch.
+enum {
+    ALERT_WATER = 0,
+    ALERT_WASHROOM,
+    ALERT_COUNT
+};
 
-// System states
-typedef enum {
-    STATE_IDLE = 0,
-    STATE_WATER_ALERT,
-    STATE_WASHROOM_ALERT
-} system_state_t;
+static const alert_descriptor_t alert_table[ALERT_COUNT] = {
+    [ALERT_WATER] = {
+        .name = "Water", .button = ALERT_BUTTON_SW2, .key = 'W',
+        .led = LED_GREEN, .led_pattern = LED_PATTERN_BLINK,
+        .audio_clip = 0U, .priority = 1U,
+        .msg_button = MSG_BUTTON_SW2, .msg_key = MSG_KEY_WATER,
+        .msg_started = MSG_WATER_STARTED, .msg_cancelled = MSG_WATER_CANCELLED,
+    },
+    [ALERT_WASHROOM] = {
+        .name = "Washroom", .button = ALERT_BUTTON_SW3, .key = 'T',
+        .led = LED_RED, .led_pattern = LED_PATTERN_BLINK,
+        .audio_clip = 1U, .priority = 1U,
+        .msg_button = MSG_BUTTON_SW3, .msg_key = MSG_KEY_WASHROOM,
+        .msg_started = MSG_WASHROOM_STARTED, .msg_cancelled = MSG_WASHROOM_CANCELLED,
+    },
+};
 
 // Global variables
-volatile static system_state_t current_state = STATE_IDLE;
-volatile static int led_blink_state = 0;  // 0 = OFF, 1 = ON
+// Per alert (each has at most one button): a press locks only its own
+// button for the bounce, so another button pressed meanwhile still counts
+static sw_timer_t debounce_timers[ALERT_COUNT];
+static volatile bool button_locked[ALERT_COUNT];
+
+#define BUTTON_DEBOUNCE_MS    150U
+#define ALERT_REPEAT_MS       10000U  // Gap before an active alert's clip is played again
+
+// Clip volume per alert (0..AUDIO_VOLUME_MAX, 3 dB steps), changed with '+'/'-'
+// while the alert plays; applied by the player's gain ramp, not the codec
+static uint8_t alert_volume[ALERT_COUNT];
+
+// Clips, indexed by alert_descriptor_t.audio_clip: IDs in the clip bank
+// (tools/asset_pack.c, packed in this order), or these WAV files on the
+// SD card when there is no bank
+#define CLIP_BANK_PATH SD_STORAGE_DRIVE "/clips.bnk"
+static const char *const audio_clips[] = {
+    SD_STORAGE_DRIVE "/water.wav",
+    SD_STORAGE_DRIVE "/restroom.wav",
+};
+static bool clip_bank_loaded = false;
+
+// Port/GPIO bases indexed by ALERT_BUTTON port index (PORTA..PORTE)
+static PORT_Type *const button_ports[] = PORT_BASE_PTRS;
+static GPIO_Type *const button_gpios[] = GPIO_BASE_PTRS;
+static const IRQn_Type button_irqs[] = PORT_IRQS;
 
-// Button pin definitions - Using onboard SW2 and SW3
-// SW2 is on PTD11 (Port D, pin 11) - Water button
-// SW3 is on PTA10 (Port A, pin 10) - Washroom button
-#define WATER_BUTTON_PORT      GPIOD
-#define WATER_BUTTON_PIN       11U
-#define WASHROOM_BUTTON_PORT   GPIOA
-#define WASHROOM_BUTTON_PIN    10U
+// Boot steps, in the order they run once their dependencies are met. The
+// inputs come first so a press is queued within microseconds of reset;
+// the SD mount is deferred to the main loop, and the codec powers up in
+// the background, so neither holds the buttons or console back.
+enum {
+    BOOT_EVENTS = 0,
+    BOOT_PINS,
+    BOOT_BUTTONS,
+    BOOT_CLOCKS,
+    BOOT_PERIPHERALS,
+    BOOT_CONSOLE,
+    BOOT_KEYBOARD,
+    BOOT_TIMERS,
+    BOOT_LEDS,
+    BOOT_AUDIO,
+    BOOT_POWER,
+    BOOT_SD,
+    BOOT_CLIP_BANK,
+    BOOT_CLOCK_MODE,
+    BOOT_STEP_COUNT
+};
+
+static const boot_step_t boot_steps[BOOT_STEP_COUNT] = {
+    [BOOT_EVENTS]      = {"events", boot_events, NULL, 0U, false},
+    [BOOT_PINS]        = {"pins", boot_pins, NULL, 0U, false},
+    [BOOT_BUTTONS]     = {"buttons", boot_buttons, NULL, BOOT_NEEDS(BOOT_EVENTS) | BOOT_NEEDS(BOOT_PINS), false},
+    [BOOT_CLOCKS]      = {"clocks", boot_clocks, NULL, 0U, false},
+    [BOOT_PERIPHERALS] = {"peripherals", boot_peripherals, NULL, BOOT_NEEDS(BOOT_CLOCKS), false},
+    [BOOT_CONSOLE]     = {"console", boot_console, NULL, BOOT_NEEDS(BOOT_PINS) | BOOT_NEEDS(BOOT_CLOCKS), false},
+    [BOOT_KEYBOARD]    = {"keyboard", boot_keyboard, NULL, BOOT_NEEDS(BOOT_EVENTS) | BOOT_NEEDS(BOOT_CONSOLE), false},
+    [BOOT_TIMERS]      = {"timers", boot_timers, NULL, BOOT_NEEDS(BOOT_CLOCKS), false},
+    [BOOT_LEDS]        = {"LEDs", boot_leds, NULL, BOOT_NEEDS(BOOT_TIMERS), false},
+    // Codec registers go out in the background; playback waits for it, nothing else does
+    [BOOT_AUDIO]       = {"codec", boot_audio, boot_audio_done, BOOT_NEEDS(BOOT_EVENTS) | BOOT_NEEDS(BOOT_TIMERS), false},
+    // LLWU wake-up pins: after the inputs they wake on
+    [BOOT_POWER]       = {"power", boot_power, NULL, BOOT_NEEDS(BOOT_BUTTONS) | BOOT_NEEDS(BOOT_KEYBOARD), false},
+    // f_mount blocks for tens of milliseconds: main loop, inputs already live
+    [BOOT_SD]          = {"SD card", sd_storage_init, NULL, BOOT_NEEDS(BOOT_CLOCKS), true},
+    // Flash bank, or the index of the one on the card (fails over to WAV files)
+    [BOOT_CLIP_BANK]   = {"clip bank", boot_clip_bank, NULL, BOOT_NEEDS(BOOT_SD), true},
+    // Leaves the boot HSRUN clock, so only once the SD card and codec no longer need it
+    [BOOT_CLOCK_MODE]  = {"clock mode", boot_clock_mode, NULL,
+                          BOOT_NEEDS(BOOT_CLIP_BANK) | BOOT_NEEDS(BOOT_AUDIO) | BOOT_NEEDS(BOOT_CONSOLE), false},
+};
 
 int main(void) {
+    boot_sequence_start();  // Cycle counter first: it times every step after it
+    boot_sequence_run(boot_steps, BOOT_STEP_COUNT);
+    bool booting = true;
+
+    while(1) {
+        // Run the state machine for everything the ISRs posted
+        app_event_t event;
+        while (event_queue_pop(&event)) {
+            handle_event(&event);
+        }
+        trace_log_flush();  // Stream binary log records (no-op in text mode)
+
+        // Finish booting between events; no sleeping meanwhile, the boot
+        // timeline is kept by the cycle counter, which stops with the core
+        if (booting) {
+            booting = boot_sequence_service();
+            if (!booting) {
+                print_startup_report();
+            }
+            continue;
+        }
+        clock_mode_update();  // Drop to a slower run mode once demand has gone
+
+        // A card still programming after a write is polled, not waited on
+        if (sd_async_service()) {
+            continue;
+        }
+
+        // Card reads for the playing clips start here, between events, so a
+        // refill only copies from RAM; the card moves the data while events run
+        if (audio_player_read_ahead()) {
+            continue;
+        }
+
+        // Sleep only if nothing arrived since the last check. With interrupts masked,
+        // a pending IRQ still wakes the core, and it runs as soon as they are re-enabled.
+        __disable_irq();
+        if (event_queue_is_empty()) {
+            power_governor_idle();  // WAIT, or LLS when only the buttons need to wake the system
+        }
+        __enable_irq();
+    }
+    return 0;
+}
+
+// Boot steps (see boot_steps); each returns false only if its part is unusable
+static bool boot_events(void) {
+    event_queue_init();
+    alert_fsm_init(alert_table, ALERT_COUNT);
+    for (alert_id_t id = 0; id < ALERT_COUNT; id++) {
+        alert_volume[id] = AUDIO_VOLUME_MAX;
+    }
+    return true;
+}
+
+static bool boot_pins(void) {
     BOARD_InitBootPins();
+    return true;
+}
+
+static bool boot_buttons(void) {
+    setup_button_interrupts();  // Presses queue from here on; handled once the main loop runs
+    return true;
+}
+
+static bool boot_clocks(void) {
     BOARD_InitBootClocks();
+    return true;
+}
+
+static bool boot_peripherals(void) {
     BOARD_InitBootPeripherals();
+    return true;
+}
+
+static bool boot_console(void) {
     BOARD_InitDebugConsole();
+    return true;
+}
 
-    PRINTF("=== Assistive Audio-Visual Communicator ===\r\n");
-    PRINTF("Initializing system...\r\n");
-
-    // Setup onboard RGB LEDs using assembly functions
-    setup_leds();
-    func_green_led_off();
-    func_red_led_off();
-    PRINTF("Onboard LEDs initialized (Green=Water, Red=Washroom)\r\n");
-
-    // The following section (lines 67-74) was implemented using GenAI assistance
-    // Initialize PIT timer for LED flicker (500ms intervals)
-    pit_config_t pitConfig;
-    PIT_GetDefaultConfig(&pitConfig);
-    PIT_Init(PIT, &pitConfig);
-    PIT_SetTimerPeriod(PIT, kPIT_Chnl_0, USEC_TO_COUNT(500000U, CLOCK_GetFreq(kCLOCK_BusClk))); // 500ms
-    PIT_EnableInterrupts(PIT, kPIT_Chnl_0, kPIT_TimerInterruptEnable);
-    EnableIRQ(PIT0_IRQn);
-    PRINTF("Timer initialized (500ms LED flicker)\r\n");
-
-    // Setup GPIO interrupts for buttons
-    setup_button_interrupts();
-    PRINTF("Button interrupts configured\r\n");
-
-    // Setup UART interrupts for keyboard input (optimized - no polling!)
+static bool boot_keyboard(void) {
     setup_uart_interrupts();
-    PRINTF("UART interrupts configured (keyboard input)\r\n");
+    return true;
+}
+
+// Software timers (debounce, ...) share PIT channel 0 in tickless mode
+static bool boot_timers(void) {
+    timer_service_init();
+    return true;
+}
+
+// Onboard LEDs: patterns are paced by PIT1/PIT2 and written by eDMA
+static bool boot_leds(void) {
+    led_driver_init();
+    return true;
+}
+
+static bool boot_audio(void) {
+    return audio_player_init();
+}
+
+static bool boot_audio_done(void) {
+    return !audio_player_is_starting();
+}
+
+// Idle governor: WAIT while timers run or the console listens, LLS otherwise
+static bool boot_power(void) {
+    power_governor_init();
+    return true;
+}
+
+static bool boot_clip_bank(void) {
+    clip_bank_loaded = (audio_player_load_bank(CLIP_BANK_PATH) != 0U);
+    return clip_bank_loaded;
+}
 
-    PRINTF("System ready.\r\n");
+// Leave the boot HSRUN clock; nothing needs full speed until audio or SD starts
+static bool boot_clock_mode(void) {
+    clock_mode_init();
+    return true;
+}
+
+// Printed once boot is complete, so the console never holds a step up
+static void print_startup_report(void) {
+    PRINTF("=== Assistive Audio-Visual Communicator ===\r\n");
+    PRINTF("System ready after %lu us (buttons live throughout, 'B' for the boot timeline)\r\n",
+           boot_sequence_total_us());
+    if (!sd_storage_ready() && !clip_bank_loaded) {
+        PRINTF("SD card not found - alerts will be silent\r\n");
+    } else if (!audio_player_is_ready()) {
+        PRINTF("Audio codec not responding - alerts will be silent\r\n");
+    } else {
+        PRINTF("Clips from %s\r\n", clip_bank_loaded ? "the clip bank" : "WAV files on the SD card");
+    }
     PRINTF("SW2 - Toggle water alert (Green LED flicker)\r\n");
     PRINTF("SW3 - Toggle washroom alert (Red LED flicker)\r\n");
     PRINTF("Keyboard: 'W' - Water alert, 'T' - Washroom alert\r\n");
-    PRINTF("All inputs now use interrupts (optimized - no polling!)\r\n");
+    PRINTF("Keyboard: 'P' - Power mode report\r\n");
+    PRINTF("Keyboard: 'Z' - Console sleep (LLS until a button press)\r\n");
+    PRINTF("Keyboard: 'C' - Toggle full-speed clock hold, clock mode report\r\n");
+    PRINTF("Keyboard: 'A' - Audio stream report\r\n");
+    PRINTF("Keyboard: 'B' - Boot timeline\r\n");
+    PRINTF("Keyboard: 'S' - SD storage report (seek benchmark with SD_SEEK_BENCH)\r\n");
+    PRINTF("Keyboard: 'K' - Button-to-sound benchmark (start/stop)\r\n");
+    PRINTF("Keyboard: '+'/'-' - Active alert's volume up/down\r\n");
+#if LATENCY_PROBE_ENABLE
+    PRINTF("Keyboard: 'L' - Latency report (ns)\r\n");
+#endif
+}
 
-    while(1) {
-        __WFI();  // Wait For Interrupt - CPU enters low-power mode until interrupt occurs // __WFI() clarified by GenAI
+// Dispatch one deferred event (runs in main loop, never in interrupt context)
+static void handle_event(const app_event_t *event) {
+    switch (event->source) {
+        case EVENT_SOURCE_BUTTON: {
+            alert_id_t input = alert_fsm_button_to_input(event->payload);
+            if (input != ALERT_NONE && !button_locked[input]) {
+                // Contact bounce produces extra edges right after a press
+                button_locked[input] = true;
+                timer_service_start(&debounce_timers[input], BUTTON_DEBOUNCE_MS, 0U, debounce_timer_callback,
+                                    (void *)(uintptr_t)input);
+                LOG0(alert_fsm_descriptor(input)->msg_button);
+                wake_console();
+                apply_alert_input(input, event);
+            }
+            break;
+        }
+        case EVENT_SOURCE_UART_RX:
+            if (event->payload != 'Z' && event->payload != 'z') {
+                wake_console();
+            }
+            handle_keyboard_input(event);
+            break;
+        case EVENT_SOURCE_AUDIO:
+            audio_player_handle_event(event->payload);  // Refill SD -> SAI buffers
+            break;
+        case EVENT_SOURCE_STORAGE:
+            (void)sd_async_service();  // Next run of blocks, or the transfer's callback
+            break;
+        default:
+            break;
+    }
+
+    uint32_t dropped = event_queue_dropped();
+    static uint32_t reported_drops = 0;
+    if (dropped != reported_drops) {
+        LOG1(MSG_EVENTS_DROPPED, dropped - reported_drops);
+        reported_drops = dropped;
     }
-    return 0;
 }
 
-// Shared function to handle water alert (called from button or keyboard)
-static void handle_water_alert(void) {
-    if (current_state == STATE_WATER_ALERT) {
-        // Cancel water alert (same command again)
-        current_state = STATE_IDLE;
-        func_green_led_off();
-        func_red_led_off();  // Ensure red is also off
-        led_blink_state = 0;
-        PIT_StopTimer(PIT, kPIT_Chnl_0);
-        PRINTF("Water alert cancelled (LED flicker OFF)\r\n");
-    } else {
-        // Start water alert (cancel any other alert first)
-        if (current_state == STATE_WASHROOM_ALERT) {
-            func_red_led_off();
-            PRINTF("Cancelled washroom alert, starting water alert\r\n");
-        }
-        current_state = STATE_WATER_ALERT;
-        func_green_led_on();
-        led_blink_state = 1;
-        PIT_StartTimer(PIT, kPIT_Chnl_0);
-        PRINTF("Water alert started (Green LED flicker ON)\r\n");
+// A button press or a key received puts the console back on the wake
+// sources after 'Z'
+static void wake_console(void) {
+    if (!power_governor_console_wake()) {
+        power_governor_set_console_wake(true);
+        PRINTF("[POWER] Console awake\r\n");
     }
 }
 
-// SW2 button interrupt handler (PTD11) - Water button
-// Handler name must match the interrupt vector table: PORTD_IRQHandler
-void PORTD_IRQHandler(void) {
-    GPIO_PortClearInterruptFlags(WATER_BUTTON_PORT, 1U << WATER_BUTTON_PIN); // line 123 clarified by GenAI
-    PRINTF("[BUTTON PRESS] SW2 pressed!\r\n");
-    handle_water_alert();
+// Process one keyboard command received on UART0
+static void handle_keyboard_input(const app_event_t *event) {
+    uint8_t ch = event->payload;
+    alert_id_t input = alert_fsm_key_to_input(ch);
+    if (input != ALERT_NONE) {
+        LOG0(alert_fsm_descriptor(input)->msg_key);
+        apply_alert_input(input, event);
+    } else if (ch == 'P' || ch == 'p') {
+        power_governor_dump();  // Sleep mode counts and wake-up latency
+    } else if (ch == 'Z' || ch == 'z') {
+        // Console sleep: idle in LLS; keys typed meanwhile are not received
+        power_governor_set_console_wake(false);
+        PRINTF("[POWER] Console asleep - press a button to wake it\r\n");
+    } else if (ch == 'C' || ch == 'c') {
+        // Hold HSRUN from the console (exercises the switch path), then report
+        bool hold = (clock_mode_current() != CLOCK_MODE_HSRUN);
+        clock_mode_request(CLOCK_CLIENT_CONSOLE, hold ? CLOCK_MODE_HSRUN : CLOCK_MODE_VLPR);
+        clock_mode_dump();
+    } else if (ch == 'A' || ch == 'a') {
+        audio_player_dump();  // Clips, buffers streamed, underruns, refill cost
+    } else if (ch == '+' || ch == '-') {
+        adjust_alert_volume(ch);
+    } else if (ch == 'B' || ch == 'b') {
+        boot_sequence_dump();  // Boot timeline
+    } else if (ch == 'S' || ch == 's') {
+        sd_storage_dump();  // Link maps; RAM disk seek timings with and without one
+    } else if (ch == 'K' || ch == 'k') {
+        latency_bench_toggle(alert_table[ALERT_WATER].button);  // Synthetic SW2 presses, button-to-sound percentiles
+#if LATENCY_PROBE_ENABLE
+    } else if (ch == 'L' || ch == 'l') {
+        LATENCY_DUMP();  // Latency statistics since boot
+#endif
+    } else if (ch != '\r' && ch != '\n') {
+        // Ignore carriage return and newline, but echo other characters
+        LOG2(MSG_KEY_IGNORED, ch, ch);
+    }
 }
 
-// Shared function to handle washroom alert (called from button or keyboard)
-static void handle_washroom_alert(void) {
-    if (current_state == STATE_WASHROOM_ALERT) {
-        // Cancel washroom alert (same command again)
-        current_state = STATE_IDLE;
-        func_red_led_off();
-        func_green_led_off();  // Ensure green is also off
-        led_blink_state = 0;
-        PIT_StopTimer(PIT, kPIT_Chnl_0);
-        PRINTF("Washroom alert cancelled (LED flicker OFF)\r\n");
-    } else {
-        // Start washroom alert (cancel any other alert first)
-        if (current_state == STATE_WATER_ALERT) {
-            func_green_led_off();
-            PRINTF("Cancelled water alert, starting washroom alert\r\n");
+// Shared function to handle any alert input (called from button or keyboard)
+// Runs in the main loop; the LED/state update is masked so no interrupt sees it half done
+static void apply_alert_input(alert_id_t input, const app_event_t *event) {
+    uint32_t primask = DisableGlobalIRQ();
+    alert_transition_t t = alert_fsm_dispatch(input);
+    LATENCY_RECORD((event->source == EVENT_SOURCE_BUTTON) ? LATENCY_BUTTON_TO_STATE : LATENCY_KEY_TO_STATE,
+                   event->timestamp);
+    latency_bench_state();
+    const alert_descriptor_t *from = alert_fsm_descriptor(t.from);
+    const alert_descriptor_t *to = alert_fsm_descriptor(t.to);
+
+    if (t.action != ALERT_ACTION_IGNORE) {
+        if (from != NULL) {
+            led_driver_stop((led_id_t)from->led);  // Previous alert's LED (cancel or switch)
+        }
+        if (to != NULL) {
+            // First step is on the pin now; eDMA plays the rest with no interrupts
+            led_driver_play((led_id_t)to->led, (led_pattern_t)to->led_pattern);
         }
-        current_state = STATE_WASHROOM_ALERT;
-        func_red_led_on();
-        led_blink_state = 1;
-        PIT_StartTimer(PIT, kPIT_Chnl_0);
-        PRINTF("Washroom alert started (Red LED flicker ON)\r\n");
+        LATENCY_RECORD((event->source == EVENT_SOURCE_BUTTON) ? LATENCY_BUTTON_TO_LED : LATENCY_KEY_TO_LED,
+                       event->timestamp);
+    }
+    EnableGlobalIRQ(primask);
+
+    // Audio streams from the SD card, so it starts outside the critical section
+    bool starting = (t.action != ALERT_ACTION_IGNORE && to != NULL);
+    bool started = false;
+    if (starting && clip_bank_loaded) {
+        started = audio_player_play_clip(0U, to->audio_clip, ALERT_REPEAT_MS, audio_volume_gain(alert_volume[t.to]));
+    } else if (starting) {
+        started = audio_player_play_voice(0U, audio_clips[to->audio_clip], ALERT_REPEAT_MS,
+                                          audio_volume_gain(alert_volume[t.to]));
+    } else if (t.action != ALERT_ACTION_IGNORE) {
+        audio_player_stop();
+    }
+    latency_bench_input(starting, started);
+
+    // Logging happens after the critical section so it never blocks interrupts
+    switch (t.action) {
+        case ALERT_ACTION_START:
+            LOG0(to->msg_started);
+            break;
+        case ALERT_ACTION_CANCEL:
+            LOG0(from->msg_cancelled);
+            break;
+        case ALERT_ACTION_SWITCH:
+            LOG2(MSG_ALERT_SWITCHED, t.from, t.to);
+            LOG0(to->msg_started);
+            break;
+        default:
+            LOG1(MSG_ALERT_IGNORED, input);
+            break;
     }
 }
 
+// Step the active alert's volume; the playing clip ramps to it, and it sticks for next time
+static void adjust_alert_volume(uint8_t ch) {
+    alert_id_t active = alert_fsm_active();
+    if (active == ALERT_NONE) {
+        LOG2(MSG_KEY_IGNORED, ch, ch);
+        return;
+    }
+    if (ch == '+' && alert_volume[active] < AUDIO_VOLUME_MAX) {
+        alert_volume[active]++;
+    } else if (ch == '-' && alert_volume[active] > 0U) {
+        alert_volume[active]--;
+    }
+    audio_player_set_gain(0U, audio_volume_gain(alert_volume[active]));
+    LOG2(MSG_ALERT_VOLUME, active, alert_volume[active]);
+}
+
+// Post one event per pending button pin on a port (shared by the PORTx ISRs)
+static void post_button_events(uint32_t port_index, GPIO_Type *gpio) {
+    uint32_t flags = GPIO_PortGetInterruptFlags(gpio);
+    GPIO_PortClearInterruptFlags(gpio, flags);
+    while (flags != 0U) {
+        uint32_t pin = 31U - __CLZ(flags);
+        flags &= ~(1U << pin);
+        event_queue_post(EVENT_SOURCE_BUTTON, ALERT_BUTTON(port_index, pin));  // Deferred to main loop
+    }
+}
+
+// SW2 button interrupt handler (PTD11) - Water button
+// Handler name must match the interrupt vector table: PORTD_IRQHandler
+void PORTD_IRQHandler(void) {
+    post_button_events(3U, GPIOD);
+}
 
 // SW3 button interrupt handler (PTA10) - Washroom button
 // Handler name must match the interrupt vector table: PORTA_IRQHandler
 void PORTA_IRQHandler(void) {
-    GPIO_PortClearInterruptFlags(WASHROOM_BUTTON_PORT, 1U << WASHROOM_BUTTON_PIN); // line 156 clarified by GenAI
-    PRINTF("[BUTTON PRESS] SW3 pressed!\r\n");
-    handle_washroom_alert();
+    post_button_events(0U, GPIOA);
 }
 
-// PIT Timer interrupt handler - triggers every 500ms for LED flicker
-void PIT0_IRQHandler(void) {
-    PIT_ClearStatusFlags(PIT, kPIT_Chnl_0, kPIT_TimerFlag); // line 164 clarified by GenAI
-    
-    // Toggle LED blink state (every 500ms)
-    if (current_state == STATE_WATER_ALERT) {
-        if (led_blink_state == 0) {
-            func_green_led_on();
-            led_blink_state = 1;
-        } else {
-            func_green_led_off();
-            led_blink_state = 0;
-        }
-    } else if (current_state == STATE_WASHROOM_ALERT) {
-        if (led_blink_state == 0) {
-            func_red_led_on();
-            led_blink_state = 1;
-        } else {
-            func_red_led_off();
-            led_blink_state = 0;
-        }
-    }
+// Debounce timer callback - accept presses of that alert's button again
+static void debounce_timer_callback(sw_timer_t *timer, void *arg) {
+    button_locked[(uintptr_t)arg] = false;
 }
 
 // The following section (lines 189-210) was implemented using GenAI assistance
@@ -192,20 +502,11 @@ void UART0_RX_TX_IRQHandler(void) {
     
     // Check if data was received
     if (statusFlags & kUART_RxDataRegFullFlag) {
-        // Read character from UART receive register
+        // Read character from UART receive register (clears the flag)
         uint8_t ch = UART_ReadByte(uartBase);
         
-        // Process keyboard commands
-        if (ch == 'W' || ch == 'w') {
-            PRINTF("[KEYBOARD] 'W' pressed - Water alert\r\n");
-            handle_water_alert();
-        } else if (ch == 'T' || ch == 't') {
-            PRINTF("[KEYBOARD] 'T' pressed - Washroom alert\r\n");
-            handle_washroom_alert();
-        } else if (ch != '\r' && ch != '\n') {
-            // Ignore carriage return and newline, but echo other characters
-            PRINTF("[KEYBOARD] Received: '%c' (0x%02X) - ignored\r\n", ch, ch);
-        }
+        // Command processing is deferred to the main loop
+        event_queue_post(EVENT_SOURCE_UART_RX, ch);
     }
 }
 
@@ -215,11 +516,12 @@ void UART0_RX_TX_IRQHandler(void) {
 static void setup_button_interrupts(void) {
     port_pin_config_t portConfig;
     gpio_pin_config_t gpioConfig;
+    static const clock_ip_name_t portClocks[] = PORT_CLOCKS;
     
-    // Configure GPIO as input (same for both buttons)
+    // Configure GPIO as input (same for all buttons)
     gpioConfig.pinDirection = kGPIO_DigitalInput;
     
-    // Configure pin settings (same for both buttons)
+    // Configure pin settings (same for all buttons)
     portConfig.pullSelect = kPORT_PullUp;
     portConfig.slewRate = kPORT_FastSlewRate;
     portConfig.passiveFilterEnable = kPORT_PassiveFilterDisable;
@@ -228,23 +530,23 @@ static void setup_button_interrupts(void) {
     portConfig.mux = kPORT_MuxAsGpio;
     portConfig.lockRegister = kPORT_UnlockRegister;
     
-    // Configure SW2 (PTD11) - Water button
-    CLOCK_EnableClock(kCLOCK_PortD);
-    PORT_SetPinConfig(PORTD, WATER_BUTTON_PIN, &portConfig);
-    PORT_SetPinInterruptConfig(PORTD, WATER_BUTTON_PIN, kPORT_InterruptFallingEdge);
-    GPIO_PinInit(WATER_BUTTON_PORT, WATER_BUTTON_PIN, &gpioConfig);
-    
-    // Configure SW3 (PTA10) - Washroom button
-    CLOCK_EnableClock(kCLOCK_PortA);
-    PORT_SetPinConfig(PORTA, WASHROOM_BUTTON_PIN, &portConfig);
-    PORT_SetPinInterruptConfig(PORTA, WASHROOM_BUTTON_PIN, kPORT_InterruptFallingEdge);
-    GPIO_PinInit(WASHROOM_BUTTON_PORT, WASHROOM_BUTTON_PIN, &gpioConfig);
-    
-    // Enable NVIC interrupts
-    EnableIRQ(PORTD_IRQn);
-    EnableIRQ(PORTA_IRQn);
-    
-    PRINTF("Button interrupts configured: SW2(PTD11), SW3(PTA10)\r\n");
+    // One falling-edge input per alert that has a button
+    // (SW2 PTD11 - Water, SW3 PTA10 - Washroom)
+    for (alert_id_t id = 0; id < ALERT_COUNT; id++) {
+        uint8_t button = alert_table[id].button;
+        if (button == ALERT_NO_BUTTON) {
+            continue;
+        }
+        uint32_t port = ALERT_BUTTON_PORT(button);
+        uint32_t pin = ALERT_BUTTON_PIN(button);
+        CLOCK_EnableClock(portClocks[port]);
+        PORT_SetPinConfig(button_ports[port], pin, &portConfig);
+        PORT_SetPinInterruptConfig(button_ports[port], pin, kPORT_InterruptFallingEdge);
+        GPIO_PinInit(button_gpios[port], pin, &gpioConfig);
+        
+        // Enable NVIC interrupt for this port
+        EnableIRQ(button_irqs[port]);
+    }
 }
 
 // The following section (lines 253-263) was implemented using GenAI assistance
@@ -259,6 +561,4 @@ static void setup_uart_interrupts(void) {
     // Enable UART interrupt in NVIC (interrupt controller)
     // UART0_RX_TX_IRQn is interrupt number for UART0 on FRDM-K66F
     EnableIRQ(UART0_RX_TX_IRQn);
-    
-    PRINTF("UART RX interrupts enabled - keyboard input now interrupt-driven\r\n");
 }
\ No newline at end of file
@@ -0,0 +1,90 @@
+/*
+ * SEH500 Project - IMA-ADPCM block decoder
+ * See adpcm.h
+ */
+
+#include "adpcm.h"
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "fsl_common.h"  // CMSIS __SSAT
+#define ADPCM_CLAMP16(v) __SSAT((v), 16)
+#else
+#define ADPCM_CLAMP16(v) (((v) > INT16_MAX) ? INT16_MAX : ((v) < INT16_MIN) ? INT16_MIN : (v))
+#endif
+
+const int16_t adpcm_steps[ADPCM_STEP_COUNT] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,    25,    28,
+    31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,   337,   371,   408,   449,   494,
+    544,   598,   658,   724,   796,   876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,
+    9493,  10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+const int8_t adpcm_index_adjust[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+typedef struct {
+    int32_t pred;   // Last reconstructed sample
+    int32_t index;  // Step index
+} adpcm_channel_t;
+
+// Expand one 4-bit code: the magnitude bits add step, step/2 and step/4
+// to a step/8 base, bit 3 is the sign
+static inline int16_t adpcm_expand(adpcm_channel_t *ch, uint32_t code) {
+    int32_t step = adpcm_steps[ch->index];
+    int32_t diff = step >> 3;
+    if ((code & 4U) != 0U) {
+        diff += step;
+    }
+    if ((code & 2U) != 0U) {
+        diff += step >> 1;
+    }
+    if ((code & 1U) != 0U) {
+        diff += step >> 2;
+    }
+    int32_t pred = ((code & 8U) != 0U) ? (ch->pred - diff) : (ch->pred + diff);
+    ch->pred = ADPCM_CLAMP16(pred);
+
+    int32_t index = ch->index + adpcm_index_adjust[code];
+    ch->index = (index < 0) ? 0 : (index > (int32_t)(ADPCM_STEP_COUNT - 1U)) ? (int32_t)(ADPCM_STEP_COUNT - 1U) : index;
+    return (int16_t)ch->pred;
+}
+
+uint32_t adpcm_decode_block(const uint8_t *in, uint32_t len, uint32_t channels, int16_t *out) {
+    adpcm_channel_t state[2];
+
+    if (channels == 0U || channels > 2U || len < channels * ADPCM_HEADER_SIZE) {
+        return 0U;
+    }
+    for (uint32_t c = 0; c < channels; c++) {
+        const uint8_t *h = &in[c * ADPCM_HEADER_SIZE];
+        state[c].pred = (int16_t)((uint16_t)h[0] | ((uint16_t)h[1] << 8));
+        state[c].index = (h[2] < ADPCM_STEP_COUNT) ? h[2] : (ADPCM_STEP_COUNT - 1U);
+        out[c] = (int16_t)state[c].pred;
+    }
+    const uint8_t *p = &in[channels * ADPCM_HEADER_SIZE];
+    const uint8_t *end = &in[len];
+    uint32_t frames = 1U;
+
+    if (channels == 1U) {
+        for (; p < end; p++) {
+            out[frames++] = adpcm_expand(&state[0], *p & 0x0FU);
+            out[frames++] = adpcm_expand(&state[0], *p >> 4);
+        }
+        return frames;
+    }
+
+    // Stereo: 4 bytes of left then 4 of right cover 8 frames; a partial group is dropped
+    for (; (end - p) >= 8; p += 8) {
+        int16_t *o = &out[2U * frames];
+        for (uint32_t c = 0; c < 2U; c++) {
+            for (uint32_t i = 0; i < 4U; i++) {
+                uint8_t b = p[4U * c + i];
+                o[4U * i + c] = adpcm_expand(&state[c], b & 0x0FU);
+                o[4U * i + 2U + c] = adpcm_expand(&state[c], b >> 4);
+            }
+        }
+        frames += 8U;
+    }
+    return frames;
+}
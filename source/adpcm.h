@@ -0,0 +1,43 @@
+/*
+ * SEH500 Project - IMA-ADPCM block decoder
+ *
+ * Clips stored as WAVE_FORMAT_IMA_ADPCM (0x0011) take a quarter of the
+ * space of 16-bit PCM, so more phrases fit on the card (or in flash) and
+ * each DMA buffer costs a quarter of the reads. Files use the standard
+ * Microsoft/IMA block layout that sox, ffmpeg and tools/adpcm_encode.c
+ * produce: every block starts with a 4-byte header per channel (first
+ * sample, step index, reserved byte) and continues with 4-bit codes, low
+ * nibble first; stereo blocks alternate 4 bytes (8 samples) per channel.
+ * Blocks are self-contained, so decoding can start at any block.
+ *
+ * The decoder is plain C with no SDK header outside the SIMD path, so the
+ * host encoder links the same code to check its output bit for bit.
+ */
+
+#ifndef ADPCM_H_
+#define ADPCM_H_
+
+#include <stdint.h>
+
+#define WAV_FORMAT_IMA_ADPCM 0x0011U
+
+// Entries in adpcm_steps; step indexes run 0..ADPCM_STEP_COUNT-1
+#define ADPCM_STEP_COUNT 89U
+
+// Block header bytes per channel
+#define ADPCM_HEADER_SIZE 4U
+
+// Sample frames in a block of block_align bytes (the header sample counts as one)
+#define ADPCM_BLOCK_FRAMES(block_align, channels) \
+    ((((block_align) / (channels)) - ADPCM_HEADER_SIZE) * 2U + 1U)
+
+// Quantiser step sizes and the step index change for each 4-bit code
+extern const int16_t adpcm_steps[ADPCM_STEP_COUNT];
+extern const int8_t adpcm_index_adjust[16];
+
+// Decode one block of len bytes (len may be short for the last block of a
+// clip) into interleaved 16-bit samples. Returns the frames written, or 0
+// if the block is too short to hold its headers.
+uint32_t adpcm_decode_block(const uint8_t *in, uint32_t len, uint32_t channels, int16_t *out);
+
+#endif /* ADPCM_H_ */
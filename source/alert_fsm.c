@@ -0,0 +1,136 @@
+/*
+ * SEH500 Project - Table-driven alert state machine
+ * See alert_fsm.h
+ */
+
+#include <stddef.h>
+#include "alert_fsm.h"
+
+// How an input relates to the current state
+typedef enum {
+    ALERT_INPUT_FROM_IDLE = 0,  // Nothing active
+    ALERT_INPUT_SAME,           // Input belongs to the active alert
+    ALERT_INPUT_PREEMPTS,       // Different alert, priority >= active
+    ALERT_INPUT_LOWER,          // Different alert, priority < active
+    ALERT_INPUT_RELATION_COUNT
+} alert_input_relation_t;
+
+// Transition table: relation -> action (independent of the number of categories)
+static const uint8_t alert_transition_table[ALERT_INPUT_RELATION_COUNT] = {
+    [ALERT_INPUT_FROM_IDLE] = ALERT_ACTION_START,
+    [ALERT_INPUT_SAME]      = ALERT_ACTION_CANCEL,
+    [ALERT_INPUT_PREEMPTS]  = ALERT_ACTION_SWITCH,
+    [ALERT_INPUT_LOWER]     = ALERT_ACTION_IGNORE,
+};
+
+// What the active alert becomes for each action
+#define ALERT_NEXT_IDLE  ALERT_NONE
+#define ALERT_NEXT_INPUT 0xFEU
+#define ALERT_NEXT_KEEP  0xFDU
+static const uint8_t alert_next_state[] = {
+    [ALERT_ACTION_START]  = ALERT_NEXT_INPUT,
+    [ALERT_ACTION_CANCEL] = ALERT_NEXT_IDLE,
+    [ALERT_ACTION_SWITCH] = ALERT_NEXT_INPUT,
+    [ALERT_ACTION_IGNORE] = ALERT_NEXT_KEEP,
+};
+
+static const alert_descriptor_t *alert_table = NULL;
+static uint32_t alert_count = 0;
+static volatile alert_id_t active_alert = ALERT_NONE;
+
+// Input source -> alert ID, filled once at init so dispatch never searches
+static alert_id_t key_map[128];  // 7-bit ASCII
+static alert_id_t button_map[ALERT_BUTTON_COUNT];
+
+void alert_fsm_init(const alert_descriptor_t *table, uint32_t count) {
+    if (count > ALERT_MAX_CATEGORIES) {
+        count = ALERT_MAX_CATEGORIES;
+    }
+    alert_table = table;
+    alert_count = count;
+    active_alert = ALERT_NONE;
+
+    for (uint32_t i = 0; i < sizeof(key_map); i++) {
+        key_map[i] = ALERT_NONE;
+    }
+    for (uint32_t i = 0; i < sizeof(button_map); i++) {
+        button_map[i] = ALERT_NONE;
+    }
+    for (uint32_t id = 0; id < count; id++) {
+        if (table[id].button < ALERT_BUTTON_COUNT) {
+            button_map[table[id].button] = (alert_id_t)id;
+        }
+
+        uint8_t key = (uint8_t)table[id].key;
+        if (key == 0U || key >= sizeof(key_map)) {
+            continue;
+        }
+        key_map[key] = (alert_id_t)id;
+        // Accept both cases for letters
+        if (key >= 'a' && key <= 'z') {
+            key_map[key - 'a' + 'A'] = (alert_id_t)id;
+        } else if (key >= 'A' && key <= 'Z') {
+            key_map[key - 'A' + 'a'] = (alert_id_t)id;
+        }
+    }
+}
+
+alert_transition_t alert_fsm_dispatch(alert_id_t input) {
+    alert_transition_t result;
+    alert_id_t current = active_alert;
+
+    result.from = current;
+    result.to = current;
+    result.action = ALERT_ACTION_IGNORE;
+
+    if (input >= alert_count) {
+        return result;
+    }
+
+    // Classify the input against the current state (no loops over categories)
+    alert_input_relation_t relation;
+    if (current == ALERT_NONE) {
+        relation = ALERT_INPUT_FROM_IDLE;
+    } else if (current == input) {
+        relation = ALERT_INPUT_SAME;
+    } else if (alert_table[input].priority >= alert_table[current].priority) {
+        relation = ALERT_INPUT_PREEMPTS;
+    } else {
+        relation = ALERT_INPUT_LOWER;
+    }
+
+    result.action = (alert_action_t)alert_transition_table[relation];
+    uint8_t next = alert_next_state[result.action];
+    if (next == ALERT_NEXT_INPUT) {
+        result.to = input;
+    } else if (next == ALERT_NEXT_IDLE) {
+        result.to = ALERT_NONE;
+    }
+    active_alert = result.to;
+    return result;
+}
+
+alert_id_t alert_fsm_key_to_input(uint8_t ch) {
+    if (ch >= sizeof(key_map)) {
+        return ALERT_NONE;
+    }
+    return key_map[ch];
+}
+
+alert_id_t alert_fsm_button_to_input(uint8_t code) {
+    if (code >= ALERT_BUTTON_COUNT) {
+        return ALERT_NONE;
+    }
+    return button_map[code];
+}
+
+alert_id_t alert_fsm_active(void) {
+    return active_alert;
+}
+
+const alert_descriptor_t *alert_fsm_descriptor(alert_id_t id) {
+    if (id >= alert_count) {
+        return NULL;
+    }
+    return &alert_table[id];
+}
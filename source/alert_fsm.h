@@ -0,0 +1,79 @@
+/*
+ * SEH500 Project - Table-driven alert state machine
+ *
+ * Each need (water, washroom, ...) is one entry in a const descriptor array.
+ * The state is simply which alert is active (or none). Dispatch is O(1):
+ * the input ID indexes the descriptor array, one comparison classifies the
+ * input against the current state and a const table gives the action.
+ */
+
+#ifndef ALERT_FSM_H_
+#define ALERT_FSM_H_
+
+#include <stdint.h>
+#include "trace_messages.h"
+
+#define ALERT_MAX_CATEGORIES 32U
+#define ALERT_NONE           0xFFU  // State value when no alert is active
+
+// Button input code: port index (0 = PORTA ... 4 = PORTE) and pin number
+#define ALERT_BUTTON(port_index, pin) ((uint8_t)(((port_index) << 5) | (pin)))
+#define ALERT_BUTTON_PORT(code)       ((uint32_t)(code) >> 5)
+#define ALERT_BUTTON_PIN(code)        ((uint32_t)(code) & 0x1FU)
+#define ALERT_BUTTON_COUNT            (5U * 32U)
+#define ALERT_NO_BUTTON               0xFFU
+
+// The FRDM-K66F user buttons, shared by the alert table and the LLWU wake pins
+#define ALERT_BUTTON_SW2              ALERT_BUTTON(3U, 11U)  // PTD11
+#define ALERT_BUTTON_SW3              ALERT_BUTTON(0U, 10U)  // PTA10
+
+typedef uint8_t alert_id_t;
+
+// One need category - everything the app needs to raise or clear it
+typedef struct {
+    const char *name;
+    uint8_t button;                 // ALERT_BUTTON(port, pin) or ALERT_NO_BUTTON
+    char key;                       // Keyboard shortcut (either case accepted)
+    uint8_t led;                    // led_id_t that shows this alert
+    uint8_t led_pattern;            // led_pattern_t played while the alert is active
+    uint8_t audio_clip;             // Clip played while the alert is active
+    uint8_t priority;               // Higher value preempts lower; equal values replace each other
+    trace_msg_id_t msg_button;      // Log line for a button press
+    trace_msg_id_t msg_key;         // Log line for a keyboard command
+    trace_msg_id_t msg_started;     // Log line when started from idle
+    trace_msg_id_t msg_cancelled;   // Log line when cancelled by its own input
+} alert_descriptor_t;
+
+typedef enum {
+    ALERT_ACTION_START = 0,  // Idle -> alert
+    ALERT_ACTION_CANCEL,     // Same input again -> idle
+    ALERT_ACTION_SWITCH,     // Other alert active, new one has equal/higher priority
+    ALERT_ACTION_IGNORE      // Other alert active with higher priority
+} alert_action_t;
+
+// Result of one dispatch
+typedef struct {
+    alert_action_t action;
+    alert_id_t from;  // Active alert before (ALERT_NONE if idle)
+    alert_id_t to;    // Active alert after (ALERT_NONE if idle)
+} alert_transition_t;
+
+// Install the descriptor table (count <= ALERT_MAX_CATEGORIES) and reset to idle
+void alert_fsm_init(const alert_descriptor_t *table, uint32_t count);
+
+// Apply input `input` (an alert ID) and return what changed
+alert_transition_t alert_fsm_dispatch(alert_id_t input);
+
+// Map a keyboard character to an alert ID (ALERT_NONE if unmapped)
+alert_id_t alert_fsm_key_to_input(uint8_t ch);
+
+// Map a button code (ALERT_BUTTON) to an alert ID (ALERT_NONE if unmapped)
+alert_id_t alert_fsm_button_to_input(uint8_t code);
+
+// Currently active alert (ALERT_NONE if idle) - safe to read from an ISR
+alert_id_t alert_fsm_active(void);
+
+// Descriptor for an alert ID (NULL if out of range)
+const alert_descriptor_t *alert_fsm_descriptor(alert_id_t id);
+
+#endif /* ALERT_FSM_H_ */
@@ -0,0 +1,83 @@
+/*
+ * SEH500 Project - Packed audio asset bank
+ * See asset_bank.h
+ */
+
+#include <stddef.h>
+#include "asset_bank.h"
+#include "adpcm.h"
+
+_Static_assert(sizeof(asset_bank_header_t) == 16U, "asset_bank_header_t layout is part of the bank format");
+_Static_assert(sizeof(asset_clip_t) == 28U, "asset_clip_t layout is part of the bank format");
+
+static const asset_bank_header_t *asset_bank_header(const void *bank) {
+    return (const asset_bank_header_t *)bank;
+}
+
+static const asset_clip_t *asset_bank_index(const void *bank) {
+    return (const asset_clip_t *)((const uint8_t *)bank + sizeof(asset_bank_header_t));
+}
+
+static int asset_clip_valid(const asset_clip_t *clip, uint32_t bank_size) {
+    if (clip->offset % ASSET_BANK_ALIGN != 0U || clip->offset > bank_size || clip->length > bank_size - clip->offset) {
+        return 0;
+    }
+    if (clip->channels == 0U || clip->channels > 2U || clip->sample_rate == 0U || clip->block_align == 0U) {
+        return 0;
+    }
+    if (clip->format == ASSET_FORMAT_IMA_ADPCM) {
+        if (clip->bits != 4U || clip->block_align <= clip->channels * ADPCM_HEADER_SIZE) {
+            return 0;
+        }
+    } else if (clip->format != ASSET_FORMAT_PCM ||
+               (clip->bits != 8U && clip->bits != 16U && clip->bits != 24U) ||
+               clip->block_align != clip->channels * (clip->bits / 8U)) {
+        return 0;
+    }
+    if (clip->loop_end == 0U) {
+        return 1;
+    }
+    return clip->loop_start < clip->loop_end && clip->loop_end <= clip->length &&
+           clip->loop_start % clip->block_align == 0U && clip->loop_end % clip->block_align == 0U;
+}
+
+uint32_t asset_bank_check(const void *bank, uint32_t index_len, uint32_t bank_size) {
+    const asset_bank_header_t *header = asset_bank_header(bank);
+
+    if (index_len < sizeof(asset_bank_header_t) || header->magic != ASSET_BANK_MAGIC ||
+        header->version != ASSET_BANK_VERSION || header->clip_count == 0U ||
+        header->clip_count > ASSET_BANK_MAX_CLIPS || header->size != bank_size ||
+        index_len < ASSET_BANK_INDEX_SIZE(header->clip_count)) {
+        return 0U;
+    }
+    const asset_clip_t *index = asset_bank_index(bank);
+    for (uint32_t i = 0; i < header->clip_count; i++) {
+        if (!asset_clip_valid(&index[i], bank_size)) {
+            return 0U;
+        }
+    }
+    return header->clip_count;
+}
+
+const asset_clip_t *asset_bank_clip(const void *bank, uint32_t id) {
+    if (id >= asset_bank_header(bank)->clip_count) {
+        return NULL;
+    }
+    return &asset_bank_index(bank)[id];
+}
+
+void asset_clip_info(const asset_clip_t *clip, wav_info_t *info) {
+    info->audioFormat = clip->format;
+    info->numChannels = clip->channels;
+    info->sampleRate = clip->sample_rate;
+    info->blockAlign = clip->block_align;
+    info->bitsPerSample = clip->bits;
+    info->dataSize = clip->length;
+    info->dataOffset = clip->offset;
+    if (clip->format == ASSET_FORMAT_IMA_ADPCM) {
+        uint32_t block_frames = ADPCM_BLOCK_FRAMES(clip->block_align, clip->channels);
+        info->byteRate = (uint32_t)(((uint64_t)clip->sample_rate * clip->block_align) / block_frames);
+    } else {
+        info->byteRate = clip->sample_rate * clip->block_align;
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * SEH500 Project - Packed audio asset bank
+ *
+ * All clips in one image, built by tools/asset_pack.c from the WAVs in
+ * audio/: a header, an index with one entry per clip ID (data offset and
+ * length, format, loop points), then each clip's sample data starting on
+ * an ASSET_BANK_ALIGN boundary and padded with silence up to the next one.
+ * A clip is found by indexing the table with its ID, and its format comes
+ * from the index, so nothing is searched by name and no WAV header is
+ * parsed at play time.
+ *
+ * The same image works in two places. Linked into flash (the packer's -c
+ * output defines asset_bank_image), it is read in place: native clips go
+ * to the SAI eDMA straight from flash with no copy. As a file on the SD
+ * card, it is opened once and only the header and index are read; clips
+ * are then streamed by seeking to their offset, in whole sectors since
+ * every clip starts on one.
+ *
+ * Plain C with no SDK header, so the packer checks its output with the
+ * same asset_bank_check() the player trusts. Fields are little-endian
+ * and naturally aligned, so the image is used as-is on the Cortex-M4.
+ */
+
+#ifndef ASSET_BANK_H_
+#define ASSET_BANK_H_
+
+#include <stdint.h>
+#include "wav_parser.h"
+
+#define ASSET_BANK_MAGIC     0x4B4E4241U  // "ABNK"
+#define ASSET_BANK_VERSION   1U
+#define ASSET_BANK_MAX_CLIPS 32U
+
+// Clip data alignment: one SD sector, and a whole number of SAI DMA granules
+#define ASSET_BANK_ALIGN 512U
+
+// asset_clip_t.format values (WAV format tags)
+#define ASSET_FORMAT_PCM       0x0001U
+#define ASSET_FORMAT_IMA_ADPCM 0x0011U
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t clip_count;  // Index entries following the header
+    uint32_t size;        // Whole bank in bytes
+    uint32_t reserved;
+} asset_bank_header_t;
+
+typedef struct {
+    uint32_t offset;       // Sample data from the start of the bank, ASSET_BANK_ALIGN aligned
+    uint32_t length;       // Sample data bytes (the padding after it is not counted)
+    uint32_t sample_rate;
+    uint16_t format;       // ASSET_FORMAT_PCM or ASSET_FORMAT_IMA_ADPCM
+    uint16_t channels;
+    uint16_t bits;         // Per sample: 8/16/24, or 4 for ADPCM
+    uint16_t block_align;  // Bytes per frame (PCM) or per block (ADPCM)
+    uint32_t loop_start;   // Loop as byte offsets into the data, on block_align
+    uint32_t loop_end;     // boundaries; loop_end == 0 plays the clip once
+} asset_clip_t;
+
+// Bytes of header and index for count clips
+#define ASSET_BANK_INDEX_SIZE(count) (sizeof(asset_bank_header_t) + (count) * sizeof(asset_clip_t))
+
+// Bank linked into flash by the packer's C output; weak, so NULL when the
+// build has none
+extern const uint8_t asset_bank_image[] __attribute__((weak));
+extern const uint32_t asset_bank_image_size __attribute__((weak));
+
+// Validate a bank from its first index_len bytes (header and whole index
+// must be there) against its total size: magic, version, every clip inside
+// the bank, aligned, with a usable format and loop. Returns the clip count,
+// 0 if the bank cannot be used.
+uint32_t asset_bank_check(const void *bank, uint32_t index_len, uint32_t bank_size);
+
+// Index entry for a clip ID of a checked bank, NULL past the last clip
+const asset_clip_t *asset_bank_clip(const void *bank, uint32_t id);
+
+// The clip's format as the WAV reader would report it; dataOffset is the
+// offset in the bank
+void asset_clip_info(const asset_clip_t *clip, wav_info_t *info);
+
+#endif /* ASSET_BANK_H_ */
@@ -0,0 +1,304 @@
+/*
+ * SEH500 Project - DA7212 audio codec and SAI output
+ * See audio_codec.h
+ */
+
+#include "audio_codec.h"
+#include "board.h"
+#include "fsl_common.h"
+#include "fsl_debug_console.h"
+#include "fsl_clock.h"
+#include "fsl_port.h"
+#include "fsl_i2c.h"
+#include "fsl_sai.h"
+#include "fsl_dmamux.h"
+#include "fsl_edma.h"
+#include "fsl_i2c_edma.h"
+#include "timer_service.h"
+#include "cycle_counter.h"
+
+// DA7212 registers used here
+#define DA7212_DIG_ROUTING_DAC     0x2AU
+#define DA7212_SR                  0x22U
+#define DA7212_REFERENCES          0x23U
+#define DA7212_PLL_CTRL            0x27U
+#define DA7212_DAI_CLK_MODE        0x28U
+#define DA7212_DAI_CTRL            0x29U
+#define DA7212_CP_CTRL             0x47U
+#define DA7212_HP_L_GAIN           0x48U
+#define DA7212_HP_R_GAIN           0x49U
+#define DA7212_MIXOUT_L_SELECT     0x4BU
+#define DA7212_MIXOUT_R_SELECT     0x4CU
+#define DA7212_DAC_L_CTRL          0x69U
+#define DA7212_DAC_R_CTRL          0x6AU
+#define DA7212_HP_L_CTRL           0x6BU
+#define DA7212_HP_R_CTRL           0x6CU
+#define DA7212_MIXOUT_L_CTRL       0x6EU
+#define DA7212_MIXOUT_R_CTRL       0x6FU
+#define DA7212_SYSTEM_ACTIVE       0xFDU
+
+// DIG_ROUTING_DAC: DAC_L source in [1:0], DAC_R source in [5:4] (2 = DAI left, 3 = DAI right)
+#define DA7212_ROUTING_STEREO      0x32U
+#define DA7212_ROUTING_MONO        0x22U
+
+#define AUDIO_CODEC_MCLK_48K       12288000U
+#define AUDIO_CODEC_MCLK_44K1      11289600U
+
+// Longest auto-increment burst the sequencer sends in one transaction
+#define CODEC_SEQ_MAX_BURST 8U
+
+typedef struct {
+    uint8_t reg;
+    uint8_t value;
+    uint8_t delay_ms;  // Wait after this write before the next one
+} codec_reg_write_t;
+
+typedef enum {
+    CODEC_SEQ_STEP = 0,  // Next burst can go (main loop)
+    CODEC_SEQ_SENDING,   // Burst data moving by eDMA
+    CODEC_SEQ_SENT,      // Burst acknowledged; its delay comes next
+    CODEC_SEQ_WAITING,   // Delay timer running
+    CODEC_SEQ_DONE,
+    CODEC_SEQ_FAILED,
+} codec_seq_state_t;
+
+typedef struct {
+    const codec_reg_write_t *table;
+    uint32_t count;
+    uint32_t next;          // First entry not yet sent
+    uint32_t transactions;  // I2C transactions used so far
+    uint32_t start_ms;
+    uint32_t elapsed_ms;    // Bring-up time, start to last acknowledge
+    uint32_t cpu_cycles;    // Core cycles spent starting bursts (address phases are polled)
+    uint8_t burst[CODEC_SEQ_MAX_BURST];
+    uint8_t burst_reg;      // First register of the burst last sent
+    volatile codec_seq_state_t state;
+} codec_seq_t;
+
+typedef struct {
+    uint32_t rate;
+    uint32_t mclk;
+    uint8_t code;  // DA7212_SR value
+} codec_rate_t;
+
+// Standby -> DAC, mixer and headphone amplifiers on, slave I2S 16-bit, 32 BCLK per frame.
+// Ordered so neighbouring registers follow each other: the sequencer sends
+// each run as one auto-increment burst (17 writes in 7 transactions).
+static const codec_reg_write_t codec_power_up[] = {
+    {DA7212_SYSTEM_ACTIVE,   0x01U, 0U},   // Leave standby
+    {DA7212_REFERENCES,      0x08U, 10U},  // Bias on; let it settle before the outputs power up
+    {DA7212_PLL_CTRL,        0x04U, 0U},   // PLL bypassed, MCLK input 10-20 MHz
+    {DA7212_DAI_CLK_MODE,    0x00U, 0U},   // Slave, 32 BCLK per WCLK
+    {DA7212_DAI_CTRL,        0x80U, 0U},   // DAI on, I2S, 16-bit words
+    {DA7212_DIG_ROUTING_DAC, DA7212_ROUTING_STEREO, 0U},
+    {DA7212_CP_CTRL,         0xF1U, 0U},   // Charge pump on, tracking the signal level
+    {DA7212_HP_L_GAIN,       0x39U, 0U},   // 0 dB
+    {DA7212_HP_R_GAIN,       0x39U, 0U},
+    {DA7212_MIXOUT_L_SELECT, 0x08U, 0U},   // DAC_L -> MIXOUT_L
+    {DA7212_MIXOUT_R_SELECT, 0x08U, 0U},   // DAC_R -> MIXOUT_R
+    {DA7212_MIXOUT_L_CTRL,   0x88U, 0U},   // Mixer amplifier on (silent until the DAC is)
+    {DA7212_MIXOUT_R_CTRL,   0x88U, 0U},
+    {DA7212_DAC_L_CTRL,      0x80U, 0U},   // DAC on, unmuted
+    {DA7212_DAC_R_CTRL,      0x80U, 0U},
+    {DA7212_HP_L_CTRL,       0xA8U, 0U},   // Amplifier on with gain ramping, output enabled
+    {DA7212_HP_R_CTRL,       0xA8U, 0U},
+};
+
+static const codec_rate_t codec_rates[] = {
+    {8000U,  AUDIO_CODEC_MCLK_48K,  0x01U}, {11025U, AUDIO_CODEC_MCLK_44K1, 0x02U},
+    {12000U, AUDIO_CODEC_MCLK_48K,  0x03U}, {16000U, AUDIO_CODEC_MCLK_48K,  0x05U},
+    {22050U, AUDIO_CODEC_MCLK_44K1, 0x06U}, {24000U, AUDIO_CODEC_MCLK_48K,  0x07U},
+    {32000U, AUDIO_CODEC_MCLK_48K,  0x09U}, {44100U, AUDIO_CODEC_MCLK_44K1, 0x0AU},
+    {48000U, AUDIO_CODEC_MCLK_48K,  0x0BU},
+};
+
+static edma_handle_t codec_dma_handle;
+static i2c_master_edma_handle_t codec_i2c_handle;
+static sw_timer_t codec_seq_timer;
+static codec_seq_t codec_seq;
+static audio_codec_notify_t codec_notify;
+
+static bool audio_codec_write(uint8_t reg, uint8_t value) {
+    i2c_master_transfer_t xfer = {
+        .flags = kI2C_TransferDefaultFlag,
+        .slaveAddress = AUDIO_CODEC_I2C_ADDR,
+        .direction = kI2C_Write,
+        .subaddress = reg,
+        .subaddressSize = 1U,
+        .data = &value,
+        .dataSize = 1U,
+    };
+    return I2C_MasterTransferBlocking(BOARD_CODEC_I2C_BASEADDR, &xfer) == kStatus_Success;
+}
+
+// I2C1 divides the bus clock, which changes with the run mode
+static void audio_codec_sync_baud(void) {
+    I2C_MasterSetBaudRate(BOARD_CODEC_I2C_BASEADDR, AUDIO_CODEC_I2C_BAUD, BOARD_CODEC_I2C_CLOCK_FREQ);
+}
+
+// Nothing in BOARD_InitBootPins routes the audio pins, so mux them here
+static void audio_codec_init_pins(void) {
+    const port_pin_config_t i2cConfig = {
+        .pullSelect = kPORT_PullDisable,  // External pull-ups on the board
+        .slewRate = kPORT_FastSlewRate,
+        .passiveFilterEnable = kPORT_PassiveFilterDisable,
+        .openDrainEnable = kPORT_OpenDrainEnable,
+        .driveStrength = kPORT_LowDriveStrength,
+        .mux = kPORT_MuxAlt2,
+        .lockRegister = kPORT_UnlockRegister,
+    };
+
+    CLOCK_EnableClock(kCLOCK_PortC);
+    CLOCK_EnableClock(kCLOCK_PortE);
+    PORT_SetPinConfig(PORTC, 10U, &i2cConfig);      // I2C1_SCL
+    PORT_SetPinConfig(PORTC, 11U, &i2cConfig);      // I2C1_SDA
+    PORT_SetPinMux(PORTC, 1U, kPORT_MuxAlt6);       // I2S0_TXD0
+    PORT_SetPinMux(PORTC, 6U, kPORT_MuxAlt6);       // I2S0_MCLK (PTE6 is the green LED)
+    PORT_SetPinMux(PORTE, 11U, kPORT_MuxAlt4);      // I2S0_TX_FS
+    PORT_SetPinMux(PORTE, 12U, kPORT_MuxAlt4);      // I2S0_TX_BCLK
+}
+
+// DMA3 interrupt: the burst's data is out and the stop sent
+static void audio_codec_i2c_callback(I2C_Type *base, i2c_master_edma_handle_t *handle, status_t status,
+                                     void *userData) {
+    codec_seq.state = (status == kStatus_Success) ? CODEC_SEQ_SENT : CODEC_SEQ_FAILED;
+    codec_notify();
+}
+
+static void audio_codec_seq_timer_callback(sw_timer_t *timer, void *arg) {
+    codec_seq.state = CODEC_SEQ_STEP;
+    codec_notify();
+}
+
+// Start the next run of the table: entries with consecutive registers and
+// no delay between them go as one burst (the DA7212 auto-increments the
+// register address). The start, address and register bytes are polled by
+// the driver; a burst's data then moves by eDMA and ends in the callback,
+// while a single write completes here.
+static void audio_codec_seq_send(void) {
+    const codec_reg_write_t *first = &codec_seq.table[codec_seq.next];
+    uint32_t n = 1U;
+    while (codec_seq.next + n < codec_seq.count && n < CODEC_SEQ_MAX_BURST && first[n - 1U].delay_ms == 0U &&
+           first[n].reg == first[n - 1U].reg + 1U) {
+        n++;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        codec_seq.burst[i] = first[i].value;
+    }
+
+    i2c_master_transfer_t xfer = {
+        .flags = kI2C_TransferDefaultFlag,
+        .slaveAddress = AUDIO_CODEC_I2C_ADDR,
+        .direction = kI2C_Write,
+        .subaddress = first->reg,
+        .subaddressSize = 1U,
+        .data = codec_seq.burst,
+        .dataSize = n,
+    };
+    uint32_t start = cycle_counter_now();
+    codec_seq.burst_reg = first->reg;
+    codec_seq.state = CODEC_SEQ_SENDING;
+    codec_seq.next += n;
+    codec_seq.transactions++;
+    if (I2C_MasterTransferEDMA(BOARD_CODEC_I2C_BASEADDR, &codec_i2c_handle, &xfer) != kStatus_Success) {
+        codec_seq.state = CODEC_SEQ_FAILED;
+    } else if (n == 1U) {
+        codec_seq.state = CODEC_SEQ_SENT;  // Polled to the end, no callback
+    }
+    codec_seq.cpu_cycles += cycle_counter_now() - start;
+}
+
+// Move the sequence on as far as it can go without waiting
+static void audio_codec_seq_run(void) {
+    for (;;) {
+        if (codec_seq.state == CODEC_SEQ_SENT) {
+            uint32_t delay = codec_seq.table[codec_seq.next - 1U].delay_ms;
+            codec_seq.state = CODEC_SEQ_STEP;
+            if (delay != 0U && codec_seq.next != codec_seq.count) {
+                codec_seq.state = CODEC_SEQ_WAITING;
+                timer_service_start(&codec_seq_timer, delay, 0U, audio_codec_seq_timer_callback, NULL);
+                return;
+            }
+        }
+        if (codec_seq.state != CODEC_SEQ_STEP) {
+            return;
+        }
+        if (codec_seq.next == codec_seq.count) {
+            codec_seq.state = CODEC_SEQ_DONE;
+            codec_seq.elapsed_ms = timer_service_now() - codec_seq.start_ms;
+            return;
+        }
+        audio_codec_seq_send();
+    }
+}
+
+bool audio_codec_init(audio_codec_notify_t notify) {
+    i2c_master_config_t i2cConfig;
+
+    audio_codec_init_pins();
+    I2C_MasterGetDefaultConfig(&i2cConfig);
+    i2cConfig.baudRate_Bps = AUDIO_CODEC_I2C_BAUD;
+    I2C_MasterInit(BOARD_CODEC_I2C_BASEADDR, &i2cConfig, BOARD_CODEC_I2C_CLOCK_FREQ);
+    SAI_Init(I2S0);
+
+    EDMA_CreateHandle(&codec_dma_handle, DMA0, AUDIO_CODEC_DMA_CHANNEL);
+    DMAMUX_SetSource(DMAMUX, AUDIO_CODEC_DMA_CHANNEL, (uint32_t)kDmaRequestMux0I2C1);
+    DMAMUX_EnableChannel(DMAMUX, AUDIO_CODEC_DMA_CHANNEL);
+    I2C_MasterCreateEDMAHandle(BOARD_CODEC_I2C_BASEADDR, &codec_i2c_handle, audio_codec_i2c_callback, NULL,
+                               &codec_dma_handle);
+
+    codec_notify = notify;
+    codec_seq.table = codec_power_up;
+    codec_seq.count = ARRAY_SIZE(codec_power_up);
+    codec_seq.next = 0U;
+    codec_seq.start_ms = timer_service_now();
+    codec_seq.state = CODEC_SEQ_STEP;
+    audio_codec_seq_run();  // A codec that is not there NAKs the very first write
+    return codec_seq.state != CODEC_SEQ_FAILED;
+}
+
+audio_codec_status_t audio_codec_service(void) {
+    audio_codec_seq_run();
+    if (codec_seq.state == CODEC_SEQ_DONE) {
+        return AUDIO_CODEC_READY;
+    }
+    return (codec_seq.state == CODEC_SEQ_FAILED) ? AUDIO_CODEC_FAILED : AUDIO_CODEC_BUSY;
+}
+
+uint8_t audio_codec_failed_register(void) {
+    return codec_seq.burst_reg;
+}
+
+void audio_codec_dump(void) {
+    PRINTF("[AUDIO] Codec bring-up: %lu writes in %lu I2C transactions, %lu ms, %lu CPU cycles (%s)\r\n",
+           codec_seq.count, codec_seq.transactions, codec_seq.elapsed_ms, codec_seq.cpu_cycles,
+           (codec_seq.state == CODEC_SEQ_DONE) ? "done" : (codec_seq.state == CODEC_SEQ_FAILED) ? "failed" : "running");
+}
+
+uint32_t audio_codec_set_format(uint32_t sample_rate, uint32_t channels) {
+    const codec_rate_t *rate = NULL;
+    for (uint32_t i = 0; i < ARRAY_SIZE(codec_rates); i++) {
+        if (codec_rates[i].rate == sample_rate) {
+            rate = &codec_rates[i];
+            break;
+        }
+    }
+    if (rate == NULL || channels == 0U || channels > 2U) {
+        return 0U;
+    }
+
+    sai_master_clock_t mclkConfig = {
+        .mclkOutputEnable = true,
+        .mclkSource = kSAI_MclkSourceSysclk,
+        .mclkHz = rate->mclk,
+        .mclkSourceClkHz = CLOCK_GetFreq(kCLOCK_CoreSysClk),
+    };
+    SAI_SetMasterClockConfig(I2S0, &mclkConfig);
+
+    audio_codec_sync_baud();
+    if (!audio_codec_write(DA7212_SR, rate->code) ||
+        !audio_codec_write(DA7212_DIG_ROUTING_DAC, (channels == 1U) ? DA7212_ROUTING_MONO : DA7212_ROUTING_STEREO)) {
+        return 0U;
+    }
+    return rate->mclk;
+}
@@ -0,0 +1,63 @@
+/*
+ * SEH500 Project - DA7212 audio codec and SAI output
+ *
+ * The FRDM-K66F DA7212 (U20) is an I2S slave on I2S0: the SAI drives
+ * MCLK, BCLK and WCLK, the codec's PLL is bypassed and it runs straight
+ * from MCLK (12.288 MHz for the 8/16/32/48 kHz family, 11.2896 MHz for
+ * 11.025/22.05/44.1 kHz). Control goes over I2C1 at 100 kHz.
+ *
+ * MCLK is divided down from the core clock, so the player must hold the
+ * clock mode it configured the format in for as long as it plays.
+ *
+ * Power-up is a const table of (register, value, delay) writes played by
+ * a small sequencer in the background: runs of consecutive registers go
+ * as one auto-increment I2C burst whose data bytes move by eDMA, delays
+ * run on a software timer, and each step is handed back to the main loop
+ * through the caller's notify hook (called from interrupt context). Boot
+ * no longer waits for the codec; only the start of each burst is polled.
+ * The bus clock (and so the I2C divider) must not change until it is done.
+ */
+
+#ifndef AUDIO_CODEC_H_
+#define AUDIO_CODEC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define AUDIO_CODEC_I2C_ADDR 0x1AU
+#define AUDIO_CODEC_I2C_BAUD 100000U
+
+// eDMA channel for the I2C1 bursts (0 is the SAI, 1-2 the LEDs)
+#define AUDIO_CODEC_DMA_CHANNEL 3U
+
+typedef enum {
+    AUDIO_CODEC_BUSY = 0,  // Power-up still running
+    AUDIO_CODEC_READY,
+    AUDIO_CODEC_FAILED,    // A write was not acknowledged
+} audio_codec_status_t;
+
+// Called in interrupt context when the power-up needs audio_codec_service()
+typedef void (*audio_codec_notify_t)(void);
+
+// Mux the I2C1/I2S0 pins, start the SAI and start powering up the
+// DAC/headphone path. Returns false if the codec does not answer on I2C
+// (the first write is sent before returning); otherwise the power-up
+// carries on in the background.
+bool audio_codec_init(audio_codec_notify_t notify);
+
+// Move the power-up on (main loop, after each notify)
+audio_codec_status_t audio_codec_service(void);
+
+// First register of the burst that failed (valid after AUDIO_CODEC_FAILED)
+uint8_t audio_codec_failed_register(void);
+
+// Print the power-up cost on the debug console
+void audio_codec_dump(void);
+
+// Program MCLK, the codec sample rate and DAC routing for a stream
+// (channels 1 = mono on both outputs, 2 = stereo). Returns the MCLK
+// frequency the SAI bit clock divides from, or 0 if the rate is unsupported
+// or the codec did not acknowledge.
+uint32_t audio_codec_set_format(uint32_t sample_rate, uint32_t channels);
+
+#endif /* AUDIO_CODEC_H_ */
@@ -0,0 +1,227 @@
+/*
+ * SEH500 Project - Sample format conversion kernels
+ * See audio_convert.h
+ */
+
+#include <string.h>
+#include "audio_convert.h"
+#include "fsl_common.h"
+#include "fsl_debug_console.h"
+#include "cycle_counter.h"
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define AUDIO_CONVERT_SIMD 1
+#else
+#define AUDIO_CONVERT_SIMD 0
+#endif
+
+#define AUDIO_LOAD32(p)      __UNALIGNED_UINT32_READ(p)
+#define AUDIO_STORE32(p, v)  __UNALIGNED_UINT32_WRITE((p), (v))
+
+// ---- Portable references ----
+
+void audio_u8_to_s16_ref(const uint8_t *in, int16_t *out, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = (int16_t)(((int32_t)in[i] - 128) * 256);
+    }
+}
+
+static int16_t audio_s24_sample(const uint8_t *p) {
+    int32_t s = (int16_t)((uint16_t)p[1] | ((uint16_t)p[2] << 8));
+    if ((p[0] & 0x80U) != 0U && s < INT16_MAX) {
+        s++;  // Round half up on the dropped byte
+    }
+    return (int16_t)s;
+}
+
+void audio_s24_to_s16_ref(const uint8_t *in, int16_t *out, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = audio_s24_sample(&in[3U * i]);
+    }
+}
+
+void audio_mono_to_stereo_ref(const int16_t *in, int16_t *out, uint32_t frames) {
+    for (uint32_t i = 0; i < frames; i++) {
+        out[2U * i] = in[i];
+        out[2U * i + 1U] = in[i];
+    }
+}
+
+void audio_interleave_ref(const int16_t *left, const int16_t *right, int16_t *out, uint32_t frames) {
+    for (uint32_t i = 0; i < frames; i++) {
+        out[2U * i] = left[i];
+        out[2U * i + 1U] = right[i];
+    }
+}
+
+void audio_deinterleave_ref(const int16_t *in, int16_t *left, int16_t *right, uint32_t frames) {
+    for (uint32_t i = 0; i < frames; i++) {
+        left[i] = in[2U * i];
+        right[i] = in[2U * i + 1U];
+    }
+}
+
+// ---- Cortex-M4 SIMD versions ----
+
+#if AUDIO_CONVERT_SIMD
+
+// Four samples per word. Flipping bit 7 makes each byte signed; moved into
+// the high byte of a halfword it is already the 16-bit value, so two masks
+// and a halfword pack replace the per-sample subtract and shift.
+void audio_u8_to_s16(const uint8_t *in, int16_t *out, uint32_t count) {
+    uint32_t i = 0;
+    for (; i + 4U <= count; i += 4U) {
+        uint32_t w = AUDIO_LOAD32(&in[i]) ^ 0x80808080U;
+        uint32_t odd = w & 0xFF00FF00U;            // b1, b3 in the high bytes
+        uint32_t even = (w << 8) & 0xFF00FF00U;    // b0, b2 in the high bytes
+        AUDIO_STORE32(&out[i], __PKHBT(even, odd, 16));
+        AUDIO_STORE32(&out[i + 2U], __PKHTB(odd, even, 16));
+    }
+    audio_u8_to_s16_ref(&in[i], &out[i], count - i);
+}
+
+// Four samples per three words: the top two bytes of each sample are
+// packed into halfwords, then the dropped byte's MSB is added as a
+// rounding bit with __QADD16 so 0x7FFF saturates instead of wrapping.
+void audio_s24_to_s16(const uint8_t *in, int16_t *out, uint32_t count) {
+    uint32_t i = 0;
+    for (; i + 4U <= count; i += 4U) {
+        const uint8_t *p = &in[3U * i];
+        uint32_t w0 = AUDIO_LOAD32(&p[0]);  // a0 a1 a2 b0
+        uint32_t w1 = AUDIO_LOAD32(&p[4]);  // b1 b2 c0 c1
+        uint32_t w2 = AUDIO_LOAD32(&p[8]);  // c2 d0 d1 d2
+        uint32_t ab = __PKHBT(w0 >> 8, w1, 16);
+        uint32_t cd = __PKHTB(w2, (w2 << 8) | (w1 >> 24), 0);
+        uint32_t round_ab = ((w0 >> 7) & 1U) | ((w0 >> 31) << 16);
+        uint32_t round_cd = ((w1 >> 23) & 1U) | (((w2 >> 15) & 1U) << 16);
+        AUDIO_STORE32(&out[i], __QADD16(ab, round_ab));
+        AUDIO_STORE32(&out[i + 2U], __QADD16(cd, round_cd));
+    }
+    audio_s24_to_s16_ref(&in[3U * i], &out[i], count - i);
+}
+
+void audio_mono_to_stereo(const int16_t *in, int16_t *out, uint32_t frames) {
+    uint32_t i = 0;
+    for (; i + 2U <= frames; i += 2U) {
+        uint32_t w = AUDIO_LOAD32(&in[i]);          // s0 s1
+        AUDIO_STORE32(&out[2U * i], __PKHBT(w, w, 16));        // s0 s0
+        AUDIO_STORE32(&out[2U * i + 2U], __PKHTB(w, w, 16));   // s1 s1
+    }
+    audio_mono_to_stereo_ref(&in[i], &out[2U * i], frames - i);
+}
+
+void audio_interleave(const int16_t *left, const int16_t *right, int16_t *out, uint32_t frames) {
+    uint32_t i = 0;
+    for (; i + 2U <= frames; i += 2U) {
+        uint32_t l = AUDIO_LOAD32(&left[i]);        // l0 l1
+        uint32_t r = AUDIO_LOAD32(&right[i]);       // r0 r1
+        AUDIO_STORE32(&out[2U * i], __PKHBT(l, r, 16));        // l0 r0
+        AUDIO_STORE32(&out[2U * i + 2U], __PKHTB(r, l, 16));   // l1 r1
+    }
+    audio_interleave_ref(&left[i], &right[i], &out[2U * i], frames - i);
+}
+
+void audio_deinterleave(const int16_t *in, int16_t *left, int16_t *right, uint32_t frames) {
+    uint32_t i = 0;
+    for (; i + 2U <= frames; i += 2U) {
+        uint32_t f0 = AUDIO_LOAD32(&in[2U * i]);       // l0 r0
+        uint32_t f1 = AUDIO_LOAD32(&in[2U * i + 2U]);  // l1 r1
+        AUDIO_STORE32(&left[i], __PKHBT(f0, f1, 16));   // l0 l1
+        AUDIO_STORE32(&right[i], __PKHTB(f1, f0, 16));  // r0 r1
+    }
+    audio_deinterleave_ref(&in[2U * i], &left[i], &right[i], frames - i);
+}
+
+#else
+
+void audio_u8_to_s16(const uint8_t *in, int16_t *out, uint32_t count) {
+    audio_u8_to_s16_ref(in, out, count);
+}
+
+void audio_s24_to_s16(const uint8_t *in, int16_t *out, uint32_t count) {
+    audio_s24_to_s16_ref(in, out, count);
+}
+
+void audio_mono_to_stereo(const int16_t *in, int16_t *out, uint32_t frames) {
+    audio_mono_to_stereo_ref(in, out, frames);
+}
+
+void audio_interleave(const int16_t *left, const int16_t *right, int16_t *out, uint32_t frames) {
+    audio_interleave_ref(left, right, out, frames);
+}
+
+void audio_deinterleave(const int16_t *in, int16_t *left, int16_t *right, uint32_t frames) {
+    audio_deinterleave_ref(in, left, right, frames);
+}
+
+#endif /* AUDIO_CONVERT_SIMD */
+
+// ---- Benchmark ----
+
+#define BENCH_N AUDIO_CONVERT_BENCH_SAMPLES
+
+// Big enough for 24-bit samples and for two 16-bit channels
+SDK_ALIGN(static uint8_t bench_in[4U * BENCH_N], 4U);
+SDK_ALIGN(static int16_t bench_out[2U * BENCH_N], 4U);
+SDK_ALIGN(static int16_t bench_ref[2U * BENCH_N], 4U);
+
+typedef enum {
+    BENCH_U8 = 0,
+    BENCH_S24,
+    BENCH_MONO,
+    BENCH_INTERLEAVE,
+    BENCH_DEINTERLEAVE,
+    BENCH_COUNT
+} bench_kernel_t;
+
+static const char *const bench_names[BENCH_COUNT] = {"u8->s16", "s24->s16", "mono->stereo", "interleave",
+                                                     "deinterleave"};
+
+// Run one kernel (fast or reference) into out and return the cycles taken
+static uint32_t bench_run(bench_kernel_t kernel, bool fast, int16_t *out) {
+    const int16_t *in16 = (const int16_t *)bench_in;
+    uint32_t start = cycle_counter_now();
+
+    switch (kernel) {
+        case BENCH_U8:
+            (fast ? audio_u8_to_s16 : audio_u8_to_s16_ref)(bench_in, out, BENCH_N);
+            break;
+        case BENCH_S24:
+            (fast ? audio_s24_to_s16 : audio_s24_to_s16_ref)(bench_in, out, BENCH_N);
+            break;
+        case BENCH_MONO:
+            (fast ? audio_mono_to_stereo : audio_mono_to_stereo_ref)(in16, out, BENCH_N);
+            break;
+        case BENCH_INTERLEAVE:
+            (fast ? audio_interleave : audio_interleave_ref)(in16, &in16[BENCH_N], out, BENCH_N);
+            break;
+        default:
+            (fast ? audio_deinterleave : audio_deinterleave_ref)(in16, out, &out[BENCH_N], BENCH_N);
+            break;
+    }
+    return cycle_counter_now() - start;
+}
+
+void audio_convert_benchmark(void) {
+    // Pseudo-random input that hits every byte value, including the rounding/saturation edge
+    uint32_t seed = 0x12345678U;
+    for (uint32_t i = 0; i < sizeof(bench_in); i++) {
+        seed = seed * 1664525U + 1013904223U;
+        bench_in[i] = (uint8_t)(seed >> 24);
+    }
+    bench_in[0] = 0x80U;  // 0x7FFF80 must saturate, not wrap
+    bench_in[1] = 0xFFU;
+    bench_in[2] = 0x7FU;
+
+    PRINTF("[CONVERT] %lu samples, cycles/sample x100 (%s)\r\n", (uint32_t)BENCH_N,
+           AUDIO_CONVERT_SIMD ? "SIMD" : "no DSP extension, fast = reference");
+    for (uint32_t k = 0; k < BENCH_COUNT; k++) {
+        memset(bench_ref, 0, sizeof(bench_ref));
+        memset(bench_out, 0, sizeof(bench_out));
+        uint32_t ref = bench_run((bench_kernel_t)k, false, bench_ref);
+        uint32_t fast = bench_run((bench_kernel_t)k, true, bench_out);
+        bool match = (memcmp(bench_out, bench_ref, sizeof(bench_out)) == 0);
+        PRINTF("[CONVERT] %-12s ref %5lu  fast %5lu  %s\r\n", bench_names[k], (ref * 100U) / BENCH_N,
+               (fast * 100U) / BENCH_N, match ? "ok" : "MISMATCH");
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ * SEH500 Project - Sample format conversion kernels
+ *
+ * The SAI always runs 16-bit stereo; these kernels turn whatever a clip
+ * holds into that, writing straight into a DMA buffer. Each kernel has a
+ * portable C reference (*_ref) and a Cortex-M4 version built on the CMSIS
+ * SIMD intrinsics that moves two 16-bit samples per 32-bit register
+ * (__PKHBT/__PKHTB packing, __QADD16 saturating rounding). Without the DSP
+ * extension the fast names fall back to the references.
+ *
+ * Words are loaded and stored unaligned, so byte input (8/24-bit) may
+ * start anywhere, such as in place in a read-ahead window or the clip
+ * bank; 16-bit buffers need halfword alignment. Counts need not be a
+ * multiple of the SIMD width (the tail is done one sample at a time).
+ */
+
+#ifndef AUDIO_CONVERT_H_
+#define AUDIO_CONVERT_H_
+
+#include <stdint.h>
+
+// Samples per kernel run in audio_convert_benchmark()
+#define AUDIO_CONVERT_BENCH_SAMPLES 1024U
+
+// Unsigned 8-bit WAV samples -> signed 16-bit
+void audio_u8_to_s16(const uint8_t *in, int16_t *out, uint32_t count);
+void audio_u8_to_s16_ref(const uint8_t *in, int16_t *out, uint32_t count);
+
+// Packed signed 24-bit -> 16-bit, rounded to nearest with saturation
+void audio_s24_to_s16(const uint8_t *in, int16_t *out, uint32_t count);
+void audio_s24_to_s16_ref(const uint8_t *in, int16_t *out, uint32_t count);
+
+// Mono -> stereo by duplicating each sample into both channels
+void audio_mono_to_stereo(const int16_t *in, int16_t *out, uint32_t frames);
+void audio_mono_to_stereo_ref(const int16_t *in, int16_t *out, uint32_t frames);
+
+// Separate left/right buffers -> interleaved L R L R
+void audio_interleave(const int16_t *left, const int16_t *right, int16_t *out, uint32_t frames);
+void audio_interleave_ref(const int16_t *left, const int16_t *right, int16_t *out, uint32_t frames);
+
+// Interleaved L R L R -> separate left/right buffers
+void audio_deinterleave(const int16_t *in, int16_t *left, int16_t *right, uint32_t frames);
+void audio_deinterleave_ref(const int16_t *in, int16_t *left, int16_t *right, uint32_t frames);
+
+// Time every kernel against its reference on AUDIO_CONVERT_BENCH_SAMPLES
+// samples and print cycles per sample, flagging any output mismatch
+void audio_convert_benchmark(void);
+
+#endif /* AUDIO_CONVERT_H_ */
@@ -0,0 +1,103 @@
+/*
+ * SEH500 Project - Voice mixing kernels
+ * See audio_mixer.h
+ */
+
+#include "audio_mixer.h"
+
+// tools/mix_check.c sets AUDIO_MIX_SIMD itself and supplies the intrinsics
+#if !defined(AUDIO_MIX_SIMD)
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "fsl_common.h"  // CMSIS SIMD intrinsics
+#define AUDIO_MIX_SIMD 1
+#else
+#define AUDIO_MIX_SIMD 0
+#endif
+#endif
+
+// Added before the >> 15 so products round to nearest
+#define AUDIO_MIX_ROUND 0x4000
+
+// -3 dB per level below AUDIO_VOLUME_MAX, level 0 muted
+static const uint16_t audio_volume_table[AUDIO_VOLUME_MAX + 1U] = {
+    0U, 0x05B8U, 0x0814U, 0x0B68U, 0x101DU, 0x16C3U, 0x2027U, 0x2D6BU, 0x4027U, 0x5A9EU, AUDIO_GAIN_UNITY,
+};
+
+uint16_t audio_volume_gain(uint32_t volume) {
+    return audio_volume_table[(volume > AUDIO_VOLUME_MAX) ? AUDIO_VOLUME_MAX : volume];
+}
+
+static inline int16_t audio_mix_sat16(int32_t s) {
+    return (int16_t)((s > INT16_MAX) ? INT16_MAX : (s < INT16_MIN) ? INT16_MIN : s);
+}
+
+void audio_mix_ref(int16_t *out, const int16_t *in, uint16_t gain, uint32_t samples) {
+    if (gain == 0U) {
+        return;
+    }
+    for (uint32_t i = 0; i < samples; i++) {
+        int32_t s = (gain >= AUDIO_GAIN_UNITY) ? in[i] : (((int32_t)in[i] * gain + AUDIO_MIX_ROUND) >> 15);
+        out[i] = audio_mix_sat16(s + out[i]);
+    }
+}
+
+int32_t audio_mix_ramp_ref(int16_t *out, const int16_t *in, int32_t level, int32_t step, uint32_t frames) {
+    for (uint32_t i = 0; i < frames; i++, level += step) {
+        int32_t gain = level >> 16;
+        for (uint32_t c = 0; c < 2U; c++) {
+            int32_t s = ((int32_t)in[2U * i + c] * gain + AUDIO_MIX_ROUND) >> 15;
+            out[2U * i + c] = audio_mix_sat16(s + out[2U * i + c]);
+        }
+    }
+    return level;
+}
+
+#if AUDIO_MIX_SIMD
+
+void audio_mix(int16_t *out, const int16_t *in, uint16_t gain, uint32_t samples) {
+    uint32_t i = 0;
+
+    if (gain == 0U) {
+        return;
+    }
+    if (gain >= AUDIO_GAIN_UNITY) {
+        for (; i + 2U <= samples; i += 2U) {
+            __UNALIGNED_UINT32_WRITE(&out[i], __QADD16(__UNALIGNED_UINT32_READ(&out[i]), __UNALIGNED_UINT32_READ(&in[i])));
+        }
+    } else {
+        // (gain, 0) and (0, gain): each __SMLAD multiplies one sample of the pair
+        uint32_t gain_lo = gain;
+        uint32_t gain_hi = (uint32_t)gain << 16;
+        for (; i + 2U <= samples; i += 2U) {
+            uint32_t x = __UNALIGNED_UINT32_READ(&in[i]);
+            int32_t lo = (int32_t)__SMLAD(x, gain_lo, AUDIO_MIX_ROUND) >> 15;
+            int32_t hi = (int32_t)__SMLAD(x, gain_hi, AUDIO_MIX_ROUND) >> 15;
+            __UNALIGNED_UINT32_WRITE(&out[i], __QADD16(__UNALIGNED_UINT32_READ(&out[i]), __PKHBT(lo, hi, 16)));
+        }
+    }
+    audio_mix_ref(&out[i], &in[i], gain, samples - i);
+}
+
+// One stereo frame per word, so both lanes share the frame's gain
+int32_t audio_mix_ramp(int16_t *out, const int16_t *in, int32_t level, int32_t step, uint32_t frames) {
+    for (uint32_t i = 0; i < 2U * frames; i += 2U, level += step) {
+        uint32_t gain = (uint32_t)level >> 16;
+        uint32_t x = __UNALIGNED_UINT32_READ(&in[i]);
+        int32_t lo = (int32_t)__SMLAD(x, gain, AUDIO_MIX_ROUND) >> 15;
+        int32_t hi = (int32_t)__SMLAD(x, gain << 16, AUDIO_MIX_ROUND) >> 15;
+        __UNALIGNED_UINT32_WRITE(&out[i], __QADD16(__UNALIGNED_UINT32_READ(&out[i]), __PKHBT(lo, hi, 16)));
+    }
+    return level;
+}
+
+#else
+
+void audio_mix(int16_t *out, const int16_t *in, uint16_t gain, uint32_t samples) {
+    audio_mix_ref(out, in, gain, samples);
+}
+
+int32_t audio_mix_ramp(int16_t *out, const int16_t *in, int32_t level, int32_t step, uint32_t frames) {
+    return audio_mix_ramp_ref(out, in, level, step, frames);
+}
+
+#endif /* AUDIO_MIX_SIMD */
@@ -0,0 +1,51 @@
+/*
+ * SEH500 Project - Voice mixing kernels
+ *
+ * audio_player renders each active voice to 16-bit stereo and adds it into
+ * the DMA buffer with audio_mix(): out = saturate(out + in * gain). The
+ * gain is Q15 (AUDIO_GAIN_UNITY adds the voice unscaled), so the cost is
+ * one pass per voice and the total scales linearly with the voice count.
+ *
+ * On the Cortex-M4 two samples go per word: __SMLAD forms each rounded
+ * Q15 product (one lane of the gain pair is zero, the accumulator input
+ * carries the rounding constant) and __QADD16 adds both into the output
+ * with saturation, so loud voices clip instead of wrapping. The portable
+ * reference produces the same bits; tools/mix_check.c proves it on the
+ * host with C models of the intrinsics.
+ *
+ * Gain changes never step: audio_mix_ramp() moves the gain linearly, one
+ * step per stereo frame, with the gain carried as a Q15.16 level so short
+ * ramps between close gains still move smoothly. The player fades every
+ * clip in and out and ramps every volume change this way, so starting,
+ * stopping or turning a voice down mid-clip does not click. Volume levels
+ * (audio_volume_gain) are 3 dB apart, which sounds even from step to step
+ * where equal Q15 steps would bunch up at the loud end.
+ */
+
+#ifndef AUDIO_MIXER_H_
+#define AUDIO_MIXER_H_
+
+#include <stdint.h>
+
+// Q15 gains: 0 mutes, AUDIO_GAIN_UNITY (and above) passes the voice unchanged
+#define AUDIO_GAIN_UNITY 0x7FFFU
+#define AUDIO_GAIN_HALF  0x4000U
+
+// Volume levels for audio_volume_gain(): 0 is silent, each step up is +3 dB
+#define AUDIO_VOLUME_MAX 10U
+
+// out[i] = saturate(out[i] + round(in[i] * gain / 32768)) for samples values
+void audio_mix(int16_t *out, const int16_t *in, uint16_t gain, uint32_t samples);
+void audio_mix_ref(int16_t *out, const int16_t *in, uint16_t gain, uint32_t samples);
+
+// Stereo frames mixed at a moving gain: frame i is scaled by the Q15 gain
+// (level + i * step) >> 16 (always multiplied, so 0x7FFF is not a bypass).
+// level must stay within 0..(AUDIO_GAIN_UNITY << 16). Returns the level
+// after the last frame.
+int32_t audio_mix_ramp(int16_t *out, const int16_t *in, int32_t level, int32_t step, uint32_t frames);
+int32_t audio_mix_ramp_ref(int16_t *out, const int16_t *in, int32_t level, int32_t step, uint32_t frames);
+
+// Q15 gain for a volume level 0..AUDIO_VOLUME_MAX (higher levels are full scale)
+uint16_t audio_volume_gain(uint32_t volume);
+
+#endif /* AUDIO_MIXER_H_ */
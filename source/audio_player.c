@@ -0,0 +1,1061 @@
+/*
+ * SEH500 Project - Streaming WAV player
+ * See audio_player.h
+ */
+
+#include <string.h>
+#include "audio_player.h"
+#include "fsl_common.h"
+#include "fsl_dmamux.h"
+#include "fsl_edma.h"
+#include "fsl_sai.h"
+#include "fsl_sai_edma.h"
+#include "fsl_debug_console.h"
+#include "clock_config.h"
+#include "ff.h"
+#include "audio_codec.h"
+#include "audio_convert.h"
+#include "audio_resample.h"
+#include "adpcm.h"
+#include "audio_mixer.h"
+#include "asset_bank.h"
+#include "sd_storage.h"
+#include "sd_readahead.h"
+#include "wav_reader.h"
+#include "event_queue.h"
+#include "timer_service.h"
+#include "clock_mode.h"
+#include "power_governor.h"
+#include "cycle_counter.h"
+#include "trace_log.h"
+
+#if AUDIO_BUFFER_COUNT != SAI_XFER_QUEUE_SIZE
+#error "AUDIO_BUFFER_COUNT must match SAI_XFER_QUEUE_SIZE (one queue slot per buffer)"
+#endif
+
+#if (AUDIO_VOICE_COUNT + 1U) > SD_STORAGE_CLMT_POOL
+#error "Every voice and the clip bank file need a link map from the SD storage pool"
+#endif
+
+#if (AUDIO_BUFFER_SIZE / 4U) > RESAMPLE_MAX_OUT
+#error "A DMA buffer must fit in one resample_process() call"
+#endif
+
+
+// Parses timed by the 'A' report
+#define AUDIO_WAV_BENCH_RUNS 100U
+
+// Header bytes read per step; one sector covers the usual fmt/LIST/data run
+#define AUDIO_HEADER_READ 512U
+
+// Stereo 16-bit frames per DMA buffer, the source frames read for one
+// (more when a 48 kHz clip is brought down) and the widest source frame (24-bit stereo)
+#define AUDIO_FRAMES_PER_BUFFER (AUDIO_BUFFER_SIZE / 4U)
+#define AUDIO_MAX_INPUT_FRAMES  RESAMPLE_MAX_IN
+#define AUDIO_MAX_BLOCK_ALIGN   6U
+
+// Largest IMA-ADPCM block accepted (the usual size for 44.1/48 kHz stereo),
+// the samples one block can decode to, and the block timed by the 'A' report
+#define AUDIO_ADPCM_MAX_BLOCK     2048U
+#define AUDIO_ADPCM_MAX_SAMPLES   (2U * AUDIO_ADPCM_MAX_BLOCK)
+#define AUDIO_ADPCM_BENCH_BLOCK   1024U
+#define AUDIO_ADPCM_BENCH_RUNS    20U
+
+#if (AUDIO_MAX_INPUT_FRAMES * AUDIO_MAX_BLOCK_ALIGN) < AUDIO_ADPCM_MAX_BLOCK
+#error "audio_raw must hold the largest ADPCM block"
+#endif
+
+#if AUDIO_BUFFER_SIZE > SD_READAHEAD_SIZE || (AUDIO_MAX_INPUT_FRAMES * AUDIO_MAX_BLOCK_ALIGN) > SD_READAHEAD_SIZE
+#error "One read of a voice must fit in its read-ahead window"
+#endif
+
+// Length of every gain ramp: clip fade-in and fade-out, volume changes (11.6 ms)
+#define AUDIO_RAMP_FRAMES 512U
+
+// The SAI eDMA minor loop moves watermark x 2 bytes; every queued length must be a multiple of it
+#define AUDIO_DMA_GRANULE 32U
+
+// Longest the start-of-sound probe waits for its sample to leave the FIFO:
+// under half the first buffer, so the rest of the ring is primed before it runs out
+#define AUDIO_PROBE_TIMEOUT_MS 10U
+
+typedef enum {
+    AUDIO_VOICE_IDLE = 0,
+    AUDIO_VOICE_PLAYING,      // File open, mixed into every refill
+    AUDIO_VOICE_WAIT_REPEAT,  // Clip ended, repeat timer running
+} audio_voice_state_t;
+
+// Where a clip failed to start; logged by MSG_AUDIO_ERROR, keep its legend in step
+typedef enum {
+    AUDIO_FAIL_OPEN = 1,      // File not opened
+    AUDIO_FAIL_HEADER,        // RIFF/WAVE header unreadable or without a data chunk
+    AUDIO_FAIL_FORMAT,        // Encoding, channels or sample size not supported
+    AUDIO_FAIL_RATE,          // Sample rate the resampler cannot convert
+    AUDIO_FAIL_SEEK,          // Seek to the sample data failed
+    AUDIO_FAIL_CODEC,         // Codec rejected the output format
+    AUDIO_FAIL_PRIME,         // No buffer could be filled to start the stream
+} audio_fail_stage_t;
+
+typedef struct {
+    audio_voice_state_t state;
+    uint16_t gain;            // Q15 gain set for the voice, see audio_mixer.h
+    uint16_t target;          // Q15 gain the ramp ends on (0 when fading out)
+    int32_t level;            // Gain applied now, Q15.16
+    int32_t step;             // Level change per frame while ramping
+    uint32_t ramp_left;       // Frames until level reaches target
+    bool stopping;            // Fading out; the clip ends when the ramp does
+    bool restart;             // Start path again once the fade-out ends
+    bool resampling;
+    FIL file;
+    wav_info_t info;
+    char path[32];
+    const asset_clip_t *asset;  // Bank clip to play (NULL: the WAV file at path)
+    const asset_clip_t *clip;   // Bank clip playing, read at pos (NULL: file playing)
+    uint32_t pos;
+    uint32_t repeat_ms;
+    uint32_t data_left;       // Sample bytes not yet read from the file
+    uint32_t carry_frames;    // ADPCM frames decoded but not used by the last buffer
+    sw_timer_t repeat_timer;
+    resampler_t resampler;
+    sd_readahead_t ahead;     // Sample data from the card (file or bank file)
+    int16_t carry[AUDIO_ADPCM_MAX_SAMPLES];
+} audio_voice_t;
+
+typedef struct {
+    uint32_t clips;
+    uint32_t buffers;
+    uint32_t underruns;
+    uint32_t refill_last;  // Core cycles to render, mix and queue one buffer
+    uint32_t refill_max;
+    uint32_t convert_last; // Core cycles to decode/resample the voices of that buffer
+    uint32_t convert_max;
+    uint32_t mix_last;     // Core cycles spent in audio_mix() for that buffer
+    uint32_t mix_max;
+    uint32_t voices_max;   // Most voices mixed into one buffer
+    uint32_t mapped;       // Buffers the eDMA read straight from a flash bank
+} audio_stats_t;
+
+SDK_ALIGN(static uint8_t audio_buffers[AUDIO_BUFFER_COUNT][AUDIO_BUFFER_SIZE], 4U);
+
+// Shared by all voices, which the main loop renders one after the other.
+// Clips that are not 16-bit stereo at AUDIO_OUTPUT_RATE are decoded where
+// their data lies (bank image, read-ahead window) or from a copy in
+// audio_raw, to 16-bit in audio_pcm (ADPCM: the voice's carried-over frames
+// plus whole blocks), and then resampled or widened to stereo in
+// audio_voice_out, which audio_mix() adds into the DMA buffer.
+SDK_ALIGN(static uint8_t audio_raw[AUDIO_MAX_INPUT_FRAMES * AUDIO_MAX_BLOCK_ALIGN], 4U);
+SDK_ALIGN(static int16_t audio_pcm[AUDIO_MAX_INPUT_FRAMES * 2U + AUDIO_ADPCM_MAX_SAMPLES], 4U);
+SDK_ALIGN(static int16_t audio_voice_out[AUDIO_FRAMES_PER_BUFFER * 2U], 4U);
+static uint32_t audio_decode_cycles = 0;
+
+static audio_voice_t audio_voices[AUDIO_VOICE_COUNT];
+static bool audio_ready = false;       // Codec powered up
+static bool audio_codec_starting = false;
+static bool audio_streaming = false;   // SAI running, ring in use
+static edma_handle_t audio_dma_handle;
+static sai_edma_handle_t audio_sai_handle;
+static uint32_t audio_queued = 0;      // Buffers handed to the SAI (free-running)
+static uint32_t audio_reclaimed = 0;   // Buffers the SAI has finished with (free-running)
+static audio_stats_t audio_stats;
+// Clip bank: the header and index, and the whole image when it is in flash
+// (NULL: read from audio_bank_file)
+static const uint8_t *audio_bank = NULL;
+static const uint8_t *audio_bank_image = NULL;
+static FIL audio_bank_file;
+SDK_ALIGN(static uint8_t audio_bank_index[ASSET_BANK_INDEX_SIZE(ASSET_BANK_MAX_CLIPS)], 4U);
+
+static bool audio_probe_armed = false;
+static bool audio_probe_fresh = false;  // audio_probe holds a start not yet taken
+static audio_start_probe_t audio_probe;
+
+// DMA0 interrupt: defer everything to the main loop
+static void audio_sai_callback(I2S_Type *base, sai_edma_handle_t *handle, status_t status, void *userData) {
+    (void)event_queue_post(EVENT_SOURCE_AUDIO, AUDIO_EVENT_BUFFER_DONE);
+}
+
+// DMA3 or PIT0 interrupt: the codec power-up has a step for the main loop
+static void audio_codec_notify(void) {
+    (void)event_queue_post(EVENT_SOURCE_AUDIO, AUDIO_EVENT_CODEC);
+}
+
+// arg is the voice; its index rides on the event payload
+static void audio_repeat_callback(sw_timer_t *timer, void *arg) {
+    uint32_t voice = (uint32_t)((audio_voice_t *)arg - audio_voices);
+    (void)event_queue_post(EVENT_SOURCE_AUDIO, (uint8_t)(AUDIO_EVENT_REPEAT + voice));
+}
+
+// One interrupt can retire several TCDs, so count finished buffers from the
+// handle's queue: the driver clears a slot's data pointer when its TCD is done.
+// Buffer n always sits in queue slot n % AUDIO_BUFFER_COUNT.
+static void audio_reclaim(void) {
+    while (audio_reclaimed != audio_queued &&
+           audio_sai_handle.saiQueue[audio_reclaimed % AUDIO_BUFFER_COUNT].data == NULL) {
+        audio_reclaimed++;
+    }
+}
+
+// True when the clip is already in the SAI's layout: 16-bit stereo at the output rate
+static bool audio_is_native(const audio_voice_t *v) {
+    return !v->resampling && v->info.audioFormat != WAV_FORMAT_IMA_ADPCM && v->info.bitsPerSample == 16U &&
+           v->info.numChannels == 2U;
+}
+
+// Decode samples from raw to 16-bit into dst; 16-bit clips are used in place,
+// unless they sit at an odd address (a window head or bank offset can)
+static const int16_t *audio_decode(const audio_voice_t *v, const uint8_t *raw, uint32_t samples, int16_t *dst) {
+    if (v->info.bitsPerSample == 8U) {
+        audio_u8_to_s16(raw, dst, samples);
+        return dst;
+    }
+    if (v->info.bitsPerSample == 24U) {
+        audio_s24_to_s16(raw, dst, samples);
+        return dst;
+    }
+    if (((uintptr_t)raw & 1U) != 0U) {
+        memcpy(dst, raw, samples * sizeof(int16_t));
+        return dst;
+    }
+    return (const int16_t *)(const void *)raw;
+}
+
+// Account for got of want bytes read; a short read (error or end of file)
+// ends the clip, and a looping bank clip goes back to its loop start
+static void audio_voice_consumed(audio_voice_t *v, uint32_t got, uint32_t want) {
+    v->pos += got;
+    v->data_left = (got < want) ? 0U : (v->data_left - got);
+    if (v->data_left == 0U && got == want && v->clip != NULL && v->clip->loop_end != 0U) {
+        v->pos = v->clip->offset + v->clip->loop_start;
+        v->data_left = v->clip->loop_end - v->clip->loop_start;
+    }
+}
+
+// Read the voice's next want (<= data_left) bytes of sample data: from the
+// bank image, or from its read-ahead window on its file or the bank file
+// (which loops the clip where audio_voice_consumed() does)
+static uint32_t audio_voice_read(audio_voice_t *v, void *dst, uint32_t want) {
+    uint32_t got;
+
+    if (want == 0U) {
+        return 0U;
+    }
+    if (v->clip != NULL && audio_bank_image != NULL) {
+        memcpy(dst, &audio_bank_image[v->pos], want);
+        got = want;
+    } else {
+        got = sd_readahead_read(&v->ahead, dst, want);
+    }
+    audio_voice_consumed(v, got, want);
+    return got;
+}
+
+// audio_voice_read() for a decoder, which only reads the bytes: they are
+// left where they are (*data) in the bank image or, when buffered in one
+// piece, in the read-ahead window, and copied to audio_raw otherwise
+static uint32_t audio_voice_take(audio_voice_t *v, uint32_t want, const uint8_t **data) {
+    if (want != 0U && v->clip != NULL && audio_bank_image != NULL) {
+        *data = &audio_bank_image[v->pos];
+        audio_voice_consumed(v, want, want);
+        return want;
+    }
+    if (want != 0U && sd_readahead_peek(&v->ahead, data) >= want) {
+        sd_readahead_skip(&v->ahead, want);
+        audio_voice_consumed(v, want, want);
+        return want;
+    }
+    *data = audio_raw;
+    return audio_voice_read(v, audio_raw, want);
+}
+
+// PCM: read up to frames and decode them into dst (*pcm says where they
+// ended up); returns the frames read. A partial frame at the end is dropped.
+static uint32_t audio_read_pcm(audio_voice_t *v, uint32_t frames, int16_t *dst, const int16_t **pcm) {
+    const uint8_t *raw;
+    uint32_t got = audio_voice_take(v, MIN(frames * v->info.blockAlign, v->data_left), &raw);
+    frames = got / v->info.blockAlign;
+
+    uint32_t start = cycle_counter_now();
+    *pcm = audio_decode(v, raw, frames * v->info.numChannels, dst);
+    audio_decode_cycles += cycle_counter_now() - start;
+    return frames;
+}
+
+// ADPCM: the voice's carried-over frames, then whole blocks decoded after
+// them in audio_pcm until it holds frames or the clip ends. Returns the
+// frames available (at most frames); *decoded is everything audio_pcm holds.
+static uint32_t audio_read_adpcm(audio_voice_t *v, uint32_t frames, uint32_t *decoded) {
+    uint32_t channels = v->info.numChannels;
+    uint32_t block = v->info.blockAlign;
+    uint32_t block_frames = ADPCM_BLOCK_FRAMES(block, channels);
+    uint32_t have = v->carry_frames;
+
+    memcpy(audio_pcm, v->carry, have * channels * sizeof(int16_t));
+    while (have < frames && v->data_left != 0U) {
+        // As many blocks as still needed, as far as audio_raw and audio_pcm have room
+        uint32_t blocks = (frames - have + block_frames - 1U) / block_frames;
+        uint32_t room = (ARRAY_SIZE(audio_pcm) / channels - have) / block_frames;
+        blocks = MIN(blocks, MIN(room, sizeof(audio_raw) / block));
+        uint32_t want = MIN(blocks * block, v->data_left);
+        if (want == 0U) {
+            break;
+        }
+        const uint8_t *raw;
+        uint32_t got = audio_voice_take(v, want, &raw);
+
+        uint32_t start = cycle_counter_now();
+        for (uint32_t off = 0; off < got; off += block) {
+            have += adpcm_decode_block(&raw[off], MIN(block, got - off), channels, &audio_pcm[have * channels]);
+        }
+        audio_decode_cycles += cycle_counter_now() - start;
+    }
+    *decoded = have;
+    return MIN(frames, have);
+}
+
+// Read and convert the voice's next buffer into out as 16-bit stereo at
+// the output rate; returns the frames written, 0 once the clip is over.
+// When resampling, the input read is whatever the converter needs for a
+// full buffer, and once the file is exhausted the converter's tail is
+// drained over the following calls.
+static uint32_t audio_voice_render(audio_voice_t *v, int16_t *out) {
+    if (audio_is_native(v)) {
+        // While the window is empty (a clip's first buffers) the card's DMA fills out itself
+        return audio_voice_read(v, out, MIN(v->data_left, AUDIO_BUFFER_SIZE)) / 4U;
+    }
+
+    uint32_t channels = v->info.numChannels;
+    uint32_t frames = v->resampling ? resample_input_needed(&v->resampler, AUDIO_FRAMES_PER_BUFFER)
+                                    : AUDIO_FRAMES_PER_BUFFER;
+    const int16_t *pcm = audio_pcm;
+    uint32_t decoded = 0U;
+
+    if (v->info.audioFormat == WAV_FORMAT_IMA_ADPCM) {
+        frames = audio_read_adpcm(v, frames, &decoded);
+    } else {
+        // Decode straight to where the samples go next when the layout allows
+        int16_t *dst = audio_pcm;
+        if (v->resampling && channels == 1U) {
+            dst = resample_input(&v->resampler, 0U);
+        } else if (!v->resampling && channels == 2U) {
+            dst = out;
+        }
+        frames = audio_read_pcm(v, frames, dst, &pcm);
+        decoded = frames;
+    }
+
+    uint32_t start = cycle_counter_now();
+    uint32_t written = frames;
+    if (v->resampling) {
+        if (channels == 1U) {
+            int16_t *in = resample_input(&v->resampler, 0U);
+            if (pcm != in) {
+                memcpy(in, pcm, frames * sizeof(int16_t));
+            }
+        } else {
+            audio_deinterleave(pcm, resample_input(&v->resampler, 0U), resample_input(&v->resampler, 1U), frames);
+        }
+        resample_commit(&v->resampler, frames);
+        if (v->data_left == 0U && decoded <= frames) {
+            resample_end(&v->resampler);
+        }
+        written = resample_process(&v->resampler, out, AUDIO_FRAMES_PER_BUFFER);
+    } else if (channels == 1U) {
+        audio_mono_to_stereo(pcm, out, frames);
+    } else if (pcm != out) {
+        memcpy(out, pcm, frames * 2U * sizeof(int16_t));
+    }
+
+    // Keep the decoded ADPCM frames this buffer did not take
+    v->carry_frames = decoded - frames;
+    memcpy(v->carry, &audio_pcm[frames * channels], v->carry_frames * channels * sizeof(int16_t));
+
+    audio_decode_cycles += cycle_counter_now() - start;
+    return written;
+}
+
+// Move the voice's gain to target over AUDIO_RAMP_FRAMES, from wherever it is now
+static void audio_voice_ramp(audio_voice_t *v, uint16_t target) {
+    v->target = target;
+    v->step = (((int32_t)target << 16) - v->level) / (int32_t)AUDIO_RAMP_FRAMES;
+    v->ramp_left = AUDIO_RAMP_FRAMES;
+}
+
+// Clip over or faded out: close it, then restart it (a replacement clip),
+// wait for the repeat or go idle. The stream keeps running for the other
+// voices and stops once the ring drains.
+static void audio_voice_finish(audio_voice_t *v) {
+    sd_readahead_stop(&v->ahead);
+    if (v->clip == NULL) {
+        (void)sd_storage_close(&v->file);
+    }
+    LOG0(MSG_AUDIO_FINISHED);
+    if (v->restart) {
+        // Through the repeat timer on the next tick, so the new clip is opened
+        // outside the refill and the event is posted from PIT0, not the main loop
+        v->state = AUDIO_VOICE_WAIT_REPEAT;
+        timer_service_start(&v->repeat_timer, 0U, 0U, audio_repeat_callback, v);
+    } else if (v->repeat_ms != 0U && !v->stopping) {
+        v->state = AUDIO_VOICE_WAIT_REPEAT;
+        timer_service_start(&v->repeat_timer, v->repeat_ms, 0U, audio_repeat_callback, v);
+    } else {
+        v->state = AUDIO_VOICE_IDLE;
+    }
+    v->stopping = false;
+    v->restart = false;
+}
+
+// Add n rendered frames of the voice into buffer, running any ramp first
+static void audio_voice_mix(audio_voice_t *v, int16_t *buffer, const int16_t *out, uint32_t n) {
+    uint32_t ramp = MIN(v->ramp_left, n);
+    if (ramp != 0U) {
+        v->level = audio_mix_ramp(buffer, out, v->level, v->step, ramp);
+        v->ramp_left -= ramp;
+        if (v->ramp_left == 0U) {
+            v->level = (int32_t)v->target << 16;  // Exact, whatever the step rounded away
+        }
+    }
+    audio_mix(&buffer[2U * ramp], &out[2U * ramp], (uint16_t)(v->level >> 16), 2U * (n - ramp));
+}
+
+// Drop the voice and any pending repeat at once
+static void audio_voice_stop(audio_voice_t *v) {
+    sd_readahead_stop(&v->ahead);
+    if (v->state == AUDIO_VOICE_PLAYING && v->clip == NULL) {
+        (void)sd_storage_close(&v->file);
+    }
+    timer_service_stop(&v->repeat_timer);
+    v->state = AUDIO_VOICE_IDLE;
+    v->stopping = false;
+    v->restart = false;
+}
+
+// Fade a playing voice out and end it (restart: then start its path again);
+// anything else stops at once
+static void audio_voice_fade_out(audio_voice_t *v, bool restart) {
+    if (v->state != AUDIO_VOICE_PLAYING) {
+        audio_voice_stop(v);
+        return;
+    }
+    audio_voice_ramp(v, 0U);
+    v->stopping = true;
+    v->restart = restart;
+}
+
+// Start-of-DMA probe: busy-wait until the eDMA channel has made its first
+// read from the buffer just queued (its SADDR has moved off the start, so
+// the SAI's first request has been served) and return its cycle_counter_us()
+// time (0 if the wait times out)
+static uint32_t audio_probe_first_dma(const uint8_t *buffer) {
+    uint32_t timeout = (SystemCoreClock / 1000U) * AUDIO_PROBE_TIMEOUT_MS;
+    uint32_t start = cycle_counter_now();
+    while (DMA0->TCD[AUDIO_DMA_CHANNEL].SADDR == (uint32_t)buffer) {
+        if (cycle_counter_now() - start > timeout) {
+            return 0U;
+        }
+    }
+    return cycle_counter_us();
+}
+
+// Start-of-sound probe: busy-wait until the first non-zero sample of the
+// buffer just queued has left the SAI transmit FIFO for the shifter, and
+// return its cycle_counter_us() time (0 if the buffer is silent or the wait
+// times out). The channel's SADDR is the next byte the eDMA reads, so once
+// it is past the sample, the sample's FIFO slot is that many words behind
+// the write pointer; it has left when the read pointer moves past the slot.
+static uint32_t audio_probe_first_sound(const int16_t *buffer, uint32_t samples) {
+    uint32_t i = 0;
+    while (i < samples && buffer[i] == 0) {
+        i++;
+    }
+    if (i == samples) {
+        return 0U;
+    }
+    uint32_t sample = (uint32_t)&buffer[i];
+    uint32_t timeout = (SystemCoreClock / 1000U) * AUDIO_PROBE_TIMEOUT_MS;
+    uint32_t start = cycle_counter_now();
+    uint32_t saddr;
+    uint32_t wfp;
+
+    do {
+        if (cycle_counter_now() - start > timeout) {
+            return 0U;
+        }
+        wfp = I2S0->TFR[0] & I2S_TFR_WFP_MASK;
+        saddr = DMA0->TCD[AUDIO_DMA_CHANNEL].SADDR;
+    } while (saddr <= sample || (I2S0->TFR[0] & I2S_TFR_WFP_MASK) != wfp);
+
+    // Pointers carry a wrap bit: 4 bits for the 8-word FIFO
+    uint32_t behind = MIN((saddr - sample) / 2U, (uint32_t)FSL_FEATURE_SAI_FIFO_COUNT);
+    uint32_t slot = ((wfp >> I2S_TFR_WFP_SHIFT) - behind) & I2S_TFR_RFP_MASK;
+    for (;;) {
+        uint32_t read = ((I2S0->TFR[0] & I2S_TFR_RFP_MASK) - slot) & I2S_TFR_RFP_MASK;
+        if (read != 0U && read <= FSL_FEATURE_SAI_FIFO_COUNT) {
+            return cycle_counter_us();
+        }
+        if (cycle_counter_now() - start > timeout) {
+            return 0U;
+        }
+    }
+}
+
+// A native clip in a flash bank needs no copy: returns the bytes of its
+// next buffer the eDMA can read in place at *data, 0 to render it instead.
+// The length must be whole DMA granules unless it runs to the clip's end,
+// where the bank's zero padding completes the granule.
+static uint32_t audio_voice_map(audio_voice_t *v, const uint8_t **data) {
+    if (v->clip == NULL || audio_bank_image == NULL || !audio_is_native(v) || v->data_left == 0U) {
+        return 0U;
+    }
+    uint32_t size = MIN(v->data_left, AUDIO_BUFFER_SIZE);
+    bool clip_end = (size == v->data_left && v->clip->loop_end == 0U);
+    if ((size % AUDIO_DMA_GRANULE) != 0U && !clip_end) {
+        return 0U;
+    }
+    *data = &audio_bank_image[v->pos];
+    audio_voice_consumed(v, size, size);
+    return size;
+}
+
+// Render every playing voice and mix it into the free buffer, then queue
+// it; false once no voice has anything left. A lone voice at unity gain
+// with no ramp running is rendered straight into the DMA buffer, so
+// single-clip playback costs no more than before the mixer, or not copied
+// at all when it is a native clip in a flash bank.
+static bool audio_refill(void) {
+    uint32_t start = cycle_counter_now();
+    uint8_t *buffer = audio_buffers[audio_queued % AUDIO_BUFFER_COUNT];
+    uint32_t playing = 0U;
+    uint32_t mixed = 0U;
+    uint32_t frames = 0U;
+    uint32_t convert_cycles = 0U;
+    uint32_t mix_cycles = 0U;
+    audio_voice_t *lone = NULL;
+    const uint8_t *mapped = NULL;
+
+    for (uint32_t i = 0; i < AUDIO_VOICE_COUNT; i++) {
+        if (audio_voices[i].state == AUDIO_VOICE_PLAYING) {
+            lone = &audio_voices[i];
+            playing++;
+        }
+    }
+    bool direct = (playing == 1U && lone->ramp_left == 0U && lone->target >= AUDIO_GAIN_UNITY);
+    uint32_t mapped_size = direct ? audio_voice_map(lone, &mapped) : 0U;
+    if (mapped_size != 0U) {
+        frames = mapped_size / 4U;
+        mixed = 1U;
+        audio_stats.mapped++;
+    } else if (!direct) {
+        memset(buffer, 0, AUDIO_BUFFER_SIZE);
+    }
+    for (uint32_t i = 0; i < AUDIO_VOICE_COUNT && mapped == NULL; i++) {
+        audio_voice_t *v = &audio_voices[i];
+        if (v->state != AUDIO_VOICE_PLAYING) {
+            continue;
+        }
+        int16_t *out = direct ? (int16_t *)buffer : audio_voice_out;
+        uint32_t n = audio_voice_render(v, out);
+        sd_readahead_period(&v->ahead);  // One buffer of the clip's consumption
+        convert_cycles += audio_decode_cycles;
+        audio_decode_cycles = 0U;
+        if (n == 0U) {
+            audio_voice_finish(v);
+            continue;
+        }
+        if (!direct) {
+            uint32_t mix_start = cycle_counter_now();
+            audio_voice_mix(v, (int16_t *)buffer, out, n);
+            mix_cycles += cycle_counter_now() - mix_start;
+        }
+        mixed++;
+        frames = MAX(frames, n);
+        if (v->stopping && v->ramp_left == 0U) {
+            audio_voice_finish(v);  // Faded out
+        }
+    }
+    if (frames == 0U) {
+        return false;
+    }
+
+    // Voices that came up short (and the tail of the clip) are already
+    // silence up to frames; pad with silence to the DMA granule
+    uint32_t got = frames * 4U;
+    uint32_t size = (got + AUDIO_DMA_GRANULE - 1U) & ~(AUDIO_DMA_GRANULE - 1U);
+    if (mapped != NULL) {
+        buffer = (uint8_t *)(uintptr_t)mapped;  // Read-only to the eDMA
+    } else {
+        memset(&buffer[got], 0, size - got);
+    }
+
+    sai_transfer_t xfer = {.data = buffer, .dataSize = size};
+    if (SAI_TransferSendEDMA(I2S0, &audio_sai_handle, &xfer) != kStatus_Success) {
+        return false;
+    }
+    if (audio_probe_armed && !audio_streaming && audio_queued == 0U) {
+        // First buffer of a new stream: the SAI is enabled and the eDMA requested
+        audio_probe.dma_us = audio_probe_first_dma(buffer);
+        audio_probe.sound_us = audio_probe_first_sound((const int16_t *)buffer, size / 2U);
+        audio_probe_fresh = true;
+    }
+    audio_queued++;
+    audio_stats.buffers++;
+
+    uint32_t cycles = cycle_counter_now() - start;
+    audio_stats.refill_last = cycles;
+    audio_stats.refill_max = MAX(audio_stats.refill_max, cycles);
+    audio_stats.convert_last = convert_cycles;
+    audio_stats.convert_max = MAX(audio_stats.convert_max, convert_cycles);
+    audio_stats.mix_last = mix_cycles;
+    audio_stats.mix_max = MAX(audio_stats.mix_max, mix_cycles);
+    audio_stats.voices_max = MAX(audio_stats.voices_max, mixed);
+    return true;
+}
+
+static bool audio_any_playing(void) {
+    for (uint32_t i = 0; i < AUDIO_VOICE_COUNT; i++) {
+        if (audio_voices[i].state == AUDIO_VOICE_PLAYING) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Stop the SAI and hand the clocks back; the voices keep their state
+static void audio_stream_stop(void) {
+    if (audio_streaming) {
+        SAI_TransferTerminateSendEDMA(I2S0, &audio_sai_handle);
+        audio_streaming = false;
+    }
+    audio_queued = 0U;
+    audio_reclaimed = 0U;
+    power_governor_keep_bus_clock(POWER_BUS_USER_AUDIO, false);
+    clock_mode_request(CLOCK_CLIENT_AUDIO, CLOCK_MODE_VLPR);
+}
+
+// Set up the codec and SAI for the fixed output format and prime every
+// buffer from the playing voices
+static bool audio_stream_start(void) {
+    uint32_t mclk = audio_codec_set_format(AUDIO_OUTPUT_RATE, 2U);
+    if (mclk == 0U) {
+        LOG1(MSG_AUDIO_ERROR, AUDIO_FAIL_CODEC);
+        return false;
+    }
+
+    sai_transceiver_t saiConfig;
+    SAI_GetClassicI2SConfig(&saiConfig, kSAI_WordWidth16bits, kSAI_Stereo, kSAI_Channel0Mask);
+    SAI_TransferTxSetConfigEDMA(I2S0, &audio_sai_handle, &saiConfig);
+    SAI_TxSetBitClockRate(I2S0, mclk, AUDIO_OUTPUT_RATE, 16U, 2U);
+
+    audio_queued = 0U;
+    audio_reclaimed = 0U;
+    for (uint32_t i = 0; i < AUDIO_BUFFER_COUNT && audio_refill(); i++) {
+    }
+    if (audio_queued == 0U) {
+        LOG1(MSG_AUDIO_ERROR, AUDIO_FAIL_PRIME);
+        return false;
+    }
+    audio_streaming = true;
+    power_governor_keep_bus_clock(POWER_BUS_USER_AUDIO, true);
+    return true;
+}
+
+// Walk the RIFF chunks up to the data chunk. Bodies the reader does not
+// need (LIST, bext, ...) are seeked over rather than read. audio_raw is
+// free outside a refill, unlike the DMA buffers of a running stream.
+static bool audio_read_header(audio_voice_t *v) {
+    static wav_reader_t reader;
+    uint8_t *scratch = audio_raw;
+    wav_status_t status = WAV_STATUS_NEED_MORE;
+
+    wav_reader_init(&reader);
+    while (status == WAV_STATUS_NEED_MORE) {
+        uint32_t skip = wav_reader_pending_skip(&reader);
+        if (skip != 0U) {
+            if (f_lseek(&v->file, f_tell(&v->file) + skip) != FR_OK) {
+                return false;
+            }
+            wav_reader_skipped(&reader, skip);
+        }
+        UINT got = 0U;
+        if (f_read(&v->file, scratch, AUDIO_HEADER_READ, &got) != FR_OK) {
+            return false;
+        }
+        status = (got == 0U) ? wav_reader_end(&reader) : wav_reader_feed(&reader, scratch, got, NULL);
+    }
+    v->info = reader.info;
+    return status == WAV_STATUS_DATA;
+}
+
+// 8/16/24-bit PCM or IMA ADPCM, mono or stereo (the rate is checked by the resampler)
+static bool audio_format_supported(const wav_info_t *info) {
+    if (info->numChannels == 0U || info->numChannels > 2U) {
+        return false;
+    }
+    if (info->audioFormat == WAV_FORMAT_IMA_ADPCM) {
+        return info->blockAlign <= AUDIO_ADPCM_MAX_BLOCK;
+    }
+    return (info->bitsPerSample == 8U || info->bitsPerSample == 16U || info->bitsPerSample == 24U) &&
+           info->blockAlign == info->numChannels * (info->bitsPerSample / 8U);
+}
+
+// Give up on a voice that could not start
+static bool audio_voice_fail(audio_voice_t *v, audio_fail_stage_t stage) {
+    LOG1(MSG_AUDIO_ERROR, stage);
+    audio_voice_stop(v);
+    if (!audio_streaming) {
+        audio_stream_stop();
+    }
+    return false;
+}
+
+// Open the voice's WAV file and parse its header, leaving it at the samples
+static bool audio_voice_open_file(audio_voice_t *v) {
+    if (sd_storage_open(&v->file, v->path, NULL, 0U) != FR_OK) {
+        return audio_voice_fail(v, AUDIO_FAIL_OPEN);
+    }
+    v->state = AUDIO_VOICE_PLAYING;
+
+    if (!audio_read_header(v)) {
+        return audio_voice_fail(v, AUDIO_FAIL_HEADER);
+    }
+    if (!audio_format_supported(&v->info)) {
+        return audio_voice_fail(v, AUDIO_FAIL_FORMAT);
+    }
+    if (f_lseek(&v->file, v->info.dataOffset) != FR_OK) {
+        return audio_voice_fail(v, AUDIO_FAIL_SEEK);
+    }
+    v->data_left = v->info.dataSize;
+    FSIZE_t end = (FSIZE_t)v->info.dataOffset + v->info.dataSize;
+    sd_readahead_start(&v->ahead, &v->file, v->info.dataOffset, end, end);
+    return true;
+}
+
+// Start the voice's clip (bank clip or WAV file). The first voice starts
+// the stream; later ones join it at the next buffer refilled.
+static bool audio_voice_start(audio_voice_t *v) {
+    clock_mode_request(CLOCK_CLIENT_AUDIO, CLOCK_MODE_HSRUN);
+    v->clip = v->asset;
+    if (v->clip != NULL) {
+        // Format and place straight from the bank index
+        asset_clip_info(v->clip, &v->info);
+        v->state = AUDIO_VOICE_PLAYING;
+        v->pos = v->clip->offset;
+        v->data_left = (v->clip->loop_end != 0U) ? v->clip->loop_end : v->clip->length;
+        if (!audio_format_supported(&v->info)) {
+            return audio_voice_fail(v, AUDIO_FAIL_FORMAT);
+        }
+        if (audio_bank_image == NULL) {
+            FSIZE_t end = (FSIZE_t)v->pos + v->data_left;
+            FSIZE_t loop = (v->clip->loop_end != 0U) ? (FSIZE_t)v->pos + v->clip->loop_start : end;
+            sd_readahead_start(&v->ahead, &audio_bank_file, v->pos, end, loop);
+        }
+    } else if (!audio_voice_open_file(v)) {
+        return false;
+    }
+
+    // Everything reaches the mixer as 16-bit stereo at AUDIO_OUTPUT_RATE
+    v->resampling = (v->info.sampleRate != AUDIO_OUTPUT_RATE);
+    if (v->resampling && !resample_init(&v->resampler, v->info.sampleRate, AUDIO_OUTPUT_RATE, v->info.numChannels)) {
+        return audio_voice_fail(v, AUDIO_FAIL_RATE);
+    }
+    v->carry_frames = 0U;
+    v->level = 0;  // Fade in
+    audio_voice_ramp(v, v->gain);
+
+    if (!audio_streaming && !audio_stream_start()) {
+        audio_voice_stop(v);
+        audio_stream_stop();
+        return false;
+    }
+    audio_stats.clips++;
+    LOG3(MSG_AUDIO_STARTED, v->info.sampleRate, v->info.numChannels, calculate_audio_duration(&v->info));
+    return true;
+}
+
+// Top the ring back up after the SAI finished some buffers
+static void audio_service(void) {
+    if (!audio_streaming) {
+        return;
+    }
+    audio_reclaim();
+    if (audio_reclaimed == audio_queued && audio_any_playing()) {
+        // Every buffer drained before the card caught up; the SAI restarts on the next queue
+        audio_stats.underruns++;
+        LOG1(MSG_AUDIO_UNDERRUN, audio_stats.underruns);
+    }
+    while ((audio_queued - audio_reclaimed) < AUDIO_BUFFER_COUNT && audio_refill()) {
+    }
+    if (audio_reclaimed == audio_queued) {
+        // Last buffer of the last voice played out
+        audio_stream_stop();
+    }
+}
+
+// IMA-ADPCM decode speed on a mono block of pseudo-random codes (any bytes
+// are a valid stream), against the HSRUN core clock playback runs at
+static void audio_adpcm_benchmark(void) {
+    static uint8_t block[AUDIO_ADPCM_BENCH_BLOCK];
+    static int16_t samples[ADPCM_BLOCK_FRAMES(AUDIO_ADPCM_BENCH_BLOCK, 1U)];
+    uint32_t seed = 0x2468ACE1U;
+    for (uint32_t i = 0; i < sizeof(block); i++) {
+        seed = seed * 1664525U + 1013904223U;
+        block[i] = (uint8_t)(seed >> 24);
+    }
+    block[2] = 40U;  // Mid-range start index
+
+    uint32_t frames = 0U;
+    uint32_t start = cycle_counter_now();
+    for (uint32_t i = 0; i < AUDIO_ADPCM_BENCH_RUNS; i++) {
+        frames += adpcm_decode_block(block, sizeof(block), 1U, samples);
+    }
+    uint32_t cycles = cycle_counter_now() - start;
+    if (frames == 0U || cycles == 0U) {
+        return;
+    }
+    uint64_t realtime = ((uint64_t)BOARD_BOOTCLOCKHSRUN_CORE_CLOCK * frames) / ((uint64_t)cycles * AUDIO_OUTPUT_RATE);
+    PRINTF("[AUDIO] ADPCM decode %lu cycles per 100 samples, %lux real time for 44.1 kHz mono at 180 MHz\r\n",
+           (uint32_t)(((uint64_t)cycles * 100U) / frames), (uint32_t)realtime);
+}
+
+// Cost of mixing one voice into one DMA buffer, SIMD against the reference,
+// at half and unity gain, with a bit-exact comparison of the results. Runs
+// in audio_pcm and audio_voice_out, which are only used during a refill.
+static void audio_mix_benchmark(void) {
+    const uint32_t samples = AUDIO_FRAMES_PER_BUFFER * 2U;
+    const uint16_t gains[2] = {AUDIO_GAIN_HALF, AUDIO_GAIN_UNITY};
+    int16_t *in = audio_pcm;
+    int16_t *ref = &audio_pcm[samples];
+    int16_t *fast = audio_voice_out;
+    uint32_t cycles_ref[2];
+    uint32_t cycles_fast[2];
+    bool match = true;
+
+    for (uint32_t g = 0; g < 2U; g++) {
+        uint32_t seed = 0x13579BDFU;
+        for (uint32_t i = 0; i < samples; i++) {
+            seed = seed * 1664525U + 1013904223U;
+            in[i] = (int16_t)(seed >> 16);
+            seed = seed * 1664525U + 1013904223U;
+            ref[i] = (int16_t)(seed >> 16);  // Loud bed, so some sums saturate
+            fast[i] = ref[i];
+        }
+        uint32_t start = cycle_counter_now();
+        audio_mix_ref(ref, in, gains[g], samples);
+        cycles_ref[g] = cycle_counter_now() - start;
+        start = cycle_counter_now();
+        audio_mix(fast, in, gains[g], samples);
+        cycles_fast[g] = cycle_counter_now() - start;
+        match = match && (memcmp(ref, fast, samples * sizeof(int16_t)) == 0);
+    }
+    PRINTF("[AUDIO] Mix per voice per buffer: ref %lu/%lu cycles, SIMD %lu/%lu (half/unity gain), %s\r\n",
+           cycles_ref[0], cycles_ref[1], cycles_fast[0], cycles_fast[1], match ? "ok" : "MISMATCH");
+}
+
+bool audio_player_init(void) {
+    EDMA_CreateHandle(&audio_dma_handle, DMA0, AUDIO_DMA_CHANNEL);
+    DMAMUX_SetSource(DMAMUX, AUDIO_DMA_CHANNEL, (uint32_t)kDmaRequestMux0I2S0Tx);
+    DMAMUX_EnableChannel(DMAMUX, AUDIO_DMA_CHANNEL);
+
+    if (!audio_codec_init(audio_codec_notify)) {
+        return false;
+    }
+    SAI_TransferTxCreateHandleEDMA(I2S0, &audio_sai_handle, audio_sai_callback, NULL, &audio_dma_handle);
+
+    // The I2C divider comes from the bus clock: keep the boot clock (and the
+    // bus clock through idle) until the last register is written
+    audio_codec_starting = true;
+    clock_mode_request(CLOCK_CLIENT_AUDIO, CLOCK_MODE_HSRUN);
+    power_governor_keep_bus_clock(POWER_BUS_USER_AUDIO, true);
+    return true;
+}
+
+bool audio_player_is_ready(void) {
+    return audio_ready;
+}
+
+bool audio_player_is_starting(void) {
+    return audio_codec_starting;
+}
+
+// Continue the codec power-up; on the way out hand the clocks back
+static void audio_codec_step(void) {
+    audio_codec_status_t status = audio_codec_service();
+    if (!audio_codec_starting || status == AUDIO_CODEC_BUSY) {
+        return;
+    }
+    audio_codec_starting = false;
+    audio_ready = (status == AUDIO_CODEC_READY);
+    if (audio_ready) {
+        LOG0(MSG_AUDIO_CODEC_READY);
+    } else {
+        LOG1(MSG_AUDIO_CODEC_FAILED, audio_codec_failed_register());
+    }
+    audio_stream_stop();
+}
+
+bool audio_player_play(const char *path, uint32_t repeat_ms) {
+    return audio_player_play_voice(0U, path, repeat_ms, AUDIO_GAIN_UNITY);
+}
+
+bool audio_player_play_voice(uint32_t voice, const char *path, uint32_t repeat_ms, uint16_t gain) {
+    if (voice >= AUDIO_VOICE_COUNT || !audio_ready || !sd_storage_ready()) {
+        return false;
+    }
+    audio_voice_t *v = &audio_voices[voice];
+    bool playing = (v->state == AUDIO_VOICE_PLAYING);
+    audio_voice_fade_out(v, true);
+
+    // The open file is only read by the refill, so the path can change under it
+    (void)strncpy(v->path, path, sizeof(v->path) - 1U);
+    v->path[sizeof(v->path) - 1U] = '\0';
+    v->asset = NULL;
+    v->repeat_ms = repeat_ms;
+    v->gain = MIN(gain, AUDIO_GAIN_UNITY);
+    return playing || audio_voice_start(v);
+}
+
+bool audio_player_play_clip(uint32_t voice, uint32_t clip, uint32_t repeat_ms, uint16_t gain) {
+    const asset_clip_t *asset = (audio_bank != NULL) ? asset_bank_clip(audio_bank, clip) : NULL;
+    if (voice >= AUDIO_VOICE_COUNT || asset == NULL || !audio_ready ||
+        (audio_bank_image == NULL && !sd_storage_ready())) {
+        return false;
+    }
+    audio_voice_t *v = &audio_voices[voice];
+    bool playing = (v->state == AUDIO_VOICE_PLAYING);
+    audio_voice_fade_out(v, true);
+
+    // Like the path, the clip only takes over when the voice restarts
+    v->asset = asset;
+    v->repeat_ms = repeat_ms;
+    v->gain = MIN(gain, AUDIO_GAIN_UNITY);
+    return playing || audio_voice_start(v);
+}
+
+uint32_t audio_player_load_bank(const char *path) {
+    uint32_t clips = 0U;
+
+    if (asset_bank_image != NULL && &asset_bank_image_size != NULL) {
+        clips = asset_bank_check(asset_bank_image, asset_bank_image_size, asset_bank_image_size);
+        if (clips != 0U) {
+            audio_bank = asset_bank_image;
+            audio_bank_image = asset_bank_image;
+            return clips;
+        }
+    }
+    if (!sd_storage_ready() || sd_storage_open(&audio_bank_file, path, NULL, 0U) != FR_OK) {
+        return 0U;
+    }
+    // The header and the index are all that is kept; clips are read by offset
+    UINT got = 0U;
+    if (f_read(&audio_bank_file, audio_bank_index, sizeof(audio_bank_index), &got) == FR_OK) {
+        clips = asset_bank_check(audio_bank_index, got, (uint32_t)f_size(&audio_bank_file));
+    }
+    if (clips == 0U) {
+        (void)sd_storage_close(&audio_bank_file);
+        return 0U;
+    }
+    audio_bank = audio_bank_index;
+    return clips;
+}
+
+void audio_player_set_gain(uint32_t voice, uint16_t gain) {
+    if (voice < AUDIO_VOICE_COUNT) {
+        audio_voice_t *v = &audio_voices[voice];
+        v->gain = MIN(gain, AUDIO_GAIN_UNITY);
+        if (v->state == AUDIO_VOICE_PLAYING && !v->stopping) {
+            audio_voice_ramp(v, v->gain);
+        }
+    }
+}
+
+void audio_player_stop_voice(uint32_t voice) {
+    if (voice < AUDIO_VOICE_COUNT) {
+        audio_voice_fade_out(&audio_voices[voice], false);
+    }
+}
+
+void audio_player_stop(void) {
+    for (uint32_t i = 0; i < AUDIO_VOICE_COUNT; i++) {
+        audio_voice_fade_out(&audio_voices[i], false);
+    }
+}
+
+void audio_player_handle_event(uint8_t payload) {
+    if (payload == AUDIO_EVENT_BUFFER_DONE) {
+        audio_service();
+    } else if (payload == AUDIO_EVENT_CODEC) {
+        audio_codec_step();
+    } else if (payload >= AUDIO_EVENT_REPEAT && payload < AUDIO_EVENT_REPEAT + AUDIO_VOICE_COUNT) {
+        audio_voice_t *v = &audio_voices[payload - AUDIO_EVENT_REPEAT];
+        if (v->state == AUDIO_VOICE_WAIT_REPEAT) {
+            (void)audio_voice_start(v);
+        }
+    }
+}
+
+bool audio_player_read_ahead(void) {
+    bool more = false;
+    for (uint32_t i = 0; i < AUDIO_VOICE_COUNT; i++) {
+        audio_voice_t *v = &audio_voices[i];
+        if (v->state == AUDIO_VOICE_PLAYING && !v->stopping) {
+            more = sd_readahead_fill(&v->ahead) || more;
+        }
+    }
+    return more;
+}
+
+void audio_player_arm_probe(bool armed) {
+    audio_probe_armed = armed;
+    audio_probe_fresh = false;
+}
+
+bool audio_player_take_probe(audio_start_probe_t *probe) {
+    if (!audio_probe_fresh) {
+        return false;
+    }
+    *probe = audio_probe;
+    audio_probe_fresh = false;
+    return true;
+}
+
+bool audio_player_is_active(void) {
+    for (uint32_t i = 0; i < AUDIO_VOICE_COUNT; i++) {
+        if (audio_voices[i].state != AUDIO_VOICE_IDLE) {
+            return true;
+        }
+    }
+    return audio_streaming;
+}
+
+void audio_player_dump(void) {
+    static const char *const states[] = {"idle", "playing", "waiting"};
+
+    PRINTF("[AUDIO] Codec %s, card %s, %s\r\n",
+           audio_ready ? "ok" : audio_codec_starting ? "starting" : "missing",
+           sd_storage_ready() ? "mounted" : "missing", audio_streaming ? "streaming" : "stopped");
+    audio_codec_dump();
+    for (uint32_t i = 0; i < AUDIO_VOICE_COUNT; i++) {
+        const audio_voice_t *v = &audio_voices[i];
+        const char *state = v->stopping ? "fading out" : states[v->state];
+        PRINTF("[AUDIO] Voice %lu: %s, gain 0x%04x%s%s\r\n", i, state, v->gain,
+               (v->state != AUDIO_VOICE_IDLE) ? ", " : "", (v->state != AUDIO_VOICE_IDLE) ? v->path : "");
+    }
+    PRINTF("[AUDIO] Clip bank: %s, %lu clips\r\n",
+           (audio_bank == NULL) ? "none (WAV files)" : (audio_bank_image != NULL) ? "in flash" : "on SD card",
+           (audio_bank == NULL) ? 0U : (uint32_t)((const asset_bank_header_t *)audio_bank)->clip_count);
+    PRINTF("[AUDIO] Clips %lu, buffers %lu x %u bytes (%lu read in place from flash), underruns %lu, "
+           "up to %lu voices per buffer\r\n", audio_stats.clips, audio_stats.buffers, AUDIO_BUFFER_SIZE,
+           audio_stats.mapped, audio_stats.underruns, audio_stats.voices_max);
+    for (uint32_t i = 0; i < AUDIO_VOICE_COUNT; i++) {
+        const sd_readahead_t *ra = &audio_voices[i].ahead;
+        PRINTF("[AUDIO] Voice %lu read-ahead: %lu of %lu bytes buffered, %lu per buffer, %lu stalls, "
+               "%lu bytes uncopied, %lu copied\r\n",
+               i, ra->count, ra->depth, ra->rate, ra->stalls, ra->fast_bytes, ra->copy_bytes);
+    }
+    PRINTF("[AUDIO] Refill last=%lu max=%lu cycles, convert/resample last=%lu max=%lu, mix last=%lu max=%lu\r\n",
+           audio_stats.refill_last, audio_stats.refill_max, audio_stats.convert_last, audio_stats.convert_max,
+           audio_stats.mix_last, audio_stats.mix_max);
+    PRINTF("[AUDIO] RIFF walker %lu cycles per multi-chunk header (0 = self-check failed)\r\n",
+           wav_reader_benchmark(AUDIO_WAV_BENCH_RUNS));
+    audio_convert_benchmark();
+    audio_adpcm_benchmark();
+    audio_mix_benchmark();
+}
@@ -0,0 +1,145 @@
+/*
+ * SEH500 Project - Streaming WAV player
+ *
+ * Plays 8/16/24-bit PCM or IMA-ADPCM WAV files, mono or stereo, from the
+ * SD card through the SAI and the DA7212 without loading them into RAM.
+ * Up to AUDIO_VOICE_COUNT clips play at once (say an attention chime over
+ * a spoken phrase over a periodic beep), each on its own voice with its
+ * own file, repeat timer and Q15 gain. The SAI and codec always run 16-bit
+ * stereo at AUDIO_OUTPUT_RATE: each voice is read into a staging buffer,
+ * converted by the audio_convert kernels and, for any other sample rate
+ * (8 kHz up to 48 kHz), resampled by audio_resample, then audio_mix() adds
+ * it into the DMA buffer with saturation. A lone voice at unity gain skips
+ * the mixer and is rendered straight into the DMA buffer.
+ *
+ * Nothing starts or stops with a step: every clip fades in, stopping or
+ * replacing a voice fades it out first, and gain changes ramp (all over
+ * about 12 ms). Volume is applied here in software, so it
+ * costs no I2C traffic to the codec, whose headphone gain stays at 0 dB.
+ *
+ * AUDIO_BUFFER_COUNT buffers form a ring: all of them are queued on the
+ * SAI eDMA handle (one TCD each, scatter-gather, so the DMA moves from one
+ * to the next with no gap). Each completed buffer raises the DMA
+ * interrupt, which only posts an EVENT_SOURCE_AUDIO event; the main loop
+ * renders and mixes the voices into the free buffers and queues them
+ * again, so the mixing cost (linear in the voices playing) never lands in
+ * the interrupt. The CPU never waits on the SAI, and as long as a buffer
+ * is ready faster than the SAI drains one the stream is gapless. If the
+ * ring ever runs dry it is counted as an underrun and the stream resumes
+ * with the next refill. The first voice starts the stream, later ones join
+ * at the next refill, and the SAI stops once every voice has ended and
+ * the ring has drained.
+ *
+ * Voices do not read the card during a refill: each keeps a read-ahead
+ * window of its sample data (sd_readahead.h), which the main loop tops up
+ * between events through audio_player_read_ahead(), so the refill only
+ * copies from RAM. The card fills the windows in the background
+ * (sd_async.h) while the main loop handles events, and decoders read
+ * their input in place in the window rather than copying it out.
+ *
+ * While anything plays the player holds HSRUN (the SAI MCLK divides the
+ * core clock and SD reads need the mount-time clock) and keeps the bus
+ * clock running through idle.
+ */
+
+#ifndef AUDIO_PLAYER_H_
+#define AUDIO_PLAYER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Ring depth; equals SAI_XFER_QUEUE_SIZE so every buffer can be queued at once
+#define AUDIO_BUFFER_COUNT 4U
+
+// Bytes per buffer (a multiple of the 512-byte sector so f_read goes straight
+// to the card); 4 KB is 23 ms of 44.1 kHz stereo
+#define AUDIO_BUFFER_SIZE 4096U
+
+// Fixed codec/SAI rate; clips at other rates are resampled to it
+#define AUDIO_OUTPUT_RATE 44100U
+
+// Clips that can play at the same time
+#define AUDIO_VOICE_COUNT 3U
+
+// eDMA channel for SAI0 TX (channels 1-2 belong to the LEDs)
+#define AUDIO_DMA_CHANNEL 0U
+
+// EVENT_SOURCE_AUDIO payloads
+typedef enum {
+    AUDIO_EVENT_BUFFER_DONE = 0,  // SAI finished one or more buffers
+    AUDIO_EVENT_CODEC,            // Codec power-up step done, continue it
+    AUDIO_EVENT_REPEAT,           // Repeat gap elapsed, start the clip again (+ voice index)
+} audio_event_t;
+
+// Start powering up the codec and create the SAI eDMA handle. Returns false
+// if the codec does not answer; play requests then fail without touching
+// the SAI. The power-up finishes in the background (EVENT_SOURCE_AUDIO
+// events), and play requests fail until it has; audio_player_is_ready()
+// says when.
+bool audio_player_init(void);
+
+// True once the codec is powered up and clips can play
+bool audio_player_is_ready(void);
+
+// True while the codec power-up is still running (whatever its outcome)
+bool audio_player_is_starting(void);
+
+// Stream-start times in cycle_counter_us(), for the button-to-sound benchmark
+typedef struct {
+    uint32_t dma_us;     // The eDMA's first read from the first buffer (0 = not seen)
+    uint32_t sound_us;   // First non-zero sample left the SAI FIFO (0 = not seen)
+} audio_start_probe_t;
+
+// While armed, every stream start records an audio_start_probe_t. Finding
+// the first sample busy-waits in the main loop until it has played (up to
+// 10 ms into a clip that fades in from silence), so only the benchmark arms it.
+void audio_player_arm_probe(bool armed);
+
+// Fetch the start recorded since the last call; false if there was none
+bool audio_player_take_probe(audio_start_probe_t *probe);
+
+// Start streaming a file on voice 0 at unity gain, replacing what that
+// voice was playing. With repeat_ms != 0 the clip restarts repeat_ms after
+// each end until stopped. Returns false if the card, file or format is
+// unusable; a clip replacing one still playing starts once the old one has
+// faded out, and only logs if it then fails.
+bool audio_player_play(const char *path, uint32_t repeat_ms);
+
+// As audio_player_play() on any voice, mixed at a Q15 gain (AUDIO_GAIN_UNITY
+// or audio_volume_gain() from audio_mixer.h); the other voices carry on
+bool audio_player_play_voice(uint32_t voice, const char *path, uint32_t repeat_ms, uint16_t gain);
+
+// Use a clip bank (asset_bank.h) for audio_player_play_clip(): the one
+// linked into flash if the build has it, else the bank file at path on
+// the SD card, which stays open. Returns the clips in it, 0 if neither is
+// usable.
+uint32_t audio_player_load_bank(const char *path);
+
+// As audio_player_play_voice() for clip ID clip of the loaded bank. A clip
+// with loop points plays its loop until stopped (repeat_ms is then unused).
+bool audio_player_play_clip(uint32_t voice, uint32_t clip, uint32_t repeat_ms, uint16_t gain);
+
+// Ramp a voice to a new Q15 gain, starting with the next buffer refilled
+void audio_player_set_gain(uint32_t voice, uint16_t gain);
+
+// Fade one voice out and cancel its repeat; the others carry on
+void audio_player_stop_voice(uint32_t voice);
+
+// Fade every voice out and cancel any pending repeat
+void audio_player_stop(void);
+
+// Handle an EVENT_SOURCE_AUDIO event (main loop only)
+void audio_player_handle_event(uint8_t payload);
+
+// Main loop, before sleeping: read ahead for each playing voice that is
+// below its read-ahead depth (sd_readahead_fill()). Returns true while there
+// is more to read; the loop should come back instead of sleeping.
+bool audio_player_read_ahead(void);
+
+// True while any voice is streaming or waiting to repeat
+bool audio_player_is_active(void);
+
+// Print stream statistics on the debug console
+void audio_player_dump(void);
+
+#endif /* AUDIO_PLAYER_H_ */
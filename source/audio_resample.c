@@ -0,0 +1,214 @@
+/*
+ * SEH500 Project - Streaming polyphase sample-rate converter
+ * See audio_resample.h
+ */
+
+#include <string.h>
+#include "audio_resample.h"
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "fsl_common.h"  // CMSIS SIMD intrinsics
+#define RESAMPLE_SIMD 1
+#else
+#define RESAMPLE_SIMD 0
+#endif
+
+#define RESAMPLE_HALF (RESAMPLE_TAPS / 2U)
+
+// Cutoff as a fraction of the lower Nyquist rate, and the Kaiser window
+// shape (beta 8 keeps sidelobes near -80 dB, below 16-bit noise after Q15)
+#define RESAMPLE_CUTOFF 0.9f
+#define RESAMPLE_BETA   8.0f
+
+#define RESAMPLE_TABLE_SIZE ((RESAMPLE_PHASES + 1U) * RESAMPLE_TAPS)
+
+// Slot 0 holds the upsampling table, slot 1 the last downsampling cutoff.
+// With a fixed output rate that covers every clip (only 48 kHz is reduced).
+typedef struct {
+    float cutoff;  // 0 = not built
+    int16_t coefs[RESAMPLE_TABLE_SIZE];
+} resample_table_t;
+
+static resample_table_t resample_tables[2];
+
+// ---- Filter design (once per cutoff, single precision) ----
+
+// sin(pi * x) for 0 <= x <= 1
+static float resample_sinpi(float x) {
+    if (x > 0.5f) {
+        x = 1.0f - x;
+    }
+    float t = x * 3.14159265f;
+    float t2 = t * t;
+    return t * (1.0f - t2 / 6.0f * (1.0f - t2 / 20.0f * (1.0f - t2 / 42.0f * (1.0f - t2 / 72.0f * (1.0f - t2 / 110.0f)))));
+}
+
+// sin(pi x) / (pi x)
+static float resample_sinc(float x) {
+    if (x < 0.0f) {
+        x = -x;
+    }
+    if (x < 1e-6f) {
+        return 1.0f;
+    }
+    uint32_t whole = (uint32_t)x;
+    float s = resample_sinpi(x - (float)whole);
+    return ((whole & 1U) ? -s : s) / (3.14159265f * x);
+}
+
+// Modified Bessel I0 of sqrt(x2), by its power series
+static float resample_i0_sq(float x2) {
+    float term = 1.0f;
+    float sum = 1.0f;
+    for (uint32_t k = 1; k < 40U && term > sum * 1e-9f; k++) {
+        term *= x2 / (4.0f * (float)(k * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Phase p, tap k covers input sample (k - HALF + 1) relative to the output's
+// integer position, at distance d = k - HALF + 1 - p / PHASES. The extra
+// phase PHASES lets every output blend phase p with p + 1. Each phase is
+// normalised to unity DC gain so the blend has no ripple.
+static void resample_design(int16_t *coefs, float cutoff) {
+    float window_norm = resample_i0_sq(RESAMPLE_BETA * RESAMPLE_BETA);
+    float h[RESAMPLE_TAPS];
+
+    for (uint32_t p = 0; p <= RESAMPLE_PHASES; p++) {
+        float sum = 0.0f;
+        for (uint32_t k = 0; k < RESAMPLE_TAPS; k++) {
+            float d = (float)k - (float)(RESAMPLE_HALF - 1U) - (float)p / (float)RESAMPLE_PHASES;
+            float r = d / (float)RESAMPLE_HALF;
+            float w = (r * r < 1.0f) ? resample_i0_sq(RESAMPLE_BETA * RESAMPLE_BETA * (1.0f - r * r)) / window_norm
+                                     : 0.0f;
+            h[k] = cutoff * resample_sinc(cutoff * d) * w;
+            sum += h[k];
+        }
+        for (uint32_t k = 0; k < RESAMPLE_TAPS; k++) {
+            float q = h[k] / sum * 32768.0f;
+            int32_t c = (int32_t)(q + ((q < 0.0f) ? -0.5f : 0.5f));
+            coefs[p * RESAMPLE_TAPS + k] = (int16_t)((c > INT16_MAX) ? INT16_MAX : (c < INT16_MIN) ? INT16_MIN : c);
+        }
+    }
+}
+
+// ---- Filtering ----
+
+static int32_t resample_dot(const int16_t *x, const int16_t *c) {
+    int32_t acc = 0;
+#if RESAMPLE_SIMD
+    // Two taps per __SMLAD; the history is not word aligned in general
+    for (uint32_t k = 0; k < RESAMPLE_TAPS; k += 2U) {
+        acc = (int32_t)__SMLAD(__UNALIGNED_UINT32_READ(&x[k]), __UNALIGNED_UINT32_READ(&c[k]), (uint32_t)acc);
+    }
+#else
+    for (uint32_t k = 0; k < RESAMPLE_TAPS; k++) {
+        acc += (int32_t)x[k] * c[k];
+    }
+#endif
+    return acc;
+}
+
+// One output sample: phases p and p + 1 blended by the 16-bit fraction between them
+static int16_t resample_sample(const int16_t *x, const int16_t *c0, uint32_t blend) {
+    int32_t a = resample_dot(x, c0);
+    int32_t b = resample_dot(x, c0 + RESAMPLE_TAPS);
+    int64_t y = (int64_t)a + ((((int64_t)b - a) * (int64_t)blend) >> 16);
+    y = (y + (1 << 14)) >> 15;
+    return (int16_t)((y > INT16_MAX) ? INT16_MAX : (y < INT16_MIN) ? INT16_MIN : y);
+}
+
+bool resample_init(resampler_t *rs, uint32_t in_rate, uint32_t out_rate, uint32_t channels) {
+    if (in_rate < RESAMPLE_MIN_RATE || out_rate == 0U || (uint64_t)in_rate * 8U > (uint64_t)out_rate * 9U ||
+        channels == 0U || channels > 2U) {
+        return false;
+    }
+
+    float cutoff = RESAMPLE_CUTOFF;
+    resample_table_t *table = &resample_tables[0];
+    if (in_rate > out_rate) {
+        cutoff = RESAMPLE_CUTOFF * (float)out_rate / (float)in_rate;
+        table = &resample_tables[1];
+    }
+    if (table->cutoff != cutoff) {
+        resample_design(table->coefs, cutoff);
+        table->cutoff = cutoff;
+    }
+
+    uint64_t step = ((uint64_t)in_rate << 32) / out_rate;
+    rs->coefs = table->coefs;
+    rs->channels = channels;
+    rs->step_int = (uint32_t)(step >> 32);
+    rs->step_frac = (uint32_t)step;
+    rs->pos = RESAMPLE_HALF - 1U;  // First input frame lands here, at output time 0
+    rs->frac = 0U;
+    rs->fill = RESAMPLE_HALF - 1U;
+    rs->ended = false;
+    memset(rs->work, 0, sizeof(rs->work));
+    return true;
+}
+
+uint32_t resample_input_needed(const resampler_t *rs, uint32_t out_frames) {
+    if (out_frames == 0U || rs->ended) {
+        return 0U;
+    }
+    uint64_t step = ((uint64_t)rs->step_int << 32) | rs->step_frac;
+    uint64_t span = (uint64_t)rs->frac + (uint64_t)(out_frames - 1U) * step;
+    uint32_t need = rs->pos + (uint32_t)(span >> 32) + RESAMPLE_HALF + 1U;
+    uint32_t room = RESAMPLE_WORK_FRAMES - RESAMPLE_HALF - rs->fill;
+    need = (need > rs->fill) ? (need - rs->fill) : 0U;
+    return (need < room) ? need : room;
+}
+
+int16_t *resample_input(resampler_t *rs, uint32_t channel) {
+    return &rs->work[channel][rs->fill];
+}
+
+void resample_commit(resampler_t *rs, uint32_t frames) {
+    rs->fill += frames;
+}
+
+void resample_end(resampler_t *rs) {
+    if (!rs->ended) {
+        for (uint32_t ch = 0; ch < rs->channels; ch++) {
+            memset(&rs->work[ch][rs->fill], 0, RESAMPLE_HALF * sizeof(int16_t));
+        }
+        rs->fill += RESAMPLE_HALF;
+        rs->ended = true;
+    }
+}
+
+uint32_t resample_process(resampler_t *rs, int16_t *out, uint32_t max_out) {
+    uint32_t n = 0;
+
+    // Output needs taps up to pos + HALF
+    while (n < max_out && rs->pos + RESAMPLE_HALF < rs->fill) {
+        const int16_t *c0 = &rs->coefs[(rs->frac >> (32U - RESAMPLE_PHASE_BITS)) * RESAMPLE_TAPS];
+        uint32_t blend = (rs->frac >> (16U - RESAMPLE_PHASE_BITS)) & 0xFFFFU;
+        uint32_t base = rs->pos - (RESAMPLE_HALF - 1U);
+
+        int16_t left = resample_sample(&rs->work[0][base], c0, blend);
+        out[2U * n] = left;
+        out[2U * n + 1U] = (rs->channels == 2U) ? resample_sample(&rs->work[1][base], c0, blend) : left;
+        n++;
+
+        uint32_t old = rs->frac;
+        rs->frac += rs->step_frac;
+        rs->pos += rs->step_int + ((rs->frac < old) ? 1U : 0U);
+    }
+
+    // Slide out the frames no later output can reach
+    uint32_t drop = rs->pos - (RESAMPLE_HALF - 1U);
+    if (drop > rs->fill) {
+        drop = rs->fill;
+    }
+    if (drop != 0U) {
+        for (uint32_t ch = 0; ch < rs->channels; ch++) {
+            memmove(rs->work[ch], &rs->work[ch][drop], (rs->fill - drop) * sizeof(int16_t));
+        }
+        rs->fill -= drop;
+        rs->pos -= drop;
+    }
+    return n;
+}
@@ -0,0 +1,85 @@
+/*
+ * SEH500 Project - Streaming polyphase sample-rate converter
+ *
+ * Brings 16-bit PCM from a clip's rate to the codec's fixed output rate,
+ * so 8/11.025/16/22.05/32/48 kHz clips all play without reprogramming the
+ * DA7212. The filter is a Kaiser-windowed sinc of RESAMPLE_TAPS taps cut
+ * into RESAMPLE_PHASES phases. Each output sample is the two Q15 dot
+ * products for the phases either side of its exact position, blended
+ * linearly, so any ratio works and the cost per output frame is fixed:
+ * 2 x RESAMPLE_TAPS multiply-accumulates per channel (__SMLAD does two at
+ * a time on the Cortex-M4).
+ *
+ * The read position is a 32.32 fixed-point input index, so the ratio is
+ * exact enough that long clips never drift. Upsampling cuts off at 0.45 of
+ * the input rate, downsampling at 0.45 of the output rate. Output frame n
+ * lines up with input time n * in_rate / out_rate (the filter delay is
+ * absorbed by starting half a filter into zeroed history).
+ *
+ * Streaming use: ask resample_input_needed() how many frames a block of
+ * output takes, write them (planar, one array per channel) at
+ * resample_input(), resample_commit() them, then resample_process() into
+ * interleaved stereo. resample_end() after the last input flushes the tail.
+ *
+ * Apart from the SIMD path this file uses no SDK header, so
+ * tools/resample_check.c can build it on the host and measure it against
+ * a double-precision reference.
+ */
+
+#ifndef AUDIO_RESAMPLE_H_
+#define AUDIO_RESAMPLE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Filter length in input samples, and phases per input sample (power of two)
+#define RESAMPLE_TAPS       32U
+#define RESAMPLE_PHASE_BITS 6U
+#define RESAMPLE_PHASES     (1U << RESAMPLE_PHASE_BITS)
+
+// Output frames per resample_process() call at most
+#define RESAMPLE_MAX_OUT 1024U
+
+// Supported input rates: from RESAMPLE_MIN_RATE up to 9/8 of the output rate
+// (48 kHz into 44.1 kHz); RESAMPLE_MAX_IN is the input that many outputs can take
+#define RESAMPLE_MIN_RATE 8000U
+#define RESAMPLE_MAX_IN   (RESAMPLE_MAX_OUT + RESAMPLE_MAX_OUT / 8U + 2U)
+
+// History + one block of input + the silent tail added by resample_end()
+#define RESAMPLE_WORK_FRAMES (RESAMPLE_TAPS + RESAMPLE_MAX_IN + RESAMPLE_TAPS / 2U)
+
+typedef struct {
+    const int16_t *coefs;  // (RESAMPLE_PHASES + 1) x RESAMPLE_TAPS, Q15
+    uint32_t channels;
+    uint32_t step_int;     // Input frames per output frame, 32.32
+    uint32_t step_frac;
+    uint32_t pos;          // Work index of the next output frame
+    uint32_t frac;         // and its fractional part
+    uint32_t fill;         // Frames held in work
+    bool ended;
+    int16_t work[2][RESAMPLE_WORK_FRAMES];
+} resampler_t;
+
+// Set up a converter for in_rate -> out_rate with 1 or 2 channels. Builds
+// the filter table on first use of a cutoff (one upsampling and one
+// downsampling table are kept). False if the rates or channels are unsupported.
+bool resample_init(resampler_t *rs, uint32_t in_rate, uint32_t out_rate, uint32_t channels);
+
+// Input frames to commit before out_frames (<= RESAMPLE_MAX_OUT) outputs can be produced
+uint32_t resample_input_needed(const resampler_t *rs, uint32_t out_frames);
+
+// Where the next input frames for a channel go (planar)
+int16_t *resample_input(resampler_t *rs, uint32_t channel);
+
+// Account for frames written at resample_input()
+void resample_commit(resampler_t *rs, uint32_t frames);
+
+// No more input: append RESAMPLE_TAPS / 2 frames of silence so the last
+// samples make it through the filter. Safe to call more than once.
+void resample_end(resampler_t *rs);
+
+// Produce up to max_out interleaved stereo frames (mono is duplicated into
+// both channels); returns the number written
+uint32_t resample_process(resampler_t *rs, int16_t *out, uint32_t max_out);
+
+#endif /* AUDIO_RESAMPLE_H_ */
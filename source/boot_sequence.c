@@ -0,0 +1,135 @@
+/*
+ * SEH500 Project - Boot sequencer and boot-time profiler
+ * See boot_sequence.h
+ */
+
+#include "boot_sequence.h"
+#include "fsl_common.h"
+#include "fsl_debug_console.h"
+#include "cycle_counter.h"
+
+typedef enum {
+    BOOT_STEP_PENDING = 0,
+    BOOT_STEP_BACKGROUND,  // run() returned, done() not yet true
+    BOOT_STEP_DONE,
+    BOOT_STEP_FAILED,
+} boot_step_state_t;
+
+typedef struct {
+    boot_step_state_t state;
+    uint32_t start_us;
+    uint32_t end_us;   // run() returned
+    uint32_t done_us;  // Background work finished (= end_us without done())
+} boot_record_t;
+
+static const boot_step_t *boot_steps;
+static uint32_t boot_step_count;
+static boot_record_t boot_records[BOOT_MAX_STEPS];
+static uint32_t boot_finished;  // Bit per step that is done or failed
+static bool boot_complete = false;
+static uint32_t boot_total_us;
+
+void boot_sequence_start(void) {
+    cycle_counter_init();
+}
+
+static bool boot_step_ready(uint32_t i, bool deferred) {
+    return boot_records[i].state == BOOT_STEP_PENDING && boot_steps[i].deferred == deferred &&
+           (boot_steps[i].needs & ~boot_finished) == 0U;
+}
+
+static void boot_step_finish(uint32_t i, boot_step_state_t state, uint32_t now_us) {
+    boot_records[i].state = state;
+    boot_records[i].done_us = now_us;
+    boot_finished |= BOOT_NEEDS(i);
+}
+
+static void boot_step_run(uint32_t i) {
+    boot_record_t *r = &boot_records[i];
+    r->start_us = cycle_counter_us();
+    bool ok = boot_steps[i].run();
+    r->end_us = cycle_counter_us();
+    if (!ok) {
+        boot_step_finish(i, BOOT_STEP_FAILED, r->end_us);
+    } else if (boot_steps[i].done != NULL && !boot_steps[i].done()) {
+        r->state = BOOT_STEP_BACKGROUND;
+    } else {
+        boot_step_finish(i, BOOT_STEP_DONE, r->end_us);
+    }
+}
+
+// Run ready steps of one kind until none is left (or after the first, if once)
+static bool boot_run_ready(bool deferred, bool once) {
+    bool progress = false;
+    bool again = true;
+    while (again) {
+        again = false;
+        for (uint32_t i = 0; i < boot_step_count; i++) {
+            if (boot_step_ready(i, deferred)) {
+                boot_step_run(i);
+                progress = true;
+                if (once) {
+                    return true;
+                }
+                again = true;  // It may have unblocked an earlier entry
+            }
+        }
+    }
+    return progress;
+}
+
+void boot_sequence_run(const boot_step_t *steps, uint32_t count) {
+    boot_steps = steps;
+    boot_step_count = MIN(count, BOOT_MAX_STEPS);
+    (void)boot_run_ready(false, false);
+}
+
+bool boot_sequence_service(void) {
+    if (boot_complete) {
+        return false;
+    }
+
+    bool busy = false;
+    for (uint32_t i = 0; i < boot_step_count; i++) {
+        if (boot_records[i].state == BOOT_STEP_BACKGROUND) {
+            if (boot_steps[i].done()) {
+                boot_step_finish(i, BOOT_STEP_DONE, cycle_counter_us());
+            } else {
+                busy = true;
+            }
+        }
+    }
+    bool progress = boot_run_ready(false, false);
+    progress = boot_run_ready(true, true) || progress;
+
+    // Done when nothing runs in the background and nothing more can start
+    // (a step whose dependencies never finish is reported as not run)
+    if (!busy && !progress) {
+        boot_complete = true;
+        boot_total_us = cycle_counter_us();
+    }
+    return !boot_complete;
+}
+
+uint32_t boot_sequence_total_us(void) {
+    return boot_total_us;
+}
+
+void boot_sequence_dump(void) {
+    PRINTF("[BOOT] Step          start us  took us  done us\r\n");
+    for (uint32_t i = 0; i < boot_step_count; i++) {
+        const boot_record_t *r = &boot_records[i];
+        if (r->state == BOOT_STEP_PENDING) {
+            PRINTF("[BOOT] %-12s  not run\r\n", boot_steps[i].name);
+            continue;
+        }
+        PRINTF("[BOOT] %-12s %9lu %8lu %8lu %s%s\r\n", boot_steps[i].name, r->start_us, r->end_us - r->start_us,
+               r->done_us, boot_steps[i].deferred ? "deferred" : "",
+               (r->state == BOOT_STEP_FAILED) ? " FAILED" : (r->state == BOOT_STEP_BACKGROUND) ? " running" : "");
+    }
+    if (boot_complete) {
+        PRINTF("[BOOT] Complete after %lu us\r\n", boot_total_us);
+    } else {
+        PRINTF("[BOOT] Still in progress\r\n");
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * SEH500 Project - Boot sequencer and boot-time profiler
+ *
+ * Startup is a table of steps, each naming the steps it depends on.
+ * boot_sequence_run() runs every step whose dependencies are met, in table
+ * order, so the inputs can be armed first and the buttons are live a few
+ * microseconds after reset. Slow steps that nothing interactive waits for
+ * (mounting the SD card) are marked deferred and left to the main loop,
+ * one per pass through boot_sequence_service(), with button and keyboard
+ * events handled in between. A step whose work carries on after it
+ * returns (the codec power-up) names a done() poll; the step counts as
+ * finished, and its dependants may run, once that returns true.
+ *
+ * Every step start, end and background completion is stamped with the DWT
+ * cycle counter and converted at the core clock of the moment, so the
+ * timeline stays in real microseconds across the clock switches boot
+ * makes. The main loop must not sleep until boot_sequence_service()
+ * returns false: the cycle counter stops while the core does.
+ */
+
+#ifndef BOOT_SEQUENCE_H_
+#define BOOT_SEQUENCE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BOOT_MAX_STEPS 16U
+
+// Dependency bit for a step index, or'ed together in boot_step_t.needs
+#define BOOT_NEEDS(step) (1UL << (step))
+
+typedef struct {
+    const char *name;
+    bool (*run)(void);   // false = failed; boot carries on and the timeline says so
+    bool (*done)(void);  // NULL, or true once the step's background work is over
+    uint32_t needs;      // BOOT_NEEDS() of every step that must finish first
+    bool deferred;       // Run from the main loop instead of before it
+} boot_step_t;
+
+// Start the boot clock: first thing in main(), before any clock setup
+void boot_sequence_start(void);
+
+// Run every step that is ready and not deferred. The table must stay
+// valid until boot is complete; at most BOOT_MAX_STEPS entries.
+void boot_sequence_run(const boot_step_t *steps, uint32_t count);
+
+// Main loop: run the next ready deferred step and poll background work.
+// Returns true while boot is still in progress.
+bool boot_sequence_service(void);
+
+// Microseconds from boot_sequence_start() to the last step finishing
+uint32_t boot_sequence_total_us(void);
+
+// Print the boot timeline
+void boot_sequence_dump(void);
+
+#endif /* BOOT_SEQUENCE_H_ */
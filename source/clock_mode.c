@@ -0,0 +1,260 @@
+/*
+ * SEH500 Project - Clock mode manager
+ * See clock_mode.h
+ */
+
+#include "clock_mode.h"
+#include "board.h"
+#include "clock_config.h"
+#include "fsl_common.h"
+#include "fsl_clock.h"
+#include "fsl_smc.h"
+#include "fsl_uart.h"
+#include "fsl_debug_console.h"
+#include "cycle_counter.h"
+#include "timer_service.h"
+
+typedef struct {
+    const mcg_config_t *mcg;
+    const sim_clock_config_t *sim;
+} clock_mode_config_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t last;  // Core cycles for the whole switch, peripherals included
+    uint32_t max;
+} clock_switch_stats_t;
+
+// RUN: same PLL source as HSRUN with a 120 MHz VCO (x20 instead of x30)
+static const mcg_config_t clock_mcg_run = {
+    .mcgMode         = kMCG_ModePEE,
+    .irclkEnableMode = kMCG_IrclkEnable,
+    .ircs            = kMCG_IrcSlow,
+    .fcrdiv          = 0x1U,
+    .frdiv           = 0x0U,
+    .drs             = kMCG_DrsLow,
+    .dmx32           = kMCG_Dmx32Default,
+    .oscsel          = kMCG_OscselOsc,
+    .pll0Config      = {.enableMode = 0U, .prdiv = 0x0U, .vdiv = 0x4U},
+    .pllcs           = kMCG_PllClkSelPll0,
+};
+
+// Peripheral clock selections stay as BOARD_BootClockHSRUN set them;
+// only the SIM_CLKDIV1 dividers change between modes
+static const sim_clock_config_t clock_sim_run = {
+    .pllFllSel  = 3U,            // IRC48MCLK
+    .pllFllDiv  = 0U,
+    .pllFllFrac = 0U,
+    .er32kSrc   = 2U,            // RTC32KCLK
+    .clkdiv1    = 0x01140000U,   // Core /1 120 MHz, bus /2 60 MHz, FlexBus /2 60 MHz, flash /5 24 MHz
+};
+
+static const sim_clock_config_t clock_sim_vlpr = {
+    .pllFllSel  = 3U,
+    .pllFllDiv  = 0U,
+    .pllFllFrac = 0U,
+    .er32kSrc   = 2U,
+    .clkdiv1    = 0x00040000U,   // Core/bus/FlexBus /1 4 MHz, flash /5 800 kHz
+};
+
+static const clock_mode_config_t clock_mode_configs[CLOCK_MODE_COUNT] = {
+    [CLOCK_MODE_VLPR]  = {&mcgConfig_BOARD_BootClockVLPR, &clock_sim_vlpr},
+    [CLOCK_MODE_RUN]   = {&clock_mcg_run, &clock_sim_run},
+    [CLOCK_MODE_HSRUN] = {&mcgConfig_BOARD_BootClockHSRUN, &simConfig_BOARD_BootClockHSRUN},
+};
+
+static const char *const clock_mode_names[CLOCK_MODE_COUNT] = {"VLPR", "RUN", "HSRUN"};
+static const char *const clock_client_names[CLOCK_CLIENT_COUNT] = {"console", "audio", "sd"};
+
+static clock_mode_t current_mode = CLOCK_MODE_HSRUN;  // BOARD_InitBootClocks leaves us here
+static clock_mode_t client_modes[CLOCK_CLIENT_COUNT];
+static clock_switch_stats_t switch_stats[CLOCK_MODE_COUNT][CLOCK_MODE_COUNT];
+static clock_mode_listener_t listeners[CLOCK_MODE_MAX_LISTENERS];
+static uint32_t listener_count = 0;
+static sw_timer_t downshift_timer;
+static volatile bool downshift_due = false;
+
+// Fastest mode any client asked for
+static clock_mode_t clock_mode_target(void) {
+    clock_mode_t target = CLOCK_MODE_VLPR;
+    for (uint32_t i = 0; i < CLOCK_CLIENT_COUNT; i++) {
+        if (client_modes[i] > target) {
+            target = client_modes[i];
+        }
+    }
+    return target;
+}
+
+// Let the last console byte leave before the UART clock changes
+static void clock_mode_drain_console(void) {
+    UART_Type *uartBase = (UART_Type *)BOARD_DEBUG_UART_BASEADDR;
+    while ((UART_GetStatusFlags(uartBase) & kUART_TransmissionCompleteFlag) == 0U) {
+    }
+}
+
+// PEE -> PBE: run from the 12 MHz OSC while the PLL is reconfigured or stopped
+static void clock_mode_bypass_pll(void) {
+    MCG->C1 = (uint8_t)((MCG->C1 & ~MCG_C1_CLKS_MASK) | MCG_C1_CLKS(kMCG_ClkOutSrcExternal));
+    while ((MCG->S & MCG_S_CLKST_MASK) != MCG_S_CLKST(2U)) {  // 2 = external reference selected
+    }
+}
+
+static void clock_mode_set_power_mode(clock_mode_t mode) {
+    if (mode == CLOCK_MODE_HSRUN) {
+        (void)SMC_SetPowerModeHsrun(SMC);
+        while (SMC_GetPowerModeState(SMC) != kSMC_PowerStateHsrun) {
+        }
+    } else if (mode == CLOCK_MODE_VLPR) {
+        (void)SMC_SetPowerModeVlpr(SMC);
+        while (SMC_GetPowerModeState(SMC) != kSMC_PowerStateVlpr) {
+        }
+    } else {
+        (void)SMC_SetPowerModeRun(SMC);
+        while (SMC_GetPowerModeState(SMC) != kSMC_PowerStateRun) {
+        }
+    }
+}
+
+// Switch to target and bring every clock-derived divider back in line
+static void clock_mode_apply(clock_mode_t target) {
+    const clock_mode_config_t *config = &clock_mode_configs[target];
+    clock_mode_t from = current_mode;
+
+    clock_mode_drain_console();
+    uint32_t primask = DisableGlobalIRQ();
+    uint32_t start = cycle_counter_now();
+    (void)cycle_counter_us();  // Time so far at the old clock
+    timer_service_clock_changing();
+
+    CLOCK_SetSimSafeDivs();
+    if (CLOCK_GetMode() == kMCG_ModePEE) {
+        clock_mode_bypass_pll();  // The VCO divider can only change while bypassed
+    }
+    // HSRUN and VLPR are only reachable from RUN, never from each other
+    if (SMC_GetPowerModeState(SMC) != kSMC_PowerStateRun) {
+        clock_mode_set_power_mode(CLOCK_MODE_RUN);
+    }
+    if (target == CLOCK_MODE_HSRUN) {
+        clock_mode_set_power_mode(CLOCK_MODE_HSRUN);  // Before the clocks go above RUN limits
+    }
+    if (config->mcg->mcgMode == kMCG_ModePEE && CLOCK_GetMode() == kMCG_ModePBE) {
+        // CLOCK_SetMcgConfig takes PBE -> PEE as-is and would keep the old VCO divider
+        (void)CLOCK_SetPbeMode(config->mcg->pllcs, &config->mcg->pll0Config);
+    }
+    (void)CLOCK_SetMcgConfig(config->mcg);
+    CLOCK_SetSimConfig(config->sim);
+    if (target == CLOCK_MODE_VLPR) {
+        clock_mode_set_power_mode(CLOCK_MODE_VLPR);  // After the clocks are within VLPR limits
+    }
+    SystemCoreClock = CLOCK_GetCoreSysClkFreq();
+    (void)cycle_counter_us();  // The switch itself at the new one
+
+    // UART0 runs from the core clock and the PIT from the bus clock
+    (void)UART_SetBaudRate((UART_Type *)BOARD_DEBUG_UART_BASEADDR, BOARD_DEBUG_UART_BAUDRATE,
+                           BOARD_DEBUG_UART_CLK_FREQ);
+    timer_service_clock_changed();
+    for (uint32_t i = 0; i < listener_count; i++) {
+        listeners[i]();
+    }
+    current_mode = target;
+
+    uint32_t cycles = cycle_counter_now() - start;
+    EnableGlobalIRQ(primask);
+
+    clock_switch_stats_t *stats = &switch_stats[from][target];
+    stats->count++;
+    stats->last = cycles;
+    if (cycles > stats->max) {
+        stats->max = cycles;
+    }
+}
+
+// Downshift hold expired - the main loop applies it in clock_mode_update()
+static void downshift_timer_callback(sw_timer_t *timer, void *arg) {
+    downshift_due = true;
+}
+
+void clock_mode_init(void) {
+    SMC_SetPowerModeProtection(SMC, kSMC_AllowPowerModeAll);
+
+    // Requests made during boot (codec power-up still on I2C) hold the boot
+    // clock; reapplying the same mode would bypass the PLL under them
+    clock_mode_t target = clock_mode_target();
+    if (target != current_mode) {
+        clock_mode_apply(target);
+    }
+}
+
+void clock_mode_request(clock_client_t client, clock_mode_t mode) {
+    client_modes[client] = mode;
+    clock_mode_t target = clock_mode_target();
+
+    if (target > current_mode) {
+        timer_service_stop(&downshift_timer);
+        downshift_due = false;
+        clock_mode_apply(target);
+    } else if (target < current_mode) {
+        timer_service_start(&downshift_timer, CLOCK_MODE_DOWNSHIFT_MS, 0U, downshift_timer_callback, NULL);
+    }
+}
+
+void clock_mode_update(void) {
+    if (!downshift_due) {
+        return;
+    }
+    downshift_due = false;
+    clock_mode_t target = clock_mode_target();
+    if (target < current_mode) {
+        clock_mode_apply(target);
+    }
+}
+
+bool clock_mode_add_listener(clock_mode_listener_t listener) {
+    if (listener_count >= CLOCK_MODE_MAX_LISTENERS) {
+        return false;
+    }
+    listeners[listener_count++] = listener;
+    return true;
+}
+
+clock_mode_t clock_mode_current(void) {
+    return current_mode;
+}
+
+void clock_mode_stop_prepare(void) {
+    if (current_mode == CLOCK_MODE_HSRUN) {
+        clock_mode_drain_console();
+        clock_mode_bypass_pll();
+        clock_mode_set_power_mode(CLOCK_MODE_RUN);
+    }
+}
+
+void clock_mode_stop_resume(void) {
+    if (current_mode == CLOCK_MODE_HSRUN) {
+        clock_mode_set_power_mode(CLOCK_MODE_HSRUN);
+    }
+    // The PLL was stopped with the system clocks; it restarts on wake but must relock
+    if (CLOCK_GetMode() == kMCG_ModePBE) {
+        while ((CLOCK_GetStatusFlags() & (uint32_t)kMCG_Pll0LockFlag) == 0U) {
+        }
+        (void)CLOCK_SetPeeMode();
+    }
+}
+
+void clock_mode_dump(void) {
+    PRINTF("[CLOCK] Mode %s, core %lu Hz, bus %lu Hz\r\n", clock_mode_names[current_mode],
+           CLOCK_GetFreq(kCLOCK_CoreSysClk), CLOCK_GetFreq(kCLOCK_BusClk));
+    for (uint32_t i = 0; i < CLOCK_CLIENT_COUNT; i++) {
+        PRINTF("[CLOCK] Client %-7s wants %s\r\n", clock_client_names[i], clock_mode_names[client_modes[i]]);
+    }
+    for (uint32_t from = 0; from < CLOCK_MODE_COUNT; from++) {
+        for (uint32_t to = 0; to < CLOCK_MODE_COUNT; to++) {
+            const clock_switch_stats_t *stats = &switch_stats[from][to];
+            if (stats->count == 0U) {
+                continue;
+            }
+            PRINTF("[CLOCK] %-5s -> %-5s count=%lu last=%lu max=%lu cycles\r\n", clock_mode_names[from],
+                   clock_mode_names[to], stats->count, stats->last, stats->max);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * SEH500 Project - Clock mode manager
+ *
+ * Moves the chip between the three run modes on demand:
+ *
+ *   VLPR  4 MHz core/bus (fast IRC)  - idle, LED blinking, console
+ *   RUN   120 MHz core, 60 MHz bus   - moderate work
+ *   HSRUN 180 MHz core, 60 MHz bus   - audio decoding, SD card I/O
+ *
+ * Each client states the slowest mode it can live with; the manager runs
+ * at the fastest mode any client asked for. Going up happens at once,
+ * going down waits CLOCK_MODE_DOWNSHIFT_MS so bursts of work do not
+ * bounce the PLL. Every switch rescales the PIT timer service, the debug
+ * UART baud divider and any registered listener, and its cost in core
+ * cycles is recorded.
+ */
+
+#ifndef CLOCK_MODE_H_
+#define CLOCK_MODE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Ordered slowest to fastest
+typedef enum {
+    CLOCK_MODE_VLPR = 0,
+    CLOCK_MODE_RUN,
+    CLOCK_MODE_HSRUN,
+    CLOCK_MODE_COUNT
+} clock_mode_t;
+
+// Clients that can hold the clock up
+typedef enum {
+    CLOCK_CLIENT_CONSOLE = 0,  // 'C' key full-speed hold
+    CLOCK_CLIENT_AUDIO,        // Decoding/streaming a clip
+    CLOCK_CLIENT_SD,           // SD card transfers
+    CLOCK_CLIENT_COUNT
+} clock_client_t;
+
+// Called after every switch with interrupts masked, once the new clocks
+// are running; peripherals that derive dividers from them reprogram here
+typedef void (*clock_mode_listener_t)(void);
+
+#define CLOCK_MODE_MAX_LISTENERS 4U
+
+// Delay before dropping to a slower mode once demand goes away
+#define CLOCK_MODE_DOWNSHIFT_MS 50U
+
+// Take over from BOARD_BootClockHSRUN (call after timer_service_init and the
+// debug console). Requests made before this are kept; with no demand yet,
+// this drops straight to VLPR.
+void clock_mode_init(void);
+
+// Set the slowest mode a client can run at (CLOCK_MODE_VLPR = no demand).
+// Main loop only; never from an interrupt handler.
+void clock_mode_request(clock_client_t client, clock_mode_t mode);
+
+// Apply a pending downshift (call from the main loop before idling)
+void clock_mode_update(void);
+
+// Register a divider-recompute hook (returns false when the table is full)
+bool clock_mode_add_listener(clock_mode_listener_t listener);
+
+// Mode the chip is running in now
+clock_mode_t clock_mode_current(void);
+
+// Stop modes cannot be entered from HSRUN. Called by the idle governor with
+// interrupts masked around LLS: prepare drops to RUN with the PLL
+// bypassed if needed, resume restores the current mode's clocks.
+void clock_mode_stop_prepare(void);
+void clock_mode_stop_resume(void);
+
+// Print switch counts and cost (core cycles) on the debug console
+void clock_mode_dump(void);
+
+#endif /* CLOCK_MODE_H_ */
@@ -0,0 +1,62 @@
+/*
+ * SEH500 Project - Cycle counter helpers
+ * See cycle_counter.h
+ */
+
+#include "cycle_counter.h"
+#include "fsl_common.h"
+
+// Cycle count and core clock at the last cycle_counter_us() call, and the
+// microseconds up to it (starts at CYCCNT = 0, where cycle_counter_init leaves it)
+static uint32_t us_last_cycles = 0;
+static uint32_t us_last_hz = 0;     // 0 until the first call: use the clock of the moment
+static uint64_t us_elapsed = 0;
+static uint32_t us_remainder = 0;   // Fraction of a microsecond carried, in cycles x 10^6
+
+// The last core clock change seen by cycle_counter_us(): cycle count and
+// running time where the new clock took over, and the clock before it
+static uint32_t switch_cycles = 0;
+static uint64_t switch_elapsed_us = 0;
+static uint32_t switch_old_hz = 0;   // 0 until the first switch
+
+uint32_t cycle_counter_us(void) {
+    uint32_t primask = DisableGlobalIRQ();
+    uint32_t now = cycle_counter_now();
+    uint32_t hz = (us_last_hz != 0U) ? us_last_hz : SystemCoreClock;
+    // Carry the remainder so frequent callers (every trace record) do not lose time
+    uint64_t scaled = ((uint64_t)(now - us_last_cycles) * 1000000U) + us_remainder;
+    us_elapsed += scaled / hz;
+    us_remainder = (uint32_t)(scaled % hz);
+    if (SystemCoreClock != hz) {
+        switch_cycles = now;
+        switch_elapsed_us = us_elapsed;
+        switch_old_hz = hz;
+        us_remainder = 0;  // In units of the old clock
+    }
+    us_last_cycles = now;
+    us_last_hz = SystemCoreClock;
+    uint32_t us = (uint32_t)us_elapsed;
+    EnableGlobalIRQ(primask);
+    return us;
+}
+
+uint32_t cycle_counter_ns_since(uint32_t start) {
+    uint32_t primask = DisableGlobalIRQ();
+    (void)cycle_counter_us();  // Picks up a switch not seen yet
+    uint32_t now = cycle_counter_now();
+    uint32_t hz = SystemCoreClock;
+    uint32_t total = now - start;
+    uint64_t ns = ((uint64_t)total * 1000000000U) / hz;
+
+    // A switch less than 2^32 cycles back (so switch_cycles has not been
+    // lapped) that falls inside the interval splits it in two
+    if (switch_old_hz != 0U && ((us_elapsed - switch_elapsed_us) * hz) / 1000000U < UINT32_MAX) {
+        uint32_t since_switch = now - switch_cycles;
+        if (total > since_switch) {
+            ns = ((uint64_t)since_switch * 1000000000U) / hz +
+                 ((uint64_t)(total - since_switch) * 1000000000U) / switch_old_hz;
+        }
+    }
+    EnableGlobalIRQ(primask);
+    return (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t)ns;
+}
@@ -0,0 +1,40 @@
+/*
+ * SEH500 Project - Cycle counter helpers
+ * Thin wrapper around the Cortex-M4 DWT cycle counter (DWT->CYCCNT)
+ * Used to timestamp events from interrupt handlers
+ */
+
+#ifndef CYCLE_COUNTER_H_
+#define CYCLE_COUNTER_H_
+
+#include <stdint.h>
+#include "fsl_device_registers.h"
+
+// Enable the DWT cycle counter (call once at boot, after clocks are set up)
+static inline void cycle_counter_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;  // Enable trace/debug blocks (DWT)
+    DWT->CYCCNT = 0U;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;             // Start counting core clock cycles
+}
+
+// Read the current cycle count (wraps every 2^32 cycles, ~23.8s at 180MHz)
+static inline uint32_t cycle_counter_now(void) {
+    return DWT->CYCCNT;
+}
+
+// Microseconds of running core time since cycle_counter_init(). Cycles
+// since the previous call are converted at the core clock then in force,
+// so clock_mode calls this on both sides of every switch and intervals
+// that span one stay in real time. The counter stops while the core
+// sleeps, and calls must come less than 2^32 cycles apart. Safe from
+// interrupt handlers.
+uint32_t cycle_counter_us(void);
+
+// Nanoseconds of running core time from start (a cycle_counter_now() value)
+// to now, for intervals shorter than 2^32 cycles. The cycles before the
+// last clock switch are converted at the clock they ran at, so the result
+// is exact unless two switches fall inside the interval. Saturates at
+// UINT32_MAX. Safe from interrupt handlers.
+uint32_t cycle_counter_ns_since(uint32_t start);
+
+#endif /* CYCLE_COUNTER_H_ */
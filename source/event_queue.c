@@ -0,0 +1,78 @@
+/*
+ * SEH500 Project - Deferred event queue
+ *
+ * ISRs only record what happened (source, timestamp, payload) and return.
+ * The main loop drains the ring and runs the state machine and all PRINTFs.
+ *
+ * Single producer: PORTA, PORTD, UART0, PIT0 (timer callbacks), DMA0
+ * (audio buffers), LLWU (button wake from LLS) and SDHC (background card
+ * transfers, sd_async.c) all run at the same NVIC priority, 0, so they can
+ * never preempt each other and behave as one producer context. A new
+ * producer must keep that priority (sd_storage.c sets SDHC's explicitly).
+ * Single consumer: only main() pops events.
+ * head is written only by the producer and tail only by the consumer,
+ * so no interrupt masking is needed on either side.
+ */
+
+#include "event_queue.h"
+#include "cycle_counter.h"
+#include "fsl_common.h"
+
+#define EVENT_QUEUE_MASK (EVENT_QUEUE_SIZE - 1U)
+
+#if (EVENT_QUEUE_SIZE & EVENT_QUEUE_MASK) != 0U
+#error "EVENT_QUEUE_SIZE must be a power of two"
+#endif
+
+static app_event_t event_ring[EVENT_QUEUE_SIZE];
+static volatile uint32_t event_head = 0;  // Next slot to write (producer)
+static volatile uint32_t event_tail = 0;  // Next slot to read (consumer)
+static volatile uint32_t event_drops = 0;
+
+void event_queue_init(void) {
+    event_head = 0;
+    event_tail = 0;
+    event_drops = 0;
+}
+
+bool event_queue_post(event_source_t source, uint8_t payload) {
+    uint32_t head = event_head;
+
+    // Indices are free-running, so head - tail is the fill level even across wrap
+    if ((head - event_tail) >= EVENT_QUEUE_SIZE) {
+        event_drops++;
+        return false;
+    }
+
+    app_event_t *slot = &event_ring[head & EVENT_QUEUE_MASK];
+    slot->timestamp = cycle_counter_now();
+    slot->source = (uint8_t)source;
+    slot->payload = payload;
+    slot->reserved = 0;
+
+    __DMB();  // Record must be visible before the consumer sees the new head
+    event_head = head + 1U;
+    return true;
+}
+
+bool event_queue_pop(app_event_t *event) {
+    uint32_t tail = event_tail;
+
+    if (tail == event_head) {
+        return false;
+    }
+
+    __DMB();  // Read the record only after observing the producer's head
+    *event = event_ring[tail & EVENT_QUEUE_MASK];
+    __DMB();  // Finish reading before handing the slot back to the producer
+    event_tail = tail + 1U;
+    return true;
+}
+
+bool event_queue_is_empty(void) {
+    return event_tail == event_head;
+}
+
+uint32_t event_queue_dropped(void) {
+    return event_drops;
+}
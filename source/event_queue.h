@@ -0,0 +1,48 @@
+/*
+ * SEH500 Project - Deferred event queue
+ * Single-producer/single-consumer lock-free ring between ISRs and main loop
+ */
+
+#ifndef EVENT_QUEUE_H_
+#define EVENT_QUEUE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Number of slots in the ring (must be a power of two)
+#define EVENT_QUEUE_SIZE 32U
+
+// Where an event came from
+typedef enum {
+    EVENT_SOURCE_BUTTON = 0,  // Button falling edge, payload = ALERT_BUTTON(port, pin)
+    EVENT_SOURCE_UART_RX,     // Keyboard character received on UART0
+    EVENT_SOURCE_AUDIO,       // Audio player, payload = audio_event_t
+    EVENT_SOURCE_STORAGE      // SD card transfer from sd_async.c finished
+} event_source_t;
+
+// Compact event record posted by an ISR (8 bytes)
+typedef struct {
+    uint32_t timestamp;  // DWT cycle count when the ISR ran
+    uint8_t source;      // event_source_t
+    uint8_t payload;     // Source specific data (e.g. received character)
+    uint16_t reserved;
+} app_event_t;
+
+// Reset the ring (call before enabling any producer interrupt)
+void event_queue_init(void);
+
+// Producer side - call from interrupt context only
+// Returns false (and counts a drop) if the ring is full
+bool event_queue_post(event_source_t source, uint8_t payload);
+
+// Consumer side - call from the main loop only
+// Returns false if no event is pending
+bool event_queue_pop(app_event_t *event);
+
+// True if no event is waiting for the main loop
+bool event_queue_is_empty(void);
+
+// Number of events dropped because the ring was full
+uint32_t event_queue_dropped(void);
+
+#endif /* EVENT_QUEUE_H_ */
@@ -10,7 +10,11 @@
 /*---------------------------------------------------------------------------/
 / MSDK adaptation configuration
 /---------------------------------------------------------------------------*/
-//#define RAM_DISK_ENABLE
+/* Opt-in (-DSD_SEEK_BENCH): 64 KB of RAM for drive "0:", which sd_storage_dump()
+/  reformats on every 'S' to time seeks with and without a link map */
+#if defined(SD_SEEK_BENCH)
+#define RAM_DISK_ENABLE
+#endif
 #define SD_DISK_ENABLE
 //#define USB_DISK_ENABLE
 //#define MMC_DISK_ENABLE
@@ -54,7 +58,7 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
-#define FF_USE_FASTSEEK	0
+#define FF_USE_FASTSEEK	1
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
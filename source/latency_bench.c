@@ -0,0 +1,154 @@
+/*
+ * SEH500 Project - Button-to-sound latency benchmark
+ * See latency_bench.h
+ */
+
+#include <stdlib.h>
+#include "latency_bench.h"
+#include "fsl_common.h"
+#include "fsl_debug_console.h"
+#include "cycle_counter.h"
+#include "event_queue.h"
+#include "timer_service.h"
+#include "audio_player.h"
+
+#define LATENCY_BENCH_STARTS ((LATENCY_BENCH_TRIGGERS + 1U) / 2U)
+
+// Measured intervals, all from the PIT0 interrupt that posts the synthetic press
+typedef enum {
+    BENCH_TO_STATE = 0,
+    BENCH_TO_DMA,
+    BENCH_TO_SOUND,
+    BENCH_INTERVAL_COUNT
+} bench_interval_t;
+
+static const char *const bench_interval_names[BENCH_INTERVAL_COUNT] = {
+    [BENCH_TO_STATE] = "IRQ -> state",
+    [BENCH_TO_DMA]   = "IRQ -> DMA read",
+    [BENCH_TO_SOUND] = "IRQ -> sound",
+};
+
+static sw_timer_t bench_timer;
+static uint8_t bench_button;
+static volatile bool bench_running = false;
+static volatile uint32_t bench_triggers = 0;  // Presses posted this run
+static volatile bool bench_pending = false;   // A posted press not handled yet
+static volatile uint32_t bench_irq_us;
+static uint32_t bench_state_us;
+
+static uint32_t bench_samples[BENCH_INTERVAL_COUNT][LATENCY_BENCH_STARTS];
+static uint32_t bench_counts[BENCH_INTERVAL_COUNT];
+static uint32_t bench_starts;   // Presses that started a clip
+static uint32_t bench_warm;     // ... on a stream already running (no DMA/sound times)
+static uint32_t bench_failed;   // Presses whose clip did not start
+
+// PIT0 interrupt: stands in for PORTD_IRQHandler
+static void bench_timer_callback(sw_timer_t *timer, void *arg) {
+    if (bench_triggers >= LATENCY_BENCH_TRIGGERS) {
+        timer_service_stop(timer);
+        return;
+    }
+    bench_triggers++;
+    bench_irq_us = cycle_counter_us();
+    bench_pending = event_queue_post(EVENT_SOURCE_BUTTON, bench_button);
+}
+
+static void bench_record(bench_interval_t interval, uint32_t us) {
+    if (bench_counts[interval] < LATENCY_BENCH_STARTS) {
+        bench_samples[interval][bench_counts[interval]++] = us - bench_irq_us;
+    }
+}
+
+static void bench_finish(void) {
+    timer_service_stop(&bench_timer);
+    audio_player_arm_probe(false);
+    bench_running = false;
+    bench_pending = false;
+    latency_bench_dump();
+}
+
+void latency_bench_toggle(uint8_t button) {
+    if (bench_running) {
+        bench_finish();
+        return;
+    }
+    for (uint32_t i = 0; i < BENCH_INTERVAL_COUNT; i++) {
+        bench_counts[i] = 0U;
+    }
+    bench_starts = 0U;
+    bench_warm = 0U;
+    bench_failed = 0U;
+    bench_button = button;
+    bench_triggers = 0U;
+    bench_pending = false;
+    bench_running = true;
+    audio_player_arm_probe(true);
+    PRINTF("[BENCH] %u synthetic presses, %u ms apart ('K' again to stop early)\r\n", LATENCY_BENCH_TRIGGERS,
+           LATENCY_BENCH_PERIOD_MS);
+    timer_service_start(&bench_timer, LATENCY_BENCH_PERIOD_MS, LATENCY_BENCH_PERIOD_MS, bench_timer_callback, NULL);
+}
+
+void latency_bench_state(void) {
+    if (bench_pending) {
+        bench_state_us = cycle_counter_us();
+    }
+}
+
+void latency_bench_input(bool starting, bool started) {
+    if (!bench_pending) {
+        return;  // A real press or key during the run
+    }
+    bench_pending = false;
+
+    audio_start_probe_t probe;
+    bool fresh = audio_player_take_probe(&probe);
+    if (started) {
+        bench_starts++;
+        bench_record(BENCH_TO_STATE, bench_state_us);
+        if (!fresh) {
+            bench_warm++;
+        } else {
+            if (probe.dma_us != 0U) {
+                bench_record(BENCH_TO_DMA, probe.dma_us);
+            }
+            if (probe.sound_us != 0U) {
+                bench_record(BENCH_TO_SOUND, probe.sound_us);
+            }
+        }
+    } else if (starting) {
+        bench_failed++;
+    }
+    if (bench_triggers >= LATENCY_BENCH_TRIGGERS) {
+        bench_finish();
+    }
+}
+
+static int bench_compare(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted run
+static uint32_t bench_percentile(const uint32_t *sorted, uint32_t n, uint32_t percent) {
+    uint32_t rank = (percent * n + 99U) / 100U;
+    return sorted[(rank == 0U) ? 0U : rank - 1U];
+}
+
+void latency_bench_dump(void) {
+    PRINTF("[BENCH] %s: %lu presses, %lu starts (%lu on a running stream), %lu failed\r\n",
+           bench_running ? "Running" : "Last run", bench_triggers, bench_starts, bench_warm, bench_failed);
+    PRINTF("[BENCH] Times from the PIT0 interrupt that posts each press (no PORTD edge latency)\r\n");
+    for (uint32_t i = 0; i < BENCH_INTERVAL_COUNT; i++) {
+        uint32_t n = bench_counts[i];
+        if (n == 0U) {
+            PRINTF("[BENCH] %-14s no samples\r\n", bench_interval_names[i]);
+            continue;
+        }
+        qsort(bench_samples[i], n, sizeof(bench_samples[i][0]), bench_compare);
+        PRINTF("[BENCH] %-14s n=%lu min=%lu p50=%lu p90=%lu p99=%lu max=%lu us\r\n", bench_interval_names[i], n,
+               bench_samples[i][0], bench_percentile(bench_samples[i], n, 50U),
+               bench_percentile(bench_samples[i], n, 90U), bench_percentile(bench_samples[i], n, 99U),
+               bench_samples[i][n - 1U]);
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ * SEH500 Project - Button-to-sound latency benchmark
+ *
+ * Fires synthetic SW2 presses from a software timer. The callback runs in
+ * the PIT0 interrupt, stamps the time and posts the same event the PORTD
+ * handler would, so each press takes the real path: event queue, alert
+ * state machine, LED, clip open, codec and SAI setup, first buffer.
+ * Presses alternate start/cancel LATENCY_BENCH_PERIOD_MS apart, past the
+ * debounce lock and the stream draining, so every start is a cold one.
+ *
+ * Each start is timed from the PIT0 interrupt to the state change, to the
+ * eDMA's first read from the first buffer (its SADDR moving) and to the
+ * first non-zero sample leaving the SAI FIFO (audio_player_arm_probe); the
+ * pin-to-PORTD-handler time a real press adds is not included. The report
+ * gives percentiles of each. Times come from cycle_counter_us(), so they
+ * stay real across the VLPR -> HSRUN switch a start makes. The core wakes
+ * from WAIT for the timer; the longer wake-up from LLS that a real press
+ * can see is in the 'P' report.
+ */
+
+#ifndef LATENCY_BENCH_H_
+#define LATENCY_BENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LATENCY_BENCH_TRIGGERS  2000U  // Presses per run, half of them starts
+#define LATENCY_BENCH_PERIOD_MS 200U
+
+// Start a run pressing button (ALERT_BUTTON id), or end the one in
+// progress early and report it
+void latency_bench_toggle(uint8_t button);
+
+// Alert state machine: the press being handled has changed state
+void latency_bench_state(void);
+
+// The press being handled is done: starting = it asked for a clip,
+// started = the clip began playing
+void latency_bench_input(bool starting, bool started);
+
+// Print percentiles of the last run
+void latency_bench_dump(void);
+
+#endif /* LATENCY_BENCH_H_ */
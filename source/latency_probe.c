@@ -0,0 +1,95 @@
+/*
+ * SEH500 Project - Latency instrumentation
+ * See latency_probe.h
+ */
+
+#include "latency_probe.h"
+
+#if LATENCY_PROBE_ENABLE
+
+#include "fsl_common.h"
+#include "fsl_debug_console.h"
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t histogram[LATENCY_HISTOGRAM_BUCKETS];
+} latency_stats_t;
+
+static const char *const latency_path_names[LATENCY_PATH_COUNT] = {
+    [LATENCY_BUTTON_TO_STATE] = "button -> state",
+    [LATENCY_BUTTON_TO_LED]   = "button -> LED",
+    [LATENCY_KEY_TO_STATE]    = "key -> state",
+    [LATENCY_KEY_TO_LED]      = "key -> LED",
+};
+
+static latency_stats_t latency_stats[LATENCY_PATH_COUNT];
+
+void latency_probe_record(latency_path_t path, uint32_t start) {
+    uint32_t ns = cycle_counter_ns_since(start);
+    latency_stats_t *stats = &latency_stats[path];
+
+    // log2 bucket: 0 for 0 ns, n for [2^(n-1), 2^n)
+    uint32_t bucket = 32U - __CLZ(ns);
+    if (bucket >= LATENCY_HISTOGRAM_BUCKETS) {
+        bucket = LATENCY_HISTOGRAM_BUCKETS - 1U;
+    }
+
+    uint32_t primask = DisableGlobalIRQ();
+    if (stats->count == 0U || ns < stats->min) {
+        stats->min = ns;
+    }
+    if (ns > stats->max) {
+        stats->max = ns;
+    }
+    stats->count++;
+    stats->sum += ns;
+    stats->histogram[bucket]++;
+    EnableGlobalIRQ(primask);
+}
+
+void latency_probe_reset(void) {
+    uint32_t primask = DisableGlobalIRQ();
+    for (uint32_t path = 0; path < LATENCY_PATH_COUNT; path++) {
+        latency_stats_t *stats = &latency_stats[path];
+        stats->count = 0;
+        stats->min = 0;
+        stats->max = 0;
+        stats->sum = 0;
+        for (uint32_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+            stats->histogram[i] = 0;
+        }
+    }
+    EnableGlobalIRQ(primask);
+}
+
+void latency_probe_dump(void) {
+    for (uint32_t path = 0; path < LATENCY_PATH_COUNT; path++) {
+        latency_stats_t stats;
+        uint32_t primask = DisableGlobalIRQ();
+        stats = latency_stats[path];  // Consistent snapshot
+        EnableGlobalIRQ(primask);
+
+        if (stats.count == 0U) {
+            PRINTF("[LATENCY] %-16s no samples\r\n", latency_path_names[path]);
+            continue;
+        }
+        uint32_t mean = (uint32_t)(stats.sum / stats.count);
+        PRINTF("[LATENCY] %-16s n=%lu min=%lu max=%lu mean=%lu ns (mean %lu us)\r\n",
+               latency_path_names[path], stats.count, stats.min, stats.max, mean, mean / 1000U);
+        for (uint32_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+            if (stats.histogram[i] == 0U) {
+                continue;
+            }
+            if (i == (LATENCY_HISTOGRAM_BUCKETS - 1U)) {
+                PRINTF("[LATENCY]    >= %10lu ns: %lu\r\n", 1UL << (i - 1U), stats.histogram[i]);
+            } else {
+                PRINTF("[LATENCY]     < %10lu ns: %lu\r\n", 1UL << i, stats.histogram[i]);
+            }
+        }
+    }
+}
+
+#endif /* LATENCY_PROBE_ENABLE */
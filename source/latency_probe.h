@@ -0,0 +1,65 @@
+/*
+ * SEH500 Project - Latency instrumentation
+ *
+ * Measures input-to-output latency with the DWT cycle counter. The start
+ * time is the timestamp the ISR stored in the event record; the probe
+ * points are the state transition and the LED write in the main loop.
+ * Each sample is converted to nanoseconds when it is recorded, at the core
+ * clock the cycles ran at (cycle_counter_ns_since()), so samples taken in
+ * VLPR, RUN and HSRUN - or across a switch - add up. Each path keeps
+ * count/min/max/mean and a log2 histogram of nanoseconds.
+ *
+ * Set LATENCY_PROBE_ENABLE to 0 (default for non-DEBUG builds) and every
+ * LATENCY_* macro compiles to nothing - no code, no RAM.
+ */
+
+#ifndef LATENCY_PROBE_H_
+#define LATENCY_PROBE_H_
+
+#include <stdint.h>
+
+#ifndef LATENCY_PROBE_ENABLE
+#if defined(DEBUG)
+#define LATENCY_PROBE_ENABLE 1
+#else
+#define LATENCY_PROBE_ENABLE 0
+#endif
+#endif
+
+// Measured paths (start = ISR timestamp)
+typedef enum {
+    LATENCY_BUTTON_TO_STATE = 0,  // Button edge -> state machine transition
+    LATENCY_BUTTON_TO_LED,        // Button edge -> LED register written
+    LATENCY_KEY_TO_STATE,         // UART RX -> state machine transition
+    LATENCY_KEY_TO_LED,           // UART RX -> LED register written
+    LATENCY_PATH_COUNT
+} latency_path_t;
+
+#define LATENCY_HISTOGRAM_BUCKETS 28U  // Bucket n holds [2^(n-1), 2^n) ns, last is open-ended
+
+#if LATENCY_PROBE_ENABLE
+
+#include "cycle_counter.h"
+
+// Record the time from `start` (a cycle_counter_now() value) to now on `path`
+void latency_probe_record(latency_path_t path, uint32_t start);
+
+// Print every path's statistics and histogram on the debug console
+void latency_probe_dump(void);
+
+// Clear all statistics
+void latency_probe_reset(void);
+
+#define LATENCY_RECORD(path, start) latency_probe_record((path), (start))
+#define LATENCY_DUMP()              latency_probe_dump()
+#define LATENCY_RESET()             latency_probe_reset()
+
+#else
+
+#define LATENCY_RECORD(path, start) ((void)0)
+#define LATENCY_DUMP()              ((void)0)
+#define LATENCY_RESET()             ((void)0)
+
+#endif /* LATENCY_PROBE_ENABLE */
+
+#endif /* LATENCY_PROBE_H_ */
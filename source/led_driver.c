@@ -0,0 +1,186 @@
+/*
+ * SEH500 Project - LED pattern driver
+ * See led_driver.h
+ */
+
+#include <string.h>
+#include "led_driver.h"
+#include "fsl_common.h"
+#include "fsl_clock.h"
+#include "fsl_gpio.h"
+#include "fsl_pit.h"
+#include "fsl_dmamux.h"
+#include "fsl_edma.h"
+#include "clock_mode.h"
+#include "power_governor.h"
+#include "led_pwm.h"
+
+// gpio_led.s: clocks PORTC/PORTE and makes PTE6/PTC9 outputs, LEDs off
+void setup_leds(void);
+
+typedef struct {
+    GPIO_Type *gpio;
+    uint32_t pin;             // Active-low
+    dma_request_source_t slot;
+} led_output_t;
+
+static const led_output_t led_outputs[LED_COUNT] = {
+    [LED_GREEN] = {GPIOE, 6U, kDmaRequestMux0AlwaysOn62},
+    [LED_RED]   = {GPIOC, 9U, kDmaRequestMux0AlwaysOn63},
+};
+
+// '#' = on, '.' = off, LED_STEP_MS per character
+static const char *const led_patterns[LED_PATTERN_COUNT] = {
+    [LED_PATTERN_OFF]          = ".",
+    [LED_PATTERN_SOLID]        = "#",
+    [LED_PATTERN_BLINK]        = "##########..........",
+    [LED_PATTERN_DOUBLE_BLINK] = "###...###...........",
+    [LED_PATTERN_HEARTBEAT]    = "##..####................",
+    // ... --- ... with dot = 100 ms, dash = 300 ms
+    [LED_PATTERN_SOS]          = "##..##..##......"
+                                 "######..######..######......"
+                                 "##..##..##..............",
+    [LED_PATTERN_BREATHE]      = NULL,  // PWM backend
+};
+
+// PTOR masks read by the DMA; one table per LED so both can run at once
+static uint32_t led_toggles[LED_COUNT][LED_MAX_STEPS];
+// What is driving each LED right now
+typedef enum {
+    LED_IDLE = 0,   // Static level written by the CPU
+    LED_GPIO_DMA,   // PIT-paced toggles to PTOR
+    LED_PWM,        // FTM3 breathing
+} led_backend_t;
+
+static led_backend_t led_backend[LED_COUNT];
+
+static void led_write(const led_output_t *out, bool on) {
+    if (on) {
+        GPIO_PortClear(out->gpio, 1UL << out->pin);  // PCOR, no read-modify-write
+    } else {
+        GPIO_PortSet(out->gpio, 1UL << out->pin);    // PSOR
+    }
+}
+
+static uint32_t led_step_counts(void) {
+    return (uint32_t)USEC_TO_COUNT(LED_STEP_MS * 1000U, CLOCK_GetFreq(kCLOCK_BusClk));
+}
+
+static void led_halt(led_id_t led) {
+    uint32_t channel = LED_DMA_CHANNEL(led);
+    led_pwm_stop(led);
+    PIT_StopTimer(PIT, (pit_chnl_t)channel);
+    EDMA_DisableChannelRequest(DMA0, channel);
+    DMAMUX_DisableChannel(DMAMUX, channel);
+    DMAMUX_DisablePeriodTrigger(DMAMUX, channel);
+    led_backend[led] = LED_IDLE;
+}
+
+static void led_update_bus_clock_hold(void) {
+    bool any = false;
+    for (uint32_t i = 0; i < LED_COUNT; i++) {
+        any = any || (led_backend[i] != LED_IDLE);
+    }
+    power_governor_keep_bus_clock(POWER_BUS_USER_LED, any);
+}
+
+// Bus clock changed: reload every running step timer and the PWM period
+static void led_clock_changed(void) {
+    uint32_t counts = led_step_counts();
+    for (uint32_t i = 0; i < LED_COUNT; i++) {
+        if (led_backend[i] == LED_GPIO_DMA) {
+            pit_chnl_t channel = (pit_chnl_t)LED_DMA_CHANNEL(i);
+            PIT_StopTimer(PIT, channel);
+            PIT_SetTimerPeriod(PIT, channel, counts);
+            PIT_StartTimer(PIT, channel);
+        }
+    }
+    led_pwm_clock_changed();
+}
+
+void led_driver_init(void) {
+    edma_config_t edmaConfig;
+
+    setup_leds();
+    DMAMUX_Init(DMAMUX);
+    EDMA_GetDefaultConfig(&edmaConfig);
+    EDMA_Init(DMA0, &edmaConfig);
+    led_pwm_init();
+    for (uint32_t i = 0; i < LED_COUNT; i++) {
+        led_halt((led_id_t)i);
+        led_write(&led_outputs[i], false);
+    }
+    (void)clock_mode_add_listener(led_clock_changed);
+}
+
+void led_driver_play(led_id_t led, led_pattern_t pattern) {
+    if (pattern == LED_PATTERN_BREATHE) {
+        led_driver_breathe(led, LED_BREATHE_PERIOD_MS);
+        return;
+    }
+
+    const led_output_t *out = &led_outputs[led];
+    const char *steps = led_patterns[pattern];
+    uint32_t count = (uint32_t)strlen(steps);
+    uint32_t channel = LED_DMA_CHANNEL(led);
+    uint32_t *toggles = led_toggles[led];
+    bool any_edge = false;
+
+    if (count > LED_MAX_STEPS) {
+        count = LED_MAX_STEPS;
+    }
+
+    uint32_t primask = DisableGlobalIRQ();
+    led_halt(led);
+
+    // Entry k flips the pin from step k to step k+1, so the table wraps cleanly
+    for (uint32_t k = 0; k < count; k++) {
+        bool edge = (steps[k] != steps[(k + 1U) % count]);
+        toggles[k] = edge ? (1UL << out->pin) : 0U;
+        any_edge = any_edge || edge;
+    }
+    led_write(out, steps[0] == '#');
+
+    if (any_edge) {
+        edma_transfer_config_t transfer = {
+            .srcAddr = (uint32_t)toggles,
+            .destAddr = (uint32_t)&out->gpio->PTOR,
+            .srcTransferSize = kEDMA_TransferSize4Bytes,
+            .destTransferSize = kEDMA_TransferSize4Bytes,
+            .srcOffset = sizeof(uint32_t),
+            .destOffset = 0,
+            .minorLoopBytes = sizeof(uint32_t),
+            .majorLoopCounts = count,
+        };
+        EDMA_ResetChannel(DMA0, channel);
+        EDMA_SetTransferConfig(DMA0, channel, &transfer, NULL);
+        // Rewind to the first entry after the last one and keep the request enabled
+        EDMA_SetMajorOffsetConfig(DMA0, channel, -(int32_t)(count * sizeof(uint32_t)), 0);
+        DMA0->TCD[channel].CSR &= ~(uint16_t)DMA_CSR_DREQ_MASK;
+
+        DMAMUX_SetSource(DMAMUX, channel, (uint32_t)out->slot);
+        DMAMUX_EnablePeriodTrigger(DMAMUX, channel);
+        DMAMUX_EnableChannel(DMAMUX, channel);
+        EDMA_EnableChannelRequest(DMA0, channel);
+
+        PIT_SetTimerPeriod(PIT, (pit_chnl_t)channel, led_step_counts());
+        PIT_StartTimer(PIT, (pit_chnl_t)channel);
+        led_backend[led] = LED_GPIO_DMA;
+    }
+    led_update_bus_clock_hold();
+    EnableGlobalIRQ(primask);
+}
+
+void led_driver_breathe(led_id_t led, uint32_t period_ms) {
+    uint32_t primask = DisableGlobalIRQ();
+    led_halt(led);
+    led_write(&led_outputs[led], false);  // Pin level once the FTM lets go of it
+    led_pwm_breathe(led, period_ms);
+    led_backend[led] = LED_PWM;
+    led_update_bus_clock_hold();
+    EnableGlobalIRQ(primask);
+}
+
+void led_driver_stop(led_id_t led) {
+    led_driver_play(led, LED_PATTERN_OFF);
+}
@@ -0,0 +1,70 @@
+/*
+ * SEH500 Project - LED pattern driver
+ *
+ * Plays blink rhythms on the onboard LEDs with no CPU involvement. A
+ * pattern is a string of on ('#') and off ('.') steps of LED_STEP_MS each.
+ * At start it is turned into a table of GPIO PTOR toggle masks; a PIT
+ * channel then triggers an eDMA channel (DMAMUX periodic trigger on an
+ * always-on slot) once per step and the DMA writes the next mask to PTOR,
+ * wrapping around the table forever. SOS costs exactly what a plain blink
+ * costs: no interrupt, no read-modify-write, no software timer.
+ *
+ * Breathing needs brightness, so LED_PATTERN_BREATHE and
+ * led_driver_breathe() hand the pin to the FTM3 PWM backend (led_pwm.c)
+ * instead; callers see one interface either way.
+ *
+ * PIT channel 0 belongs to the timer service, so each LED takes the
+ * PIT/DMA channel pair given by its led_id_t + 1 (only channels 0-3 have
+ * periodic triggers). The PWM backend reuses the same DMA channel.
+ */
+
+#ifndef LED_DRIVER_H_
+#define LED_DRIVER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    LED_GREEN = 0,  // PTE6, PIT1/DMA1
+    LED_RED,        // PTC9, PIT2/DMA2
+    LED_COUNT
+} led_id_t;
+
+typedef enum {
+    LED_PATTERN_OFF = 0,
+    LED_PATTERN_SOLID,
+    LED_PATTERN_BLINK,         // 500 ms on / 500 ms off
+    LED_PATTERN_DOUBLE_BLINK,
+    LED_PATTERN_HEARTBEAT,
+    LED_PATTERN_SOS,
+    LED_PATTERN_BREATHE,       // PWM fade in/out, LED_BREATHE_PERIOD_MS per cycle
+    LED_PATTERN_COUNT
+} led_pattern_t;
+
+// Step length shared by every pattern
+#define LED_STEP_MS 50U
+
+// Longest pattern in steps
+#define LED_MAX_STEPS 96U
+
+// Breathing cycle used by LED_PATTERN_BREATHE
+#define LED_BREATHE_PERIOD_MS 1000U
+
+// PIT/eDMA/DMAMUX channel owned by an LED
+#define LED_DMA_CHANNEL(led) ((uint32_t)(led) + 1U)
+
+// Set up the LED pins, DMAMUX and eDMA (call after timer_service_init,
+// which owns PIT_Init, and before clock_mode_init)
+void led_driver_init(void);
+
+// Start a pattern from its first step; the first step is written to the
+// pin before this returns. LED_PATTERN_OFF stops the LED.
+void led_driver_play(led_id_t led, led_pattern_t pattern);
+
+// Breathe with any period (e.g. 1000 = 1 Hz), up to LED_PWM_MAX_FRAMES periods
+void led_driver_breathe(led_id_t led, uint32_t period_ms);
+
+// Stop the pattern and switch the LED off
+void led_driver_stop(led_id_t led);
+
+#endif /* LED_DRIVER_H_ */
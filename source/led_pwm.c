@@ -0,0 +1,165 @@
+/*
+ * SEH500 Project - LED PWM backend
+ * See led_pwm.h
+ */
+
+#include "led_pwm.h"
+#include "fsl_common.h"
+#include "fsl_clock.h"
+#include "fsl_port.h"
+#include "fsl_ftm.h"
+#include "fsl_dmamux.h"
+#include "fsl_edma.h"
+
+#define LED_PWM_FTM FTM3
+
+typedef struct {
+    PORT_Type *port;
+    uint32_t pin;
+    port_mux_t mux;           // Alternate function that routes the pin to FTM3
+    ftm_chnl_t channel;
+    dma_request_source_t request;
+} led_pwm_output_t;
+
+static const led_pwm_output_t pwm_outputs[LED_COUNT] = {
+    [LED_GREEN] = {PORTE, 6U, kPORT_MuxAlt6, kFTM_Chnl_1, kDmaRequestMux0FTM3Channel1},
+    [LED_RED]   = {PORTC, 9U, kPORT_MuxAlt3, kFTM_Chnl_5, kDmaRequestMux0FTM3Channel5},
+};
+
+// (i/32)^2.2 in Q16 - perceived brightness to duty cycle
+static const uint16_t led_gamma[33] = {
+        0,    32,   147,   359,   676,  1104,  1648,  2314,
+     3104,  4022,  5072,  6255,  7574,  9033, 10632, 12375,
+    14263, 16298, 18482, 20816, 23303, 25943, 28739, 31692,
+    34802, 38072, 41503, 45097, 48853, 52774, 56860, 61114,
+    65535,
+};
+
+static uint32_t pwm_frames[LED_COUNT][LED_PWM_MAX_FRAMES];  // CnV per period, read by the DMA
+static uint32_t pwm_frame_count[LED_COUNT];                 // 0 = not running
+static uint32_t pwm_period_ms[LED_COUNT];
+static uint32_t pwm_mod = 0;                                // FTM3 MOD for LED_PWM_FREQ_HZ
+
+static uint32_t led_pwm_source_clock(void) {
+    return CLOCK_GetFreq(kCLOCK_BusClk);
+}
+
+// Perceived brightness (Q16) -> duty (Q16), linear between gamma points
+static uint32_t led_pwm_gamma(uint32_t level) {
+    if (level > 0xFFFFU) {
+        level = 0xFFFFU;
+    }
+    uint32_t index = level >> 11;
+    uint32_t frac = level & 0x7FFU;
+    return led_gamma[index] + (((uint32_t)(led_gamma[index + 1U] - led_gamma[index]) * frac) >> 11);
+}
+
+// One breathing cycle: brightness ramps linearly up then down, duty follows the gamma curve.
+// CnV stays within 1..MOD so the channel matches, and requests DMA, every period.
+static void led_pwm_build(led_id_t led) {
+    uint32_t count = (pwm_period_ms[led] * LED_PWM_FREQ_HZ) / 1000U;
+    if (count < 2U) {
+        count = 2U;
+    } else if (count > LED_PWM_MAX_FRAMES) {
+        count = LED_PWM_MAX_FRAMES;
+    }
+    for (uint32_t f = 0; f < count; f++) {
+        uint32_t ramp = (uint32_t)(((uint64_t)f * 0x20000U) / count);  // 0..2.0 in Q16
+        uint32_t level = (ramp <= 0x10000U) ? ramp : (0x20000U - ramp);
+        pwm_frames[led][f] = 1U + ((led_pwm_gamma(level) * (pwm_mod - 1U)) >> 16);
+    }
+    pwm_frame_count[led] = count;
+}
+
+static void led_pwm_start_dma(led_id_t led) {
+    const led_pwm_output_t *out = &pwm_outputs[led];
+    uint32_t dma_channel = LED_DMA_CHANNEL(led);
+    uint32_t count = pwm_frame_count[led];
+    edma_transfer_config_t transfer = {
+        .srcAddr = (uint32_t)pwm_frames[led],
+        .destAddr = (uint32_t)&LED_PWM_FTM->CONTROLS[out->channel].CnV,
+        .srcTransferSize = kEDMA_TransferSize4Bytes,
+        .destTransferSize = kEDMA_TransferSize4Bytes,
+        .srcOffset = sizeof(uint32_t),
+        .destOffset = 0,
+        .minorLoopBytes = sizeof(uint32_t),
+        .majorLoopCounts = count,
+    };
+
+    EDMA_ResetChannel(DMA0, dma_channel);
+    EDMA_SetTransferConfig(DMA0, dma_channel, &transfer, NULL);
+    EDMA_SetMajorOffsetConfig(DMA0, dma_channel, -(int32_t)(count * sizeof(uint32_t)), 0);
+    DMA0->TCD[dma_channel].CSR &= ~(uint16_t)DMA_CSR_DREQ_MASK;  // Loop forever
+
+    DMAMUX_DisablePeriodTrigger(DMAMUX, dma_channel);
+    DMAMUX_SetSource(DMAMUX, dma_channel, (uint32_t)out->request);
+    DMAMUX_EnableChannel(DMAMUX, dma_channel);
+    EDMA_EnableChannelRequest(DMA0, dma_channel);
+}
+
+void led_pwm_init(void) {
+    ftm_config_t ftmConfig;
+
+    FTM_GetDefaultConfig(&ftmConfig);
+    ftmConfig.prescale = kFTM_Prescale_Divide_4;  // MOD fits 16 bits from 4 MHz (VLPR) to 60 MHz bus
+    (void)FTM_Init(LED_PWM_FTM, &ftmConfig);
+    // TPM-compatible mode: CnV writes load at the end of each period with no sync trigger
+    LED_PWM_FTM->MODE &= ~FTM_MODE_FTMEN_MASK;
+    pwm_mod = (led_pwm_source_clock() / 4U / LED_PWM_FREQ_HZ) - 1U;
+    FTM_SetTimerPeriod(LED_PWM_FTM, pwm_mod);
+    FTM_StartTimer(LED_PWM_FTM, kFTM_SystemClock);
+}
+
+void led_pwm_breathe(led_id_t led, uint32_t period_ms) {
+    const led_pwm_output_t *out = &pwm_outputs[led];
+    ftm_chnl_pwm_signal_param_t param = {
+        .chnlNumber = out->channel,
+        .level = kFTM_LowTrue,  // LEDs are active-low
+        .dutyCyclePercent = 0U,
+        .firstEdgeDelayPercent = 0U,
+        .enableComplementary = false,
+        .enableDeadtime = false,
+    };
+
+    led_pwm_stop(led);
+    pwm_period_ms[led] = period_ms;
+    led_pwm_build(led);
+
+    (void)FTM_SetupPwm(LED_PWM_FTM, &param, 1U, kFTM_EdgeAlignedPwm, LED_PWM_FREQ_HZ,
+                       led_pwm_source_clock());
+    LED_PWM_FTM->CONTROLS[out->channel].CnV = pwm_frames[led][0];
+    led_pwm_start_dma(led);
+    // CHIE with DMA set turns the channel match into a DMA request instead of an interrupt
+    FTM_EnableDmaTransfer(LED_PWM_FTM, out->channel, true);
+    FTM_EnableInterrupts(LED_PWM_FTM, 1UL << out->channel);
+    PORT_SetPinMux(out->port, out->pin, out->mux);
+}
+
+void led_pwm_stop(led_id_t led) {
+    const led_pwm_output_t *out = &pwm_outputs[led];
+    uint32_t dma_channel = LED_DMA_CHANNEL(led);
+
+    if (pwm_frame_count[led] == 0U) {
+        return;
+    }
+    PORT_SetPinMux(out->port, out->pin, kPORT_MuxAsGpio);
+    FTM_DisableInterrupts(LED_PWM_FTM, 1UL << out->channel);
+    FTM_EnableDmaTransfer(LED_PWM_FTM, out->channel, false);
+    EDMA_DisableChannelRequest(DMA0, dma_channel);
+    DMAMUX_DisableChannel(DMAMUX, dma_channel);
+    LED_PWM_FTM->CONTROLS[out->channel].CnSC = 0U;
+    pwm_frame_count[led] = 0U;
+}
+
+// Bus clock changed (called by led_driver's clock listener): new MOD, rebuilt tables
+void led_pwm_clock_changed(void) {
+    pwm_mod = (led_pwm_source_clock() / 4U / LED_PWM_FREQ_HZ) - 1U;
+    FTM_SetTimerPeriod(LED_PWM_FTM, pwm_mod);
+    for (uint32_t i = 0; i < LED_COUNT; i++) {
+        if (pwm_frame_count[i] != 0U) {
+            EDMA_DisableChannelRequest(DMA0, LED_DMA_CHANNEL(i));
+            led_pwm_build((led_id_t)i);
+            led_pwm_start_dma((led_id_t)i);
+        }
+    }
+}
@@ -0,0 +1,35 @@
+/*
+ * SEH500 Project - LED PWM backend
+ *
+ * Brightness control for the LED driver on FTM3 (green PTE6 = FTM3_CH1,
+ * red PTC9 = FTM3_CH5). A breathing cycle is precomputed as a table of
+ * gamma-corrected CnV values, one per PWM period. The channel's own match
+ * DMA request then feeds the next value into CnV every period, so a fade
+ * is timed entirely by the FTM counter with no per-step interrupt.
+ *
+ * Used through led_driver.h; the LED's DMA channel is shared with the
+ * GPIO pattern engine since only one backend drives an LED at a time.
+ */
+
+#ifndef LED_PWM_H_
+#define LED_PWM_H_
+
+#include <stdint.h>
+#include "led_driver.h"
+
+#define LED_PWM_FREQ_HZ    250U   // One table entry per PWM period
+#define LED_PWM_MAX_FRAMES 512U   // Longest breathing period: 2048 ms
+
+// Start FTM3 (call from led_driver_init)
+void led_pwm_init(void);
+
+// Take the pin from GPIO and breathe with the given period (ms, clamped)
+void led_pwm_breathe(led_id_t led, uint32_t period_ms);
+
+// Stop the PWM and give the pin back to GPIO (no effect if not running)
+void led_pwm_stop(led_id_t led);
+
+// Bus clock changed: recompute MOD and rebuild running tables (masked context)
+void led_pwm_clock_changed(void);
+
+#endif /* LED_PWM_H_ */
@@ -0,0 +1,138 @@
+/*
+ * SEH500 Project - Low-power idle governor
+ * See power_governor.h
+ */
+
+#include "power_governor.h"
+#include "board.h"
+#include "fsl_common.h"
+#include "fsl_smc.h"
+#include "fsl_gpio.h"
+#include "fsl_debug_console.h"
+#include "cycle_counter.h"
+#include "event_queue.h"
+#include "alert_fsm.h"
+#include "timer_service.h"
+#include "clock_mode.h"
+
+// LLWU wake pin: enable register/field, flag register/bit and the button it belongs to
+typedef struct {
+    volatile uint8_t *enable;
+    uint8_t enable_falling;
+    volatile uint8_t *flag;
+    uint8_t flag_mask;
+    GPIO_Type *gpio;
+    uint8_t button;  // ALERT_BUTTON code posted when this pin wakes the system
+} power_wake_pin_t;
+
+static const power_wake_pin_t power_wake_pins[] = {
+    // SW3 PTA10 = LLWU_P22, SW2 PTD11 = LLWU_P25 (2 = falling edge)
+    {&LLWU->PE6, LLWU_PE6_WUPE22(2U), &LLWU->PF3, LLWU_PF3_WUF22_MASK, GPIOA, ALERT_BUTTON_SW3},
+    {&LLWU->PE7, LLWU_PE7_WUPE25(2U), &LLWU->PF4, LLWU_PF4_WUF25_MASK, GPIOD, ALERT_BUTTON_SW2},
+};
+
+typedef struct {
+    uint32_t entries;
+    uint32_t aborts;        // Stop request rejected because an interrupt was already pending
+    uint32_t wake_last;     // Cycles from stop exit to full clock restored
+    uint32_t wake_max;
+} power_mode_stats_t;
+
+static const char *const power_mode_names[POWER_MODE_COUNT] = {"WAIT", "LLS"};
+static power_mode_stats_t power_stats[POWER_MODE_COUNT];
+static bool console_wake = true;
+static uint32_t bus_clock_users = 0;  // Bitmask of power_bus_user_t
+
+void power_governor_init(void) {
+    SMC_SetPowerModeProtection(SMC, kSMC_AllowPowerModeAll);
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(power_wake_pins); i++) {
+        *power_wake_pins[i].enable |= power_wake_pins[i].enable_falling;
+        *power_wake_pins[i].flag = power_wake_pins[i].flag_mask;  // w1c
+    }
+    EnableIRQ(LLWU_IRQn);
+}
+
+void power_governor_set_console_wake(bool enable) {
+    console_wake = enable;
+}
+
+bool power_governor_console_wake(void) {
+    return console_wake;
+}
+
+void power_governor_keep_bus_clock(power_bus_user_t user, bool keep) {
+    if (keep) {
+        bus_clock_users |= (1UL << user);
+    } else {
+        bus_clock_users &= ~(1UL << user);
+    }
+}
+
+// Pick the deepest mode every pending wake source can still reach
+static power_mode_t power_select_mode(void) {
+    if (timer_service_ms_to_next() != TIMER_WHEEL_NO_EXPIRY || bus_clock_users != 0U) {
+        return POWER_MODE_WAIT;  // PIT stops in LLS
+    }
+    if (console_wake) {
+        return POWER_MODE_WAIT;  // UART0 RX is not an LLWU pin and needs its clock to receive
+    }
+    return POWER_MODE_LLS;
+}
+
+void power_governor_idle(void) {
+    power_mode_t mode = power_select_mode();
+    power_mode_stats_t *stats = &power_stats[mode];
+
+    stats->entries++;
+    if (mode == POWER_MODE_WAIT) {
+        // Normal wait, SLEEPDEEP cleared: with it set a WFI is a stop and
+        // halts the PIT, eDMA, SAI and SDHC. Pending interrupts wake the
+        // core even with PRIMASK set.
+        (void)SMC_SetPowerModeWait(SMC);
+        return;
+    }
+
+    clock_mode_stop_prepare();  // No-op unless running in HSRUN
+    smc_power_mode_lls_config_t llsConfig = {.subMode = kSMC_StopSub3};
+    status_t status = SMC_SetPowerModeLls(SMC, &llsConfig);
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;  // Left set by the SDK
+
+    // Stop mode exited (back in RUN or VLPR); restore the run mode's clocks
+    uint32_t wake_start = cycle_counter_now();
+    clock_mode_stop_resume();
+    uint32_t wake_cycles = cycle_counter_now() - wake_start;
+
+    if (status != kStatus_Success) {
+        stats->aborts++;
+    }
+    stats->wake_last = wake_cycles;
+    if (wake_cycles > stats->wake_max) {
+        stats->wake_max = wake_cycles;
+    }
+}
+
+void power_governor_dump(void) {
+    PRINTF("[POWER] Console wake %s\r\n", console_wake ? "enabled (max WAIT)" : "disabled (LLS allowed)");
+    for (uint32_t mode = 0; mode < POWER_MODE_COUNT; mode++) {
+        const power_mode_stats_t *stats = &power_stats[mode];
+        PRINTF("[POWER] %-4s entries=%lu aborts=%lu wake last=%lu max=%lu cycles\r\n", power_mode_names[mode],
+               stats->entries, stats->aborts, stats->wake_last, stats->wake_max);
+    }
+}
+
+// LLWU interrupt - a button woke the system from LLS
+void LLWU_IRQHandler(void) {
+    for (uint32_t i = 0; i < ARRAY_SIZE(power_wake_pins); i++) {
+        const power_wake_pin_t *pin = &power_wake_pins[i];
+        if ((*pin->flag & pin->flag_mask) == 0U) {
+            continue;
+        }
+        *pin->flag = pin->flag_mask;  // w1c
+        // If the PORT flag latched too, its own ISR posts the press
+        if ((GPIO_PortGetInterruptFlags(pin->gpio) & (1UL << ALERT_BUTTON_PIN(pin->button))) == 0U) {
+            event_queue_post(EVENT_SOURCE_BUTTON, pin->button);
+        }
+    }
+    SDK_ISR_EXIT_BARRIER;
+}
@@ -0,0 +1,65 @@
+/*
+ * SEH500 Project - Low-power idle governor
+ *
+ * Replaces the bare __WFI() in the main loop. Each time the system is idle
+ * it picks the deepest mode that still honours every pending wake source:
+ *
+ *   timer, DMA pattern, audio stream, SD transfer -> WAIT (PIT/SAI/SDHC need the bus clock)
+ *   console input enabled                         -> WAIT (UART0 must be clocked to receive)
+ *   buttons only                                  -> LLS  (SW2/SW3 are LLWU pins P25/P22)
+ *
+ * There is no VLPS step for the console: UART0 runs from the core clock,
+ * so a keystroke could only wake the chip with its RX edge and the
+ * character itself would be lost. The console keeps the system in WAIT
+ * (VLPW at 4 MHz) until it is put to sleep ('Z' in the main loop); then
+ * only the buttons wake the system, and the first press or keystroke
+ * received turns the console wake back on.
+ *
+ * Stop modes cannot be entered from HSRUN, so when the clock mode manager
+ * has the chip in HSRUN the governor drops to RUN (PLL bypassed) around
+ * each stop. From VLPR (the usual idle mode) stops are entered directly.
+ * The time to get the run mode's clocks back after a wake is measured.
+ */
+
+#ifndef POWER_GOVERNOR_H_
+#define POWER_GOVERNOR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    POWER_MODE_WAIT = 0,  // Core clock gated, peripherals running
+    POWER_MODE_LLS,       // Low leakage stop, only LLWU sources wake
+    POWER_MODE_COUNT
+} power_mode_t;
+
+// Peripherals that run off the bus clock without the CPU (PIT-paced DMA).
+// While any of them is active the governor stops at WAIT (VLPW in VLPR).
+typedef enum {
+    POWER_BUS_USER_LED = 0,  // LED pattern engine
+    POWER_BUS_USER_AUDIO,    // SAI eDMA stream
+    POWER_BUS_USER_SD,       // SDHC transfer in flight (sd_async.c)
+    POWER_BUS_USER_COUNT
+} power_bus_user_t;
+
+// Configure LLWU wake pins (call once after the buttons are set up)
+void power_governor_init(void);
+
+// Whether a UART keystroke must be able to wake the system (default true).
+// When false the buttons are the only wake source and LLS can be used;
+// keys typed while the system is in LLS are not received.
+void power_governor_set_console_wake(bool enable);
+
+bool power_governor_console_wake(void);
+
+// Keep (or release) the bus clock running through idle for a peripheral
+void power_governor_keep_bus_clock(power_bus_user_t user, bool keep);
+
+// Sleep until the next interrupt. Call with interrupts masked (PRIMASK set)
+// after checking there is no work; returns with interrupts still masked.
+void power_governor_idle(void);
+
+// Print mode residency counts and wake-up latency on the debug console
+void power_governor_dump(void);
+
+#endif /* POWER_GOVERNOR_H_ */
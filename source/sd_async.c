@@ -0,0 +1,316 @@
+/*
+ * SEH500 Project - Non-blocking file reads and writes on the SD card
+ * See sd_async.h
+ */
+
+#include <string.h>
+#include "sd_async.h"
+#include "fsl_common.h"
+#include "fsl_sd.h"
+#include "fsl_sdhc.h"
+#include "diskio.h"
+#include "event_queue.h"
+#include "clock_mode.h"
+#include "power_governor.h"
+
+extern sd_card_t g_sd;  // fsl_sd_disk.c
+
+#define SD_ASYNC_SECTOR 512U  // FF_MAX_SS, and the card's block size
+
+// ff.c's FA_DIRTY: FIL.buf holds data not yet written to the card
+#define SD_ASYNC_FA_DIRTY 0x80U
+
+typedef enum {
+    SD_ASYNC_IDLE = 0,
+    SD_ASYNC_READY,     // Next run to start once the card is free
+    SD_ASYNC_RUNNING,   // Transfer in flight; the SDHC interrupt ends it
+    SD_ASYNC_RAN,       // Data phase over, status in sd_async_status
+    SD_ASYNC_SETTLING,  // Write sent, card still programming (DAT0 low)
+    SD_ASYNC_DONE       // Over; callback due in sd_async_service()
+} sd_async_state_t;
+
+typedef void (*sd_async_sdhc_callback_t)(SDHC_Type *base, sdhc_handle_t *handle, status_t status, void *userData);
+
+typedef struct {
+    FIL *fp;
+    uint8_t *buf;
+    FSIZE_t ofs;          // File offset of the next run
+    UINT left;            // Bytes still to move
+    UINT moved;           // Bytes moved so far
+    UINT run_blocks;      // Blocks in the run in flight
+    bool write;
+    FRESULT result;
+    sd_async_done_t done;
+    void *arg;
+} sd_async_op_t;
+
+static sd_async_op_t sd_async_op;
+static volatile sd_async_state_t sd_async_state = SD_ASYNC_IDLE;
+static volatile status_t sd_async_status;
+static sd_async_sdhc_callback_t sd_async_host_callback;  // The host layer's, handed back after each run
+static sd_async_stats_t sd_async_stats;
+
+// The command and data descriptions are read by the interrupt handler
+// until the transfer ends, so they cannot live on the stack
+static sdhc_command_t sd_async_command;
+static sdhc_data_t sd_async_data;
+static sdhc_transfer_t sd_async_transfer = {&sd_async_data, &sd_async_command};
+
+static SDHC_Type *sd_async_base(void) {
+    return g_sd.host->hostController.base;
+}
+
+static bool sd_async_card_busy(void) {
+    return (SDHC_GetPresentStatusFlags(sd_async_base()) & (uint32_t)kSDHC_Data0LineLevelFlag) == 0U;
+}
+
+// SDHC interrupt: the command response comes first and the data phase
+// (with its auto CMD12) ends the run. A failed command response can leave
+// the data phase running, so then the callback stays borrowed (and ignores
+// the data phase's end) until sd_async_end_run() has reset the data line.
+static void sd_async_transfer_complete(SDHC_Type *base, sdhc_handle_t *handle, status_t status, void *userData) {
+    if (status == kStatus_SDHC_TransferCommandComplete || sd_async_state != SD_ASYNC_RUNNING) {
+        return;
+    }
+    if (status != kStatus_SDHC_SendCommandFailed) {
+        handle->callback.TransferComplete = sd_async_host_callback;
+    }
+    sd_async_status = status;
+    sd_async_state = SD_ASYNC_RAN;
+    (void)event_queue_post(EVENT_SOURCE_STORAGE, 0U);
+}
+
+// Card sector at file offset ofs and how many follow it in the same
+// fragment, from the link map: (cluster count, first cluster) pairs
+static bool sd_async_map(const FIL *fp, FSIZE_t ofs, LBA_t *sector, DWORD *run) {
+    const FATFS *fs = fp->obj.fs;
+    DWORD csize = fs->csize;
+    DWORD cl = (DWORD)(ofs / SD_ASYNC_SECTOR / csize);
+    DWORD in = (DWORD)(ofs / SD_ASYNC_SECTOR % csize);
+    const DWORD *tbl = fp->cltbl + 1;
+
+    for (DWORD ncl = *tbl++; ncl != 0U; ncl = *tbl++) {
+        DWORD first = *tbl++;
+        if (cl < ncl) {
+            *sector = fs->database + (LBA_t)csize * (first + cl - 2U) + in;
+            *run = (ncl - cl) * csize - in;
+            return true;
+        }
+        cl -= ncl;
+    }
+    return false;
+}
+
+static void sd_async_finish(FRESULT res) {
+    sd_async_op.result = res;
+    sd_async_state = SD_ASYNC_DONE;
+    if (res == FR_OK) {
+        sd_async_stats.bytes += sd_async_op.moved;
+    } else {
+        sd_async_stats.errors++;
+    }
+    power_governor_keep_bus_clock(POWER_BUS_USER_SD, false);
+    clock_mode_request(CLOCK_CLIENT_SD, CLOCK_MODE_VLPR);
+}
+
+// Issue the next run of blocks; false if the card or host is not ready yet
+static bool sd_async_start_run(void) {
+    sdmmchost_t *host = g_sd.host;
+    LBA_t sector;
+    DWORD run;
+
+    if (sd_async_card_busy()) {
+        return false;
+    }
+    if (!sd_async_map(sd_async_op.fp, sd_async_op.ofs, &sector, &run)) {
+        sd_async_finish(FR_INT_ERR);  // Map shorter than the file
+        return true;
+    }
+    UINT blocks = sd_async_op.left / SD_ASYNC_SECTOR;
+    blocks = (blocks < run) ? blocks : (UINT)run;
+    blocks = (blocks < SD_ASYNC_MAX_BLOCKS) ? blocks : SD_ASYNC_MAX_BLOCKS;
+
+    // FIL.buf holding one of the sectors about to be written gets the new
+    // data too: FatFs trusts fp->sect, so a stale copy would be read back
+    // (and, once dirtied, written over the card). A copy FatFs has dirtied
+    // since the start is newer than this write and is left for it to flush.
+    FIL *fp = sd_async_op.fp;
+    if (sd_async_op.write && fp->sect - sector < blocks && (fp->flag & SD_ASYNC_FA_DIRTY) == 0U) {
+        memcpy(fp->buf, &sd_async_op.buf[(fp->sect - sector) * SD_ASYNC_SECTOR], SD_ASYNC_SECTOR);
+    }
+
+    sd_async_command.index = sd_async_op.write ? ((blocks == 1U) ? (uint32_t)kSDMMC_WriteSingleBlock
+                                                                  : (uint32_t)kSDMMC_WriteMultipleBlock)
+                                               : ((blocks == 1U) ? (uint32_t)kSDMMC_ReadSingleBlock
+                                                                  : (uint32_t)kSDMMC_ReadMultipleBlock);
+    // Standard capacity cards are addressed in bytes
+    sd_async_command.argument = ((g_sd.flags & (uint32_t)kSD_SupportHighCapacityFlag) != 0U)
+                                    ? (uint32_t)sector
+                                    : (uint32_t)sector * SD_ASYNC_SECTOR;
+    sd_async_command.type = kCARD_CommandTypeNormal;
+    sd_async_command.responseType = kCARD_ResponseTypeR1;
+    sd_async_command.responseErrorFlags = SDMMC_R1_ALL_ERROR_FLAG;
+    sd_async_data.enableAutoCommand12 = true;
+    sd_async_data.enableIgnoreError = false;
+    sd_async_data.blockSize = SD_ASYNC_SECTOR;
+    sd_async_data.blockCount = blocks;
+    sd_async_data.rxData = sd_async_op.write ? NULL : (uint32_t *)(void *)sd_async_op.buf;
+    sd_async_data.txData = sd_async_op.write ? (const uint32_t *)(void *)sd_async_op.buf : NULL;
+
+    // Running before the interrupt can say otherwise; the host's callback
+    // comes back from the handler, or here if the transfer never started
+    sd_async_host_callback = host->handle.callback.TransferComplete;
+    host->handle.callback.TransferComplete = sd_async_transfer_complete;
+    sd_async_op.run_blocks = blocks;
+    sd_async_state = SD_ASYNC_RUNNING;
+    status_t status = SDHC_TransferNonBlocking(host->hostController.base, &host->handle,
+                                               (uint32_t *)host->dmaDesBuffer, host->dmaDesBufferWordsNum,
+                                               &sd_async_transfer);
+    if (status != kStatus_Success) {
+        host->handle.callback.TransferComplete = sd_async_host_callback;
+        if (status == kStatus_SDHC_BusyTransferring) {
+            sd_async_state = SD_ASYNC_READY;
+            return false;
+        }
+        sd_async_finish(FR_DISK_ERR);
+        return true;
+    }
+    sd_async_stats.runs++;
+    return false;
+}
+
+// A run ended: on to the next one, the card's programming, or the end
+static void sd_async_end_run(void) {
+    if (sd_async_status != kStatus_SDHC_TransferDataComplete) {
+        // Same recovery as the host layer after a failed transfer
+        SDHC_Type *base = sd_async_base();
+        uint32_t present = SDHC_GetPresentStatusFlags(base);
+        if ((present & (uint32_t)kSDHC_CommandInhibitFlag) != 0U) {
+            (void)SDHC_Reset(base, kSDHC_ResetCommand, 100U);
+        }
+        if (sd_async_status == kStatus_SDHC_SendCommandFailed) {
+            // The data phase may still be pending: abort it with the interrupt
+            // masked, so it cannot end in the host's callback as a stray event
+            sdmmchost_t *host = g_sd.host;
+            DisableIRQ(SDHC_IRQn);
+            (void)SDHC_Reset(base, kSDHC_ResetData, 100U);
+            SDHC_DisableInterruptSignal(base, (uint32_t)kSDHC_DataFlag | (uint32_t)kSDHC_DataDMAFlag);
+            SDHC_ClearInterruptStatusFlags(base, (uint32_t)kSDHC_DataFlag | (uint32_t)kSDHC_DataDMAFlag);
+            host->handle.data = NULL;
+            host->handle.callback.TransferComplete = sd_async_host_callback;
+            EnableIRQ(SDHC_IRQn);
+        } else if ((present & (uint32_t)kSDHC_DataInhibitFlag) != 0U) {
+            (void)SDHC_Reset(base, kSDHC_ResetData, 100U);
+        }
+        sd_async_finish(FR_DISK_ERR);
+        return;
+    }
+
+    UINT bytes = sd_async_op.run_blocks * SD_ASYNC_SECTOR;
+    sd_async_op.buf += bytes;
+    sd_async_op.ofs += bytes;
+    sd_async_op.left -= bytes;
+    sd_async_op.moved += bytes;
+    if (sd_async_op.left != 0U) {
+        sd_async_state = SD_ASYNC_READY;
+    } else if (sd_async_op.write) {
+        sd_async_state = SD_ASYNC_SETTLING;
+    } else {
+        sd_async_finish(FR_OK);
+    }
+}
+
+// Take the operation as far as it goes without waiting
+static void sd_async_step(void) {
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        switch (sd_async_state) {
+            case SD_ASYNC_READY:
+                progress = sd_async_start_run();
+                break;
+            case SD_ASYNC_RAN:
+                sd_async_end_run();
+                progress = true;
+                break;
+            case SD_ASYNC_SETTLING:
+                if (!sd_async_card_busy()) {
+                    sd_async_finish(FR_OK);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static FRESULT sd_async_start(FIL *fp, FSIZE_t ofs, uint8_t *buf, UINT len, bool write, sd_async_done_t done,
+                              void *arg) {
+    if (fp == NULL || fp->obj.fs == NULL || fp->obj.fs->fs_type == 0U || fp->obj.fs->pdrv != SDDISK ||
+        fp->cltbl == NULL || len == 0U || (ofs % SD_ASYNC_SECTOR) != 0U || (len % SD_ASYNC_SECTOR) != 0U ||
+        ((uintptr_t)buf & 3U) != 0U || ofs + len > f_size(fp) || done == NULL) {
+        return FR_INVALID_PARAMETER;
+    }
+    if ((write && (fp->flag & FA_WRITE) == 0U) || (fp->flag & SD_ASYNC_FA_DIRTY) != 0U) {
+        return FR_DENIED;
+    }
+    if (sd_async_state != SD_ASYNC_IDLE) {
+        return FR_LOCKED;
+    }
+
+    sd_async_op.fp = fp;
+    sd_async_op.buf = buf;
+    sd_async_op.ofs = ofs;
+    sd_async_op.left = len;
+    sd_async_op.moved = 0U;
+    sd_async_op.write = write;
+    sd_async_op.done = done;
+    sd_async_op.arg = arg;
+    if (write) {
+        sd_async_stats.writes++;
+    } else {
+        sd_async_stats.reads++;
+    }
+    // The SDHC clock was divided from HSRUN at mount; the host's interrupt
+    // needs the bus clock through idle
+    clock_mode_request(CLOCK_CLIENT_SD, CLOCK_MODE_HSRUN);
+    power_governor_keep_bus_clock(POWER_BUS_USER_SD, true);
+    sd_async_state = SD_ASYNC_READY;
+    sd_async_step();
+    return FR_OK;
+}
+
+FRESULT sd_async_read(FIL *fp, FSIZE_t ofs, void *buf, UINT btr, sd_async_done_t done, void *arg) {
+    return sd_async_start(fp, ofs, (uint8_t *)buf, btr, false, done, arg);
+}
+
+FRESULT sd_async_write(FIL *fp, FSIZE_t ofs, const void *buf, UINT btw, sd_async_done_t done, void *arg) {
+    return sd_async_start(fp, ofs, (uint8_t *)(uintptr_t)buf, btw, true, done, arg);
+}
+
+bool sd_async_busy(void) {
+    return sd_async_state != SD_ASYNC_IDLE;
+}
+
+bool sd_async_service(void) {
+    sd_async_step();
+    if (sd_async_state == SD_ASYNC_DONE) {
+        sd_async_state = SD_ASYNC_IDLE;  // First, so the callback can start another
+        sd_async_op.done(sd_async_op.result, sd_async_op.moved, sd_async_op.arg);
+    }
+    return sd_async_state == SD_ASYNC_READY || sd_async_state == SD_ASYNC_SETTLING;
+}
+
+void sd_async_wait(void) {
+    if (sd_async_state == SD_ASYNC_IDLE || sd_async_state == SD_ASYNC_DONE) {
+        return;
+    }
+    sd_async_stats.waited++;
+    do {
+        sd_async_step();  // Spins through RUNNING until the interrupt ends the run
+    } while (sd_async_state != SD_ASYNC_DONE);
+}
+
+void sd_async_get_stats(sd_async_stats_t *stats) {
+    *stats = sd_async_stats;
+}
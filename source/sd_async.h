@@ -0,0 +1,81 @@
+/*
+ * SEH500 Project - Non-blocking file reads and writes on the SD card
+ *
+ * f_read()/f_write() on the card end in SDMMCHOST_TransferFunction(), which
+ * starts the SDHC transfer and then waits for it, so the main loop stands
+ * still for every block the card moves. sd_async_read()/sd_async_write()
+ * start the transfer the same way (CMD17/18 or CMD24/25, ADMA2 straight
+ * to or from the caller's buffer) and return: the SDHC interrupt posts an
+ * EVENT_SOURCE_STORAGE event when the data phase ends, and the main loop
+ * handles events, refills audio and sleeps meanwhile. sd_async_service()
+ * moves the operation on from the main loop (next run of blocks, card
+ * programming after a write) and, once it is over, calls the completion
+ * callback there, never in interrupt context.
+ *
+ * Sectors are found without FatFs, from the file's cluster link map, so
+ * the file must have one (sd_storage_open(), or f_lseek(CREATE_LINKMAP) on
+ * a file opened for writing) and the transfer must be whole sectors: the
+ * offset, the length and a word-aligned buffer. Anything else is refused
+ * with FR_INVALID_PARAMETER and the caller uses f_read()/f_write(). Both
+ * calls take their own file offset and leave the file pointer alone, so
+ * streams sharing a FIL can use them. Writes only overwrite data already in
+ * the file (the link map cannot grow it) and, like every direct transfer,
+ * skip the sector cache, which never holds file data; a sector the FIL's
+ * own buffer holds is updated there as well.
+ *
+ * One operation is in flight at a time. FatFs keeps working meanwhile:
+ * the disk layer finishes the card's part of an operation before it issues
+ * a transfer of its own (sd_async_wait()), and the callback still waits
+ * for the main loop.
+ */
+
+#ifndef SD_ASYNC_H_
+#define SD_ASYNC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+
+// Most blocks per command; longer transfers (and every fragment) take several
+#define SD_ASYNC_MAX_BLOCKS 64U
+
+// Called from sd_async_service() with the result and the bytes moved (all
+// of them unless res says otherwise). It may start the next operation.
+typedef void (*sd_async_done_t)(FRESULT res, UINT bytes, void *arg);
+
+typedef struct {
+    uint32_t reads;    // Operations started, by direction
+    uint32_t writes;
+    uint32_t runs;     // Commands issued (one per run of contiguous blocks)
+    uint32_t bytes;    // Bytes moved by finished operations
+    uint32_t errors;   // Operations that ended with a card error
+    uint32_t waited;   // Operations the disk layer had to finish for FatFs
+} sd_async_stats_t;
+
+// Read btr bytes at ofs of fp into buf, then call done. FR_OK if started;
+// FR_INVALID_PARAMETER if the transfer cannot be made this way (see above),
+// FR_DENIED if FIL.buf holds unwritten data (f_sync() first), FR_LOCKED if
+// another operation is in flight.
+FRESULT sd_async_read(FIL *fp, FSIZE_t ofs, void *buf, UINT btr, sd_async_done_t done, void *arg);
+
+// Write btw bytes from buf at ofs of fp, then call done; buf must stay
+// untouched until then. Same results as sd_async_read(), and FR_DENIED if
+// fp is not open for writing.
+FRESULT sd_async_write(FIL *fp, FSIZE_t ofs, const void *buf, UINT btw, sd_async_done_t done, void *arg);
+
+// True from the start of an operation until its callback has run
+bool sd_async_busy(void);
+
+// Move the operation on and run the callback if it is over (main loop, on
+// EVENT_SOURCE_STORAGE and before sleeping). Returns true while the card
+// has to be polled (it raises no interrupt when it finishes programming):
+// call again before sleeping.
+bool sd_async_service(void);
+
+// Finish the card's part of the operation in flight, leaving the callback
+// for sd_async_service() (the disk layer, before any transfer of its own)
+void sd_async_wait(void);
+
+void sd_async_get_stats(sd_async_stats_t *stats);
+
+#endif /* SD_ASYNC_H_ */
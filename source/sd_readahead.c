@@ -0,0 +1,222 @@
+/*
+ * SEH500 Project - Read-ahead for files streamed from the SD card
+ * See sd_readahead.h
+ */
+
+#include <string.h>
+#include "sd_readahead.h"
+#include "sd_async.h"
+
+#define SD_READAHEAD_SECTOR 512U  // FF_MAX_SS
+
+#if (SD_READAHEAD_SIZE % SD_READAHEAD_SECTOR) != 0 || (SD_READAHEAD_CHUNK % SD_READAHEAD_SECTOR) != 0
+#error "The read-ahead window and chunk must be whole sectors"
+#endif
+
+static uint32_t sd_readahead_min(uint32_t a, uint32_t b) {
+    return (a < b) ? a : b;
+}
+
+// Free window space at the tail for the bytes from fill_pos: up to max,
+// ending on a sector boundary of the file where possible; 0 if there is
+// nothing to read now
+static uint32_t sd_readahead_span(sd_readahead_t *ra, uint32_t max, uint32_t *tail) {
+    if (ra->fp == NULL || ra->done || ra->pending != 0U || ra->count == SD_READAHEAD_SIZE) {
+        return 0U;
+    }
+    if (ra->fill_pos >= ra->end) {
+        if (ra->loop >= ra->end) {
+            ra->done = true;
+            return 0U;
+        }
+        ra->fill_pos = ra->loop;
+    }
+
+    *tail = (ra->head + ra->count) % SD_READAHEAD_SIZE;
+    uint32_t len = sd_readahead_min(SD_READAHEAD_SIZE - ra->count, SD_READAHEAD_SIZE - *tail);
+    len = sd_readahead_min(len, max);
+    len = sd_readahead_min(len, (uint32_t)(ra->end - ra->fill_pos));
+    uint32_t over = (uint32_t)((ra->fill_pos + len) % SD_READAHEAD_SECTOR);
+    if (len > over && ra->fill_pos + len < ra->end) {
+        len -= over;  // The next fill starts on a sector and goes straight to the window
+    }
+    return len;
+}
+
+static void sd_readahead_filled(sd_readahead_t *ra, uint32_t got) {
+    ra->fill_pos += got;
+    ra->count += got;
+    if (ra->count >= ra->depth) {
+        ra->primed = true;
+    }
+}
+
+// Read up to max bytes at fill_pos into the window; false if nothing was read
+static bool sd_readahead_fetch(sd_readahead_t *ra, uint32_t max) {
+    uint32_t tail = 0U;
+    uint32_t len = sd_readahead_span(ra, max, &tail);
+    if (len == 0U) {
+        return false;
+    }
+
+    UINT got = 0U;
+    if ((f_tell(ra->fp) != ra->fill_pos && f_lseek(ra->fp, ra->fill_pos) != FR_OK) ||
+        f_read(ra->fp, &ra->buf[tail], len, &got) != FR_OK || got < len) {
+        ra->done = true;  // What was read is still served; the reader sees the end after it
+    }
+    sd_readahead_filled(ra, got);
+    return got != 0U;
+}
+
+// sd_async_read() completion (main loop)
+static void sd_readahead_fetched(FRESULT res, UINT bytes, void *arg) {
+    sd_readahead_t *ra = (sd_readahead_t *)arg;
+    uint32_t len = ra->pending;
+    ra->pending = 0U;
+    if (res != FR_OK || bytes < len) {
+        ra->done = true;
+    }
+    sd_readahead_filled(ra, (res == FR_OK) ? bytes : 0U);
+}
+
+// Let a read in flight land before the window is used or handed back
+static void sd_readahead_settle(sd_readahead_t *ra) {
+    if (ra->pending != 0U) {
+        sd_async_wait();
+        (void)sd_async_service();  // Only this stream's read can be in flight
+    }
+}
+
+void sd_readahead_start(sd_readahead_t *ra, FIL *fp, FSIZE_t start, FSIZE_t end, FSIZE_t loop) {
+    sd_readahead_settle(ra);
+    ra->fp = fp;
+    ra->fill_pos = start;
+    ra->end = end;
+    ra->loop = (loop < end) ? loop : end;
+    // Window offset = file offset within a sector, so sector-aligned reads land sector-aligned
+    ra->head = (uint32_t)(start % SD_READAHEAD_SECTOR);
+    ra->count = 0U;
+    ra->depth = SD_READAHEAD_SIZE;  // Until the first period says otherwise
+    ra->rate = 0U;
+    ra->period_bytes = 0U;
+    ra->peak = 0U;
+    ra->primed = false;
+    ra->done = false;
+}
+
+void sd_readahead_stop(sd_readahead_t *ra) {
+    sd_readahead_settle(ra);
+    ra->fp = NULL;
+    ra->count = 0U;
+}
+
+// Bytes of a read of len at file offset pos into dst that f_read() takes
+// straight from the card: its whole sectors, when they land word-aligned in
+// dst so the SD driver's DMA needs no bounce buffer
+static uint32_t sd_readahead_whole(FSIZE_t pos, uint32_t len, const uint8_t *dst) {
+    uint32_t lead = (uint32_t)((SD_READAHEAD_SECTOR - pos % SD_READAHEAD_SECTOR) % SD_READAHEAD_SECTOR);
+    if (len <= lead || ((uintptr_t)(dst + lead) & 3U) != 0U) {
+        return 0U;
+    }
+    return (len - lead) / SD_READAHEAD_SECTOR * SD_READAHEAD_SECTOR;
+}
+
+// The window is empty: read up to want bytes at fill_pos straight into the
+// reader's buffer instead of filling the window and copying them out
+static uint32_t sd_readahead_direct(sd_readahead_t *ra, uint8_t *dst, uint32_t want) {
+    if (ra->fp == NULL || ra->done) {
+        return 0U;
+    }
+    if (ra->fill_pos >= ra->end) {
+        if (ra->loop >= ra->end) {
+            ra->done = true;
+            return 0U;
+        }
+        ra->fill_pos = ra->loop;
+    }
+
+    uint32_t len = sd_readahead_min(want, (uint32_t)(ra->end - ra->fill_pos));
+    UINT got = 0U;
+    if ((f_tell(ra->fp) != ra->fill_pos && f_lseek(ra->fp, ra->fill_pos) != FR_OK) ||
+        f_read(ra->fp, dst, len, &got) != FR_OK || got < len) {
+        ra->done = true;
+    }
+    uint32_t whole = sd_readahead_whole(ra->fill_pos, got, dst);
+    ra->fast_bytes += whole;
+    ra->copy_bytes += got - whole;  // Partial sectors come through FIL.buf
+    ra->fill_pos += got;
+    ra->head = (uint32_t)(ra->fill_pos % SD_READAHEAD_SECTOR);  // Refill in step with the file again
+    return got;
+}
+
+uint32_t sd_readahead_read(sd_readahead_t *ra, void *dst, uint32_t want) {
+    if (ra->count < want) {
+        if (ra->primed && !ra->done) {
+            ra->stalls++;
+        }
+        sd_readahead_settle(ra);
+    }
+
+    // What the window holds, then the rest from the card
+    uint8_t *out = (uint8_t *)dst;
+    uint32_t n = sd_readahead_min(want, ra->count);
+    uint32_t first = sd_readahead_min(n, SD_READAHEAD_SIZE - ra->head);
+    memcpy(out, &ra->buf[ra->head], first);
+    memcpy(out + first, ra->buf, n - first);
+    ra->head = (ra->head + n) % SD_READAHEAD_SIZE;
+    ra->count -= n;
+    ra->copy_bytes += n;
+    while (n < want) {
+        uint32_t got = sd_readahead_direct(ra, out + n, want - n);
+        if (got == 0U) {
+            break;
+        }
+        n += got;
+    }
+
+    ra->period_bytes += n;
+    ra->peak = (want > ra->peak) ? want : ra->peak;
+    return n;
+}
+
+uint32_t sd_readahead_peek(sd_readahead_t *ra, const uint8_t **data) {
+    *data = &ra->buf[ra->head];
+    return sd_readahead_min(ra->count, SD_READAHEAD_SIZE - ra->head);
+}
+
+void sd_readahead_skip(sd_readahead_t *ra, uint32_t n) {
+    ra->head = (ra->head + n) % SD_READAHEAD_SIZE;
+    ra->count -= n;
+    ra->fast_bytes += n;
+    ra->period_bytes += n;
+    ra->peak = (n > ra->peak) ? n : ra->peak;
+}
+
+void sd_readahead_period(sd_readahead_t *ra) {
+    // Smoothed over about four periods; the first one is taken as it is
+    ra->rate = (ra->rate == 0U) ? ra->period_bytes : (3U * ra->rate + ra->period_bytes) / 4U;
+    ra->period_bytes = 0U;
+
+    // The lead, plus room for the largest single read on top (an ADPCM block run)
+    uint32_t depth = SD_READAHEAD_LEAD * ra->rate + ra->peak;
+    depth = (depth + SD_READAHEAD_SECTOR - 1U) & ~(SD_READAHEAD_SECTOR - 1U);
+    ra->depth = (depth < SD_READAHEAD_MIN) ? SD_READAHEAD_MIN : sd_readahead_min(depth, SD_READAHEAD_SIZE);
+}
+
+bool sd_readahead_fill(sd_readahead_t *ra) {
+    if (ra->fp == NULL || ra->count >= ra->depth || ra->pending != 0U || sd_async_busy()) {
+        return false;  // A read in flight wakes the main loop when it lands
+    }
+
+    // Whole sectors are read in the background, as many as fit; the rest
+    // (partial sectors, or a file without a link map) is read here in chunks
+    uint32_t tail = 0U;
+    uint32_t len = sd_readahead_span(ra, SD_READAHEAD_SIZE, &tail);
+    if (len != 0U && (ra->fill_pos % SD_READAHEAD_SECTOR) == 0U && (len % SD_READAHEAD_SECTOR) == 0U) {
+        if (sd_async_read(ra->fp, ra->fill_pos, &ra->buf[tail], len, sd_readahead_fetched, ra) == FR_OK) {
+            ra->pending = len;
+            return true;
+        }
+    }
+    return sd_readahead_fetch(ra, SD_READAHEAD_CHUNK);
+}
@@ -0,0 +1,102 @@
+/*
+ * SEH500 Project - Read-ahead for files streamed from the SD card
+ *
+ * f_read() goes to the card for exactly what it is asked for, so a reader
+ * that takes a few KB per audio buffer pays the card's command latency in
+ * the middle of every refill. A read-ahead stream keeps a window of the
+ * data ahead of its reader in RAM: sd_readahead_read() is a copy out of
+ * the window, and sd_readahead_fill(), called from the main loop when it
+ * has nothing else to do, tops the window back up. Whole sectors of a file
+ * with a link map are read with sd_async_read(), straight into the window
+ * while the main loop goes on handling events; anything else is read with
+ * f_read() in sector-aligned chunks. Only a read that finds the window
+ * short waits on the card (a stall, counted), and what the window lacks is
+ * then read straight into the reader's buffer rather than through it.
+ *
+ * A reader that can use the data where it lies (a decoder) peeks at the
+ * window instead of copying out of it, so those bytes are moved only by
+ * the card's DMA. The bytes each stream handed over without a copy and
+ * with one are counted.
+ *
+ * A stream covers one byte range of a file and may loop within it, the
+ * way a clip plays: the reader sees the loop as one endless run and the
+ * window is filled across the loop point, so looping never stalls either.
+ * Streams can share a FIL (voices playing from one clip bank file): each
+ * fill seeks first if another stream moved the file, which costs no FAT
+ * access for a file from sd_storage_open().
+ *
+ * How far ahead the window is kept follows the reader. The reader marks
+ * its own periods (the player: one per DMA buffer rendered) and the depth
+ * is SD_READAHEAD_LEAD periods of the bytes it has been taking per period,
+ * plus its largest single read, in whole sectors: an 8 kHz ADPCM clip
+ * keeps SD_READAHEAD_MIN buffered and a 44.1 kHz stereo clip the whole
+ * window.
+ */
+
+#ifndef SD_READAHEAD_H_
+#define SD_READAHEAD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+
+// Window per stream (a whole number of sectors); 8 KB is 46 ms of 44.1 kHz stereo
+#define SD_READAHEAD_SIZE   8192U
+
+// Most read by f_read() per fill call, so a fill never holds up the main loop for long
+#define SD_READAHEAD_CHUNK  2048U
+
+// Depth kept ahead in reader periods, and the least kept whatever the rate
+#define SD_READAHEAD_LEAD   2U
+#define SD_READAHEAD_MIN    1024U
+
+typedef struct {
+    FIL *fp;
+    FSIZE_t fill_pos;    // File offset of the next byte to buffer
+    FSIZE_t end;         // The range ends (or loops) here
+    FSIZE_t loop;        // Where it loops back to; == end: no loop
+    uint32_t head;       // Oldest unread byte in buf
+    uint32_t count;      // Bytes buffered from head
+    uint32_t pending;    // Bytes being read in the background after them, 0 if none
+    uint32_t depth;      // Bytes to keep buffered
+    uint32_t rate;       // Bytes taken per period, smoothed
+    uint32_t period_bytes;  // Bytes taken in the current period
+    uint32_t peak;       // Largest single read
+    bool primed;         // The window has reached depth once; later shortfalls are stalls
+    bool done;           // Range over (no loop) or the card failed; nothing more to fetch
+    uint32_t stalls;     // Reads that had to wait on the card (kept across starts)
+    uint32_t fast_bytes; // Bytes the reader got uncopied: in place, or DMA'd into its buffer (kept)
+    uint32_t copy_bytes; // Bytes copied to the reader: out of the window or FIL.buf (kept)
+    uint8_t buf[SD_READAHEAD_SIZE] __attribute__((aligned(4)));
+} sd_readahead_t;
+
+// Stream [start, end) of fp, starting over at loop on reaching end (loop >=
+// end: no loop). fp stays open and owned by the caller.
+void sd_readahead_start(sd_readahead_t *ra, FIL *fp, FSIZE_t start, FSIZE_t end, FSIZE_t loop);
+
+// Stop using the stream (after any read in flight lands); sd_readahead_fill()
+// does nothing from here on
+void sd_readahead_stop(sd_readahead_t *ra);
+
+// Next want bytes into dst, from the window or, if it runs short, from the
+// card: the rest is read straight into dst, so whole sectors of it go from
+// the card's DMA to dst uncopied when dst is word-aligned where they land.
+// Returns the bytes read: short only at the end of the range or on a card
+// error.
+uint32_t sd_readahead_read(sd_readahead_t *ra, void *dst, uint32_t want);
+
+// Zero-copy read: the bytes buffered in one piece from the next one, at
+// *data in the window. Take what is used with sd_readahead_skip() before
+// the stream is used again; if it is not enough, sd_readahead_read() them.
+uint32_t sd_readahead_peek(sd_readahead_t *ra, const uint8_t **data);
+void sd_readahead_skip(sd_readahead_t *ra, uint32_t n);
+
+// End of one reader period: adjust the depth to what the period took
+void sd_readahead_period(sd_readahead_t *ra);
+
+// Start a background read, or read one chunk, if the window is below depth
+// and the card is free. Returns true if it did (call again before sleeping);
+// a background read wakes the main loop when it lands.
+bool sd_readahead_fill(sd_readahead_t *ra);
+
+#endif /* SD_READAHEAD_H_ */
@@ -0,0 +1,237 @@
+/*
+ * SEH500 Project - SD card storage
+ * See sd_storage.h
+ */
+
+#include "sd_storage.h"
+#include "fsl_common.h"
+#include "fsl_gpio.h"
+#include "fsl_debug_console.h"
+#include "pin_mux.h"
+#include "sdmmc_config.h"
+#include "ff.h"
+#include "diskio.h"
+#include "cycle_counter.h"
+#include "sector_cache.h"
+#include "sd_async.h"
+
+extern sd_card_t g_sd;  // fsl_sd_disk.c
+
+static FATFS sd_fs;
+static bool sd_mounted = false;
+
+// Link maps lent to files opened without one of their own
+typedef struct {
+    FIL *owner;  // NULL while free
+    DWORD map[SD_STORAGE_CLMT_WORDS];
+} sd_clmt_t;
+
+static sd_clmt_t sd_clmt_pool[SD_STORAGE_CLMT_POOL];
+static uint32_t sd_clmt_mapped;    // Opens that got a link map
+static uint32_t sd_clmt_unmapped;  // Opens left walking the FAT (no map free, or too fragmented)
+
+// sd_async.c posts events from the SDHC interrupt, so it runs at the NVIC
+// priority every other event_queue producer has (the default 0) instead of
+// the board's BOARD_SDMMC_SD_HOST_IRQ_PRIORITY (5), which they would preempt
+#define SD_STORAGE_IRQ_PRIORITY 0U
+
+// Smallest useful map: its size, one fragment (length, start) and the terminator
+#define SD_CLMT_MIN_WORDS 4U
+
+static bool sd_storage_card_detected(void) {
+    return GPIO_PinRead(BOARD_SDMMC_SD_CD_GPIO_BASE, BOARD_SDMMC_SD_CD_GPIO_PIN) == BOARD_SDMMC_SD_CD_INSERT_LEVEL;
+}
+
+bool sd_storage_init(void) {
+    BOARD_InitSDHC0Pins();
+    BOARD_SD_Config(&g_sd, NULL, SD_STORAGE_IRQ_PRIORITY, NULL);
+    g_sd.usrParam.cd->type = BOARD_SDMMC_SD_CD_TYPE;
+    g_sd.usrParam.cd->cdDebounce_ms = BOARD_SDMMC_SD_CARD_DETECT_DEBOUNCE_DELAY_MS;
+    g_sd.usrParam.cd->cardDetected = sd_storage_card_detected;
+
+    // SD_Init (via f_mount) polls for insertion forever, so check first
+    if (!sd_storage_card_detected()) {
+        return false;
+    }
+#if SECTOR_CACHE_ENTRIES > 0
+    sector_cache_attach(SDDISK, sd_fs.win);  // Before the mount reads the boot sector into it
+#endif
+    sd_mounted = (f_mount(&sd_fs, SD_STORAGE_DRIVE, 1U) == FR_OK);
+    return sd_mounted;
+}
+
+bool sd_storage_ready(void) {
+    return sd_mounted;
+}
+
+static sd_clmt_t *sd_clmt_take(FIL *fp) {
+    for (uint32_t i = 0; i < SD_STORAGE_CLMT_POOL; i++) {
+        if (sd_clmt_pool[i].owner == NULL) {
+            sd_clmt_pool[i].owner = fp;
+            return &sd_clmt_pool[i];
+        }
+    }
+    return NULL;
+}
+
+static void sd_clmt_give(FIL *fp) {
+    for (uint32_t i = 0; i < SD_STORAGE_CLMT_POOL; i++) {
+        if (sd_clmt_pool[i].owner == fp) {
+            sd_clmt_pool[i].owner = NULL;
+        }
+    }
+}
+
+FRESULT sd_storage_open(FIL *fp, const char *path, DWORD *clmt, UINT clmt_words) {
+    FRESULT res = f_open(fp, path, FA_READ);
+    if (res != FR_OK) {
+        return res;
+    }
+    if (clmt == NULL) {
+        sd_clmt_t *pooled = sd_clmt_take(fp);
+        if (pooled != NULL) {
+            clmt = pooled->map;
+            clmt_words = SD_STORAGE_CLMT_WORDS;
+        }
+    }
+    if (clmt != NULL && clmt_words >= SD_CLMT_MIN_WORDS) {
+        // Walks the whole chain once; FR_NOT_ENOUGH_CORE leaves the file as
+        // it was, and clmt[0] says how many words it would have taken
+        clmt[0] = clmt_words;
+        fp->cltbl = clmt;
+        res = f_lseek(fp, CREATE_LINKMAP);
+        if (res == FR_OK) {
+            sd_clmt_mapped++;
+            return FR_OK;
+        }
+        fp->cltbl = NULL;
+        if (res != FR_NOT_ENOUGH_CORE) {
+            (void)sd_storage_close(fp);
+            return res;
+        }
+    }
+    sd_clmt_give(fp);
+    sd_clmt_unmapped++;
+    return FR_OK;
+}
+
+FRESULT sd_storage_close(FIL *fp) {
+    sd_clmt_give(fp);
+    return f_close(fp);
+}
+
+#if defined(RAM_DISK_ENABLE)
+// Seek benchmark on the RAM disk ("0:", fsl_ram_disk.c): no bus time, so
+// what is left is the FAT walk the link map saves. One-sector clusters
+// give the longest chains the 64 KB disk can hold.
+#define SD_BENCH_DRIVE  "0:"
+#define SD_BENCH_PATH   SD_BENCH_DRIVE "/seek.bin"
+#define SD_BENCH_REPEAT 16U
+
+static const uint32_t sd_bench_sizes_kb[] = {4U, 16U, 32U, 56U};
+
+static FATFS sd_bench_fs;
+static BYTE sd_bench_buffer[FF_MAX_SS];  // f_mkfs() work area, then file data
+
+static bool sd_bench_format(void) {
+    static const MKFS_PARM opt = {FM_FAT | FM_SFD, 1U, 1U, 16U, FF_MAX_SS};
+    return f_mkfs(SD_BENCH_DRIVE, &opt, sd_bench_buffer, sizeof(sd_bench_buffer)) == FR_OK &&
+           f_mount(&sd_bench_fs, SD_BENCH_DRIVE, 1U) == FR_OK;
+}
+
+static bool sd_bench_write(uint32_t size) {
+    FIL file;
+    if (f_open(&file, SD_BENCH_PATH, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+        return false;
+    }
+    bool ok = true;
+    for (uint32_t left = size; left != 0U && ok;) {
+        UINT chunk = MIN(left, sizeof(sd_bench_buffer));
+        UINT done = 0U;
+        ok = (f_write(&file, sd_bench_buffer, chunk, &done) == FR_OK && done == chunk);
+        left -= chunk;
+    }
+    return (f_close(&file) == FR_OK) && ok;
+}
+
+// Cycles for a seek from the start to the last byte and a 1-byte read
+// there, averaged; 0 if anything failed
+static uint32_t sd_bench_seek(FIL *fp) {
+    uint32_t total = 0U;
+    for (uint32_t i = 0; i < SD_BENCH_REPEAT; i++) {
+        BYTE byte;
+        UINT got = 0U;
+        if (f_lseek(fp, 0U) != FR_OK) {
+            return 0U;
+        }
+        uint32_t start = cycle_counter_now();
+        FRESULT res = f_lseek(fp, f_size(fp) - 1U);
+        if (res == FR_OK) {
+            res = f_read(fp, &byte, 1U, &got);
+        }
+        total += cycle_counter_now() - start;
+        if (res != FR_OK || got != 1U) {
+            return 0U;
+        }
+    }
+    return total / SD_BENCH_REPEAT;
+}
+
+static void sd_bench_run(void) {
+    if (!sd_bench_format()) {
+        PRINTF("[SD] Seek benchmark: RAM disk format failed\r\n");
+        return;
+    }
+    uint32_t mhz = SystemCoreClock / 1000000U;
+    PRINTF("[SD] Seek to end + 1-byte read, RAM disk, %lu-byte clusters, %lu MHz:\r\n", (uint32_t)FF_MAX_SS, mhz);
+    PRINTF("[SD]   File   FAT walk  Link map  (cycles)\r\n");
+    for (uint32_t i = 0; i < ARRAY_SIZE(sd_bench_sizes_kb); i++) {
+        uint32_t size = sd_bench_sizes_kb[i] * 1024U;
+        DWORD map[8];  // 3 fragments: allocation resumes after the last file and wraps
+        FIL file;
+        uint32_t plain = 0U;
+        uint32_t mapped = 0U;
+
+        if (!sd_bench_write(size)) {
+            PRINTF("[SD] %4lu KB  write failed\r\n", sd_bench_sizes_kb[i]);
+            break;
+        }
+        if (f_open(&file, SD_BENCH_PATH, FA_READ) == FR_OK) {
+            plain = sd_bench_seek(&file);
+            (void)f_close(&file);
+        }
+        if (sd_storage_open(&file, SD_BENCH_PATH, map, ARRAY_SIZE(map)) == FR_OK) {
+            mapped = (file.cltbl != NULL) ? sd_bench_seek(&file) : 0U;
+            (void)sd_storage_close(&file);
+        }
+        PRINTF("[SD] %4lu KB  %8lu  %8lu\r\n", sd_bench_sizes_kb[i], plain, mapped);
+        (void)f_unlink(SD_BENCH_PATH);
+    }
+    (void)f_mount(NULL, SD_BENCH_DRIVE, 0U);
+}
+#endif /* RAM_DISK_ENABLE */
+
+void sd_storage_dump(void) {
+    uint32_t in_use = 0U;
+    for (uint32_t i = 0; i < SD_STORAGE_CLMT_POOL; i++) {
+        in_use += (sd_clmt_pool[i].owner != NULL) ? 1U : 0U;
+    }
+    PRINTF("[SD] Card %s, link maps %lu/%lu in use, %lu opens mapped, %lu walked the FAT\r\n",
+           sd_mounted ? "mounted" : "not mounted", in_use, (uint32_t)SD_STORAGE_CLMT_POOL, sd_clmt_mapped,
+           sd_clmt_unmapped);
+#if SECTOR_CACHE_ENTRIES > 0
+    sector_cache_stats_t cache;
+    sector_cache_get_stats(&cache);
+    PRINTF("[SD] Sector cache (%lu): %lu hits, %lu misses, %lu writes held, %lu written back\r\n",
+           (uint32_t)SECTOR_CACHE_ENTRIES, cache.hits, cache.misses, cache.absorbed, cache.writebacks);
+    PRINTF("[SD] Medium: %lu sectors read, %lu written\r\n", cache.reads, cache.writes);
+#endif
+    sd_async_stats_t async;
+    sd_async_get_stats(&async);
+    PRINTF("[SD] Background: %lu reads, %lu writes in %lu commands, %lu bytes, %lu errors, %lu finished for FatFs%s\r\n",
+           async.reads, async.writes, async.runs, async.bytes, async.errors, async.waited,
+           sd_async_busy() ? " (one in flight)" : "");
+#if defined(RAM_DISK_ENABLE)
+    sd_bench_run();
+#endif
+}
@@ -0,0 +1,61 @@
+/*
+ * SEH500 Project - SD card storage
+ *
+ * Brings up the SDHC host and mounts the card's FAT volume as drive "2:"
+ * (SDDISK in diskio.c). Card detect is the PTB20 GPIO, polled once at
+ * mount time so a missing card is reported instead of blocking boot.
+ *
+ * The SDHC bus clock is divided from the core clock captured here, so
+ * card access happens in the clock mode the card was mounted in (HSRUN):
+ * clients hold CLOCK_CLIENT_SD or CLOCK_CLIENT_AUDIO while reading.
+ *
+ * Files streamed from the card are opened with sd_storage_open(), which
+ * puts them in FatFs fast-seek mode: the cluster chain is read from the
+ * FAT once, into a cluster link map (CLMT), and every later seek and
+ * cluster crossing is looked up in the map instead of walking the FAT,
+ * so a seek costs the same anywhere in a file of any length. A file too
+ * fragmented for its map just opens in the usual mode.
+ *
+ * The volume's FAT and directory sectors are cached under the disk layer
+ * (sector_cache.h), attached to the volume's window before it is mounted.
+ * Mapped files can also be read and written without blocking
+ * (sd_async.h).
+ */
+
+#ifndef SD_STORAGE_H_
+#define SD_STORAGE_H_
+
+#include <stdbool.h>
+#include "ff.h"
+
+// Drive prefix for paths on the card, e.g. SD_STORAGE_DRIVE "/water.wav"
+#define SD_STORAGE_DRIVE "2:"
+
+// Mount the card (call before clock_mode_init, while the boot clocks run).
+// Returns false if no card is inserted or it has no FAT volume.
+bool sd_storage_init(void);
+
+// True once a volume is mounted
+bool sd_storage_ready(void);
+
+// Cluster link maps: DWORDs per pooled map (2 per fragment + 1, so 31
+// fragments) and maps in the pool (every voice plus the clip bank)
+#define SD_STORAGE_CLMT_WORDS 64U
+#define SD_STORAGE_CLMT_POOL  4U
+
+// Open path for reading in fast-seek mode, mapping its clusters into clmt
+// (clmt_words DWORDs, kept until the file is closed) or, with clmt NULL,
+// a map from the pool. Falls back to a plain open when the map is too
+// small or the pool is empty. Returns the f_open() result.
+FRESULT sd_storage_open(FIL *fp, const char *path, DWORD *clmt, UINT clmt_words);
+
+// Close a file from sd_storage_open(), handing back its pooled map
+FRESULT sd_storage_close(FIL *fp);
+
+// Print link map use, sector cache and background transfer counters and,
+// in builds with SD_SEEK_BENCH defined (which adds the RAM disk, see
+// ffconf.h), format the RAM disk and time seeks with and without a map on
+// files of growing size
+void sd_storage_dump(void);
+
+#endif /* SD_STORAGE_H_ */
@@ -0,0 +1,183 @@
+/*
+ * SEH500 Project - Write-back sector cache under the FatFs disk layer
+ * See sector_cache.h
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "sector_cache.h"
+
+#if SECTOR_CACHE_ENTRIES > 0
+
+typedef struct {
+    bool valid;
+    bool dirty;
+    uint8_t drive;
+    uint32_t sector;
+    uint32_t used;  // sector_cache_clock at the last access; lowest is evicted
+    uint8_t data[SECTOR_CACHE_SIZE] __attribute__((aligned(4)));
+} sector_cache_entry_t;
+
+static sector_cache_entry_t sector_cache[SECTOR_CACHE_ENTRIES];
+static const uint8_t *sector_cache_windows[SECTOR_CACHE_DRIVES];
+static uint32_t sector_cache_clock;
+static sector_cache_stats_t sector_cache_stats;
+
+static bool sector_cache_window(uint8_t drive, const uint8_t *buf, uint32_t count) {
+    return count == 1U && drive < SECTOR_CACHE_DRIVES && buf != NULL && buf == sector_cache_windows[drive];
+}
+
+static sector_cache_entry_t *sector_cache_find(uint8_t drive, uint32_t sector) {
+    for (uint32_t i = 0; i < SECTOR_CACHE_ENTRIES; i++) {
+        sector_cache_entry_t *e = &sector_cache[i];
+        if (e->valid && e->drive == drive && e->sector == sector) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static int sector_cache_clean(sector_cache_entry_t *e) {
+    if (e->dirty) {
+        int res = sector_cache_media_write(e->drive, e->data, e->sector, 1U);
+        if (res != 0) {
+            return res;  // Stays dirty, so a later flush tries again
+        }
+        e->dirty = false;
+        sector_cache_stats.writebacks++;
+        sector_cache_stats.writes++;
+    }
+    return 0;
+}
+
+// A free entry, else the least recently used one written back first; NULL
+// if that write-back failed (res says why)
+static sector_cache_entry_t *sector_cache_victim(int *res) {
+    sector_cache_entry_t *victim = &sector_cache[0];
+    for (uint32_t i = 0; i < SECTOR_CACHE_ENTRIES; i++) {
+        sector_cache_entry_t *e = &sector_cache[i];
+        if (!e->valid) {
+            return e;
+        }
+        if ((int32_t)(e->used - victim->used) < 0) {
+            victim = e;
+        }
+    }
+    *res = sector_cache_clean(victim);
+    if (*res != 0) {
+        return NULL;
+    }
+    victim->valid = false;
+    return victim;
+}
+
+static void sector_cache_touch(sector_cache_entry_t *e, uint8_t drive, uint32_t sector) {
+    e->valid = true;
+    e->drive = drive;
+    e->sector = sector;
+    e->used = ++sector_cache_clock;
+}
+
+void sector_cache_attach(uint8_t drive, const uint8_t *window) {
+    if (drive >= SECTOR_CACHE_DRIVES) {
+        return;
+    }
+    for (uint32_t i = 0; i < SECTOR_CACHE_ENTRIES; i++) {
+        if (sector_cache[i].drive == drive) {
+            sector_cache[i].valid = false;
+            sector_cache[i].dirty = false;
+        }
+    }
+    sector_cache_windows[drive] = window;
+}
+
+int sector_cache_read(uint8_t drive, uint8_t *buf, uint32_t sector, uint32_t count) {
+    int res = 0;
+    if (!sector_cache_window(drive, buf, count)) {
+        res = sector_cache_media_read(drive, buf, sector, count);
+        if (res != 0) {
+            return res;
+        }
+        sector_cache_stats.reads += count;
+        // The medium is behind on sectors only the cache has written
+        for (uint32_t i = 0; i < SECTOR_CACHE_ENTRIES; i++) {
+            const sector_cache_entry_t *e = &sector_cache[i];
+            if (e->valid && e->dirty && e->drive == drive && e->sector - sector < count) {
+                memcpy(&buf[(e->sector - sector) * SECTOR_CACHE_SIZE], e->data, SECTOR_CACHE_SIZE);
+            }
+        }
+        return 0;
+    }
+
+    sector_cache_entry_t *e = sector_cache_find(drive, sector);
+    if (e != NULL) {
+        sector_cache_stats.hits++;
+    } else {
+        sector_cache_stats.misses++;
+        e = sector_cache_victim(&res);
+        if (e == NULL) {
+            return res;
+        }
+        res = sector_cache_media_read(drive, e->data, sector, 1U);
+        if (res != 0) {
+            return res;
+        }
+        sector_cache_stats.reads++;
+    }
+    sector_cache_touch(e, drive, sector);
+    memcpy(buf, e->data, SECTOR_CACHE_SIZE);
+    return 0;
+}
+
+int sector_cache_write(uint8_t drive, const uint8_t *buf, uint32_t sector, uint32_t count) {
+    int res = 0;
+    if (!sector_cache_window(drive, buf, count)) {
+        // Newer than any cached copy, dirty or not
+        for (uint32_t i = 0; i < SECTOR_CACHE_ENTRIES; i++) {
+            sector_cache_entry_t *e = &sector_cache[i];
+            if (e->valid && e->drive == drive && e->sector - sector < count) {
+                e->valid = false;
+                e->dirty = false;
+            }
+        }
+        res = sector_cache_media_write(drive, buf, sector, count);
+        if (res == 0) {
+            sector_cache_stats.writes += count;
+        }
+        return res;
+    }
+
+    sector_cache_entry_t *e = sector_cache_find(drive, sector);
+    if (e == NULL) {
+        e = sector_cache_victim(&res);
+        if (e == NULL) {
+            return res;
+        }
+    }
+    sector_cache_stats.absorbed++;
+    sector_cache_touch(e, drive, sector);
+    memcpy(e->data, buf, SECTOR_CACHE_SIZE);
+    e->dirty = true;
+    return 0;
+}
+
+int sector_cache_flush(uint8_t drive) {
+    int first = 0;
+    for (uint32_t i = 0; i < SECTOR_CACHE_ENTRIES; i++) {
+        sector_cache_entry_t *e = &sector_cache[i];
+        if (e->valid && e->drive == drive) {
+            int res = sector_cache_clean(e);
+            if (first == 0) {
+                first = res;
+            }
+        }
+    }
+    return first;
+}
+
+void sector_cache_get_stats(sector_cache_stats_t *stats) {
+    *stats = sector_cache_stats;
+}
+
+#endif /* SECTOR_CACHE_ENTRIES > 0 */
@@ -0,0 +1,66 @@
+/*
+ * SEH500 Project - Write-back sector cache under the FatFs disk layer
+ *
+ * FatFs keeps one sector of filesystem metadata at a time in its window
+ * (FATFS.win), so a workload that alternates between a FAT sector and a
+ * directory sector - appending to a file while looking up another, say -
+ * reads the same two sectors from the card over and over, and writes the
+ * window back each time it leaves a dirty one. disk_read() and disk_write()
+ * (diskio.c) pass through here, and single-sector transfers to or from a
+ * drive's window are served from SECTOR_CACHE_ENTRIES cached sectors:
+ * least recently used out first, dirty ones written back only when they
+ * are evicted or FatFs syncs (CTRL_SYNC). File data moves through FIL.buf
+ * or straight into the caller's buffer and is never cached, so streaming
+ * a clip cannot push the FAT out.
+ *
+ * Transfers that bypass the cache stay coherent with it: a read takes the
+ * cache's newer copy of any dirty sector it covers, a write replaces any
+ * cached copy. Without an attached window a drive is not cached at all.
+ *
+ * Plain C with no SDK header: the disk layer supplies the two medium
+ * functions, so tools/cache_replay.c runs the same code on the host.
+ */
+
+#ifndef SECTOR_CACHE_H_
+#define SECTOR_CACHE_H_
+
+#include <stdint.h>
+
+// Cached sectors (SECTOR_CACHE_SIZE bytes of RAM each); 0 compiles the cache out
+#ifndef SECTOR_CACHE_ENTRIES
+#define SECTOR_CACHE_ENTRIES 8U
+#endif
+
+#define SECTOR_CACHE_SIZE   512U  // FF_MAX_SS
+#define SECTOR_CACHE_DRIVES 6U    // Physical drive numbers in diskio.h
+
+typedef struct {
+    uint32_t hits;        // Window reads served from the cache
+    uint32_t misses;      // Window reads that went to the medium
+    uint32_t absorbed;    // Window writes held in the cache
+    uint32_t writebacks;  // Dirty sectors written out (eviction or sync)
+    uint32_t reads;       // Sectors read from the medium, cached or not
+    uint32_t writes;      // Sectors written to the medium, cached or not
+} sector_cache_stats_t;
+
+// Provided by the disk layer (diskio.c, or the replay tool on the host):
+// move whole sectors to and from the medium; 0 on success, else the error
+// handed back to FatFs
+int sector_cache_media_read(uint8_t drive, uint8_t *buf, uint32_t sector, uint32_t count);
+int sector_cache_media_write(uint8_t drive, const uint8_t *buf, uint32_t sector, uint32_t count);
+
+// Cache the drive's metadata: window is its FATFS.win (before f_mount), or
+// NULL to stop. Either way the drive's cached sectors are dropped, so flush
+// first if the volume was written.
+void sector_cache_attach(uint8_t drive, const uint8_t *window);
+
+// disk_read() / disk_write(): same arguments and result as the medium functions
+int sector_cache_read(uint8_t drive, uint8_t *buf, uint32_t sector, uint32_t count);
+int sector_cache_write(uint8_t drive, const uint8_t *buf, uint32_t sector, uint32_t count);
+
+// Write back the drive's dirty sectors (CTRL_SYNC)
+int sector_cache_flush(uint8_t drive);
+
+void sector_cache_get_stats(sector_cache_stats_t *stats);
+
+#endif /* SECTOR_CACHE_H_ */
@@ -0,0 +1,146 @@
+/*
+ * SEH500 Project - Software timer service
+ * See timer_service.h
+ */
+
+#include "timer_service.h"
+#include "fsl_common.h"
+#include "fsl_clock.h"
+#include "fsl_pit.h"
+
+// Longest single PIT load; longer waits just take an extra wake-up
+#define TIMER_SERVICE_MAX_LOAD_MS 10000U
+
+static timer_wheel_t timer_wheel;
+static uint32_t counts_per_ms = 0;      // PIT counts per wheel tick (bus clock / 1000)
+static uint32_t loaded_counts = 0;      // Counts in the current PIT period (0 = stopped)
+static uint32_t residual_counts = 0;    // Part of a tick already elapsed but not yet given to the wheel
+static volatile bool in_callback = false;
+
+// Give the wheel all time elapsed in the current PIT period (interrupts masked by caller)
+static void timer_service_sync(void) {
+    if (loaded_counts == 0U) {
+        return;
+    }
+    bool expired = (PIT_GetStatusFlags(PIT, TIMER_SERVICE_CHANNEL) & kPIT_TimerFlag) != 0U;
+    uint32_t count = PIT_GetCurrentTimerCount(PIT, TIMER_SERVICE_CHANNEL);
+    if (!expired && (PIT_GetStatusFlags(PIT, TIMER_SERVICE_CHANNEL) & kPIT_TimerFlag) != 0U) {
+        // Reloaded between the two reads - the count may be from either period
+        expired = true;
+        count = PIT_GetCurrentTimerCount(PIT, TIMER_SERVICE_CHANNEL);
+    }
+    uint32_t elapsed = loaded_counts - 1U - count;
+    if (expired) {
+        // The period expired while masked; account for it here instead of in the ISR
+        PIT_ClearStatusFlags(PIT, TIMER_SERVICE_CHANNEL, kPIT_TimerFlag);
+        elapsed += loaded_counts;
+    }
+    elapsed += residual_counts;
+    residual_counts = elapsed % counts_per_ms;
+    timer_wheel_advance(&timer_wheel, elapsed / counts_per_ms);
+}
+
+// Load the PIT with the time to the next deadline, or stop it if nothing is pending
+static void timer_service_reprogram(void) {
+    uint32_t ticks = timer_wheel_ticks_to_next(&timer_wheel);
+
+    PIT_StopTimer(PIT, TIMER_SERVICE_CHANNEL);
+    PIT_ClearStatusFlags(PIT, TIMER_SERVICE_CHANNEL, kPIT_TimerFlag);
+    if (ticks == TIMER_WHEEL_NO_EXPIRY) {
+        loaded_counts = 0;
+        residual_counts = 0;
+        return;
+    }
+    if (ticks > TIMER_SERVICE_MAX_LOAD_MS) {
+        ticks = TIMER_SERVICE_MAX_LOAD_MS;
+    }
+    // Part of the first tick has already passed; shorten the load so no time is lost
+    loaded_counts = (ticks * counts_per_ms) - residual_counts;
+    PIT_SetTimerPeriod(PIT, TIMER_SERVICE_CHANNEL, loaded_counts);
+    PIT_StartTimer(PIT, TIMER_SERVICE_CHANNEL);
+}
+
+void timer_service_init(void) {
+    pit_config_t pitConfig;
+
+    timer_wheel_init(&timer_wheel);
+    counts_per_ms = USEC_TO_COUNT(1000U, CLOCK_GetFreq(kCLOCK_BusClk));
+    loaded_counts = 0;
+    residual_counts = 0;
+
+    PIT_GetDefaultConfig(&pitConfig);
+    PIT_Init(PIT, &pitConfig);
+    PIT_EnableInterrupts(PIT, TIMER_SERVICE_CHANNEL, kPIT_TimerInterruptEnable);
+    EnableIRQ(PIT0_IRQn);
+}
+
+void timer_service_start(sw_timer_t *timer, uint32_t delay_ms, uint32_t period_ms,
+                         sw_timer_callback_t callback, void *arg) {
+    uint32_t primask = DisableGlobalIRQ();
+    if (!in_callback) {
+        timer_service_sync();  // Bring the wheel up to date before computing the expiry
+    }
+    timer_wheel_start(&timer_wheel, timer, delay_ms, period_ms, callback, arg);
+    if (!in_callback) {
+        timer_service_reprogram();  // The ISR reprograms once after all callbacks
+    }
+    EnableGlobalIRQ(primask);
+}
+
+void timer_service_stop(sw_timer_t *timer) {
+    uint32_t primask = DisableGlobalIRQ();
+    timer_wheel_cancel(&timer_wheel, timer);
+    // A later deadline than the one loaded is harmless: the wheel simply finds nothing due
+    EnableGlobalIRQ(primask);
+}
+
+uint32_t timer_service_now(void) {
+    uint32_t primask = DisableGlobalIRQ();
+    timer_service_sync();
+    uint32_t now = timer_wheel.now;
+    timer_service_reprogram();
+    EnableGlobalIRQ(primask);
+    return now;
+}
+
+uint32_t timer_service_ms_to_next(void) {
+    uint32_t primask = DisableGlobalIRQ();
+    uint32_t ticks = timer_wheel_ticks_to_next(&timer_wheel);
+    EnableGlobalIRQ(primask);
+    return ticks;
+}
+
+void timer_service_clock_changing(void) {
+    uint32_t primask = DisableGlobalIRQ();
+    timer_service_sync();
+    PIT_StopTimer(PIT, TIMER_SERVICE_CHANNEL);
+    PIT_ClearStatusFlags(PIT, TIMER_SERVICE_CHANNEL, kPIT_TimerFlag);
+    loaded_counts = 0;  // residual_counts is kept and rescaled below
+    EnableGlobalIRQ(primask);
+}
+
+void timer_service_clock_changed(void) {
+    uint32_t primask = DisableGlobalIRQ();
+    uint32_t new_counts_per_ms = USEC_TO_COUNT(1000U, CLOCK_GetFreq(kCLOCK_BusClk));
+    residual_counts = (uint32_t)(((uint64_t)residual_counts * new_counts_per_ms) / counts_per_ms);
+    counts_per_ms = new_counts_per_ms;
+    timer_service_reprogram();
+    EnableGlobalIRQ(primask);
+}
+
+// PIT Timer interrupt handler - fires only when the next software timer is due
+void PIT0_IRQHandler(void) {
+    if ((PIT_GetStatusFlags(PIT, TIMER_SERVICE_CHANNEL) & kPIT_TimerFlag) == 0U) {
+        return;  // Already accounted for by timer_service_sync()
+    }
+    PIT_ClearStatusFlags(PIT, TIMER_SERVICE_CHANNEL, kPIT_TimerFlag);
+
+    // The whole loaded period has elapsed
+    uint32_t elapsed = loaded_counts + residual_counts;
+    residual_counts = elapsed % counts_per_ms;
+    in_callback = true;
+    timer_wheel_advance(&timer_wheel, elapsed / counts_per_ms);
+    in_callback = false;
+    timer_service_reprogram();
+    SDK_ISR_EXIT_BARRIER;
+}
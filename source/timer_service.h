@@ -0,0 +1,42 @@
+/*
+ * SEH500 Project - Software timer service
+ *
+ * Runs a timer_wheel_t (1 ms ticks) on PIT channel 0 in tickless mode:
+ * the PIT is loaded with the time to the next deadline instead of firing
+ * at a fixed rate, and is stopped entirely when no timer is pending.
+ * Callbacks run in PIT0 interrupt context and must be short.
+ */
+
+#ifndef TIMER_SERVICE_H_
+#define TIMER_SERVICE_H_
+
+#include <stdint.h>
+#include "timer_wheel.h"
+
+#define TIMER_SERVICE_CHANNEL kPIT_Chnl_0
+
+// Initialize the PIT and the wheel (call once at boot)
+void timer_service_init(void);
+
+// Start (or restart) a timer: first expiry after delay_ms, then every
+// period_ms if period_ms != 0. Safe from the main loop and from callbacks.
+void timer_service_start(sw_timer_t *timer, uint32_t delay_ms, uint32_t period_ms,
+                         sw_timer_callback_t callback, void *arg);
+
+// Stop a timer (no effect if not active)
+void timer_service_stop(sw_timer_t *timer);
+
+// Milliseconds since timer_service_init()
+uint32_t timer_service_now(void);
+
+// Milliseconds until the next timer deadline, or TIMER_WHEEL_NO_EXPIRY
+uint32_t timer_service_ms_to_next(void);
+
+// Bus clock change bracket (clock mode manager, interrupts masked):
+// changing banks the time elapsed at the old rate and stops the PIT,
+// changed recomputes the counts per tick from the new bus clock and
+// restarts it. Time spent between the two calls is not counted.
+void timer_service_clock_changing(void);
+void timer_service_clock_changed(void);
+
+#endif /* TIMER_SERVICE_H_ */
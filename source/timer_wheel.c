@@ -0,0 +1,191 @@
+/*
+ * SEH500 Project - Hierarchical timer wheel
+ * See timer_wheel.h
+ *
+ * A timer whose expiry is `delta` ticks away lives at the lowest level whose
+ * span covers delta, in the slot selected by the matching bits of its
+ * absolute expiry. When the level-0 index wraps, the current slot of the
+ * next level up is cascaded: its timers are re-placed closer to level 0.
+ */
+
+#include <stddef.h>
+#include "timer_wheel.h"
+
+#define LEVEL_SHIFT(level) ((level) * TIMER_WHEEL_SLOT_BITS)
+#define SLOT_MASK          (TIMER_WHEEL_SLOTS - 1U)
+
+// Largest delta the top level can hold; longer timers are clamped and re-placed
+#define WHEEL_MAX_DELTA    ((1UL << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS)) - 1U)
+
+static void wheel_link(timer_wheel_t *wheel, sw_timer_t *timer, uint32_t level, uint32_t slot) {
+    sw_timer_t **head = &wheel->slots[level][slot];
+    timer->level = (uint8_t)level;
+    timer->slot = (uint8_t)slot;
+    timer->prev = NULL;
+    timer->next = *head;
+    if (*head != NULL) {
+        (*head)->prev = timer;
+    }
+    *head = timer;
+    wheel->occupied[level] |= (1UL << slot);
+}
+
+static void wheel_unlink(timer_wheel_t *wheel, sw_timer_t *timer) {
+    if (timer->prev != NULL) {
+        timer->prev->next = timer->next;
+    } else {
+        wheel->slots[timer->level][timer->slot] = timer->next;
+        if (timer->next == NULL) {
+            wheel->occupied[timer->level] &= ~(1UL << timer->slot);
+        }
+    }
+    if (timer->next != NULL) {
+        timer->next->prev = timer->prev;
+    }
+    timer->next = NULL;
+    timer->prev = NULL;
+}
+
+// Put an active timer into the slot for its expiry; delta must be >= 1
+static void wheel_place(timer_wheel_t *wheel, sw_timer_t *timer) {
+    uint32_t delta = timer->expires - wheel->now;
+    uint32_t expires = timer->expires;
+
+    if (delta > WHEEL_MAX_DELTA) {
+        // Park at the far end of the top level; it is re-placed when cascaded
+        delta = WHEEL_MAX_DELTA;
+        expires = wheel->now + WHEEL_MAX_DELTA;
+    }
+
+    uint32_t level = 0;
+    while ((level + 1U) < TIMER_WHEEL_LEVELS && delta >= (1UL << LEVEL_SHIFT(level + 1U))) {
+        level++;
+    }
+    wheel_link(wheel, timer, level, (expires >> LEVEL_SHIFT(level)) & SLOT_MASK);
+}
+
+void timer_wheel_init(timer_wheel_t *wheel) {
+    wheel->now = 0;
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        wheel->occupied[level] = 0;
+        for (uint32_t slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            wheel->slots[level][slot] = NULL;
+        }
+    }
+}
+
+void timer_wheel_start(timer_wheel_t *wheel, sw_timer_t *timer, uint32_t delay, uint32_t period,
+                       sw_timer_callback_t callback, void *arg) {
+    if (timer->active) {
+        wheel_unlink(wheel, timer);
+    }
+    timer->expires = wheel->now + ((delay == 0U) ? 1U : delay);
+    timer->period = period;
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->active = true;
+    wheel_place(wheel, timer);
+}
+
+void timer_wheel_cancel(timer_wheel_t *wheel, sw_timer_t *timer) {
+    if (timer->active) {
+        wheel_unlink(wheel, timer);
+        timer->active = false;
+    }
+}
+
+// Fire one due timer; periodic timers are re-armed before the callback so it may cancel them
+static void wheel_fire(timer_wheel_t *wheel, sw_timer_t *timer) {
+    if (timer->period != 0U) {
+        timer->expires += timer->period;
+        if ((int32_t)(timer->expires - wheel->now) <= 0) {
+            timer->expires = wheel->now + 1U;  // Callback overran a whole period - skip ahead
+        }
+        wheel_place(wheel, timer);
+    } else {
+        timer->active = false;
+    }
+    timer->callback(timer, timer->arg);
+}
+
+// Handle everything due exactly at wheel->now
+static void wheel_process_tick(timer_wheel_t *wheel) {
+    uint32_t now = wheel->now;
+
+    // Cascade from the top so re-placed timers land on already-processed levels
+    for (uint32_t level = TIMER_WHEEL_LEVELS - 1U; level > 0U; level--) {
+        if ((now & ((1UL << LEVEL_SHIFT(level)) - 1U)) != 0U) {
+            continue;  // Lower levels have not wrapped at this tick
+        }
+        uint32_t slot = (now >> LEVEL_SHIFT(level)) & SLOT_MASK;
+        sw_timer_t *list = wheel->slots[level][slot];
+        wheel->slots[level][slot] = NULL;
+        wheel->occupied[level] &= ~(1UL << slot);
+        while (list != NULL) {
+            sw_timer_t *timer = list;
+            list = timer->next;
+            timer->next = NULL;
+            timer->prev = NULL;
+            if (timer->expires == now) {
+                wheel_link(wheel, timer, 0U, now & SLOT_MASK);  // Due now - fire below
+            } else {
+                wheel_place(wheel, timer);
+            }
+        }
+    }
+
+    // Expire level 0 one timer at a time off the live slot, so a callback that
+    // cancels or restarts a timer due on this same tick unlinks it properly.
+    // Nothing re-armed lands back in this slot (delta is at least 1 tick).
+    uint32_t slot = now & SLOT_MASK;
+    sw_timer_t *timer;
+    while ((timer = wheel->slots[0][slot]) != NULL) {
+        wheel_unlink(wheel, timer);
+        wheel_fire(wheel, timer);
+    }
+}
+
+uint32_t timer_wheel_ticks_to_next(const timer_wheel_t *wheel) {
+    uint32_t best = TIMER_WHEEL_NO_EXPIRY;
+
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        uint32_t bits = wheel->occupied[level];
+        if (bits == 0U) {
+            continue;
+        }
+        uint32_t shift = LEVEL_SHIFT(level);
+        uint32_t index = (wheel->now >> shift) & SLOT_MASK;
+
+        // Rotate so bit 0 is the slot after the current one, then find the first set bit
+        uint32_t start = (index + 1U) & SLOT_MASK;
+        uint32_t rotated = (start == 0U) ? bits : ((bits >> start) | (bits << (TIMER_WHEEL_SLOTS - start)));
+        uint32_t distance = (uint32_t)__builtin_ctz(rotated) + 1U;  // 1..32 slots ahead
+
+        // Level 0 slots are single ticks; higher slots are reached at their boundary
+        uint32_t ticks;
+        if (level == 0U) {
+            ticks = distance;
+        } else {
+            uint32_t boundary = ((wheel->now >> shift) + distance) << shift;
+            ticks = boundary - wheel->now;
+        }
+        if (ticks < best) {
+            best = ticks;
+        }
+    }
+    return best;
+}
+
+void timer_wheel_advance(timer_wheel_t *wheel, uint32_t ticks) {
+    // Jump straight between points of interest instead of stepping every tick
+    while (ticks != 0U) {
+        uint32_t next = timer_wheel_ticks_to_next(wheel);
+        if (next > ticks) {
+            wheel->now += ticks;
+            return;
+        }
+        wheel->now += next;
+        ticks -= next;
+        wheel_process_tick(wheel);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * SEH500 Project - Hierarchical timer wheel
+ *
+ * Portable C (no hardware access) so the wheel can be driven by any clock.
+ * 5 levels x 32 slots cover 2^25 ticks; longer delays are re-queued on the
+ * way down. Timers are intrusive doubly linked nodes, so start and cancel
+ * are O(1), and finding the next deadline is O(levels) using slot bitmaps.
+ *
+ * Not thread safe: the owner (timer_service.c) serializes access.
+ */
+
+#ifndef TIMER_WHEEL_H_
+#define TIMER_WHEEL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TIMER_WHEEL_LEVELS     5U
+#define TIMER_WHEEL_SLOT_BITS  5U
+#define TIMER_WHEEL_SLOTS      (1U << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_NO_EXPIRY  UINT32_MAX  // Returned when no timer is pending
+
+typedef struct sw_timer sw_timer_t;
+typedef void (*sw_timer_callback_t)(sw_timer_t *timer, void *arg);
+
+// Timer node - owned by the caller, must stay valid while active
+struct sw_timer {
+    sw_timer_t *next;
+    sw_timer_t *prev;
+    uint32_t expires;              // Absolute expiry tick
+    uint32_t period;               // Reload in ticks (0 = one-shot)
+    sw_timer_callback_t callback;
+    void *arg;
+    uint8_t level;                 // Position in the wheel while active
+    uint8_t slot;
+    bool active;
+};
+
+typedef struct {
+    uint32_t now;                                           // Current tick
+    uint32_t occupied[TIMER_WHEEL_LEVELS];                  // Bit per non-empty slot
+    sw_timer_t *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+} timer_wheel_t;
+
+void timer_wheel_init(timer_wheel_t *wheel);
+
+// Arm `timer` to fire after `delay` ticks (0 is treated as 1), then every
+// `period` ticks if period != 0. Re-arming an active timer moves it.
+void timer_wheel_start(timer_wheel_t *wheel, sw_timer_t *timer, uint32_t delay, uint32_t period,
+                       sw_timer_callback_t callback, void *arg);
+
+// Disarm a timer (no effect if it is not active)
+void timer_wheel_cancel(timer_wheel_t *wheel, sw_timer_t *timer);
+
+// Move time forward by `ticks`, firing every timer that comes due in order
+void timer_wheel_advance(timer_wheel_t *wheel, uint32_t ticks);
+
+// Ticks from now until the wheel next needs attention (a timer expiry or a
+// cascade of a higher level), or TIMER_WHEEL_NO_EXPIRY if it is empty
+uint32_t timer_wheel_ticks_to_next(const timer_wheel_t *wheel);
+
+#endif /* TIMER_WHEEL_H_ */
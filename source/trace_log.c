@@ -0,0 +1,111 @@
+/*
+ * SEH500 Project - Binary trace logging
+ * See trace_log.h for the wire format
+ */
+
+#include "trace_log.h"
+
+#if TRACE_LOG_BINARY
+
+#include "board.h"
+#include "fsl_common.h"
+#include "fsl_uart.h"
+#include "cycle_counter.h"
+
+#define TRACE_RING_MASK   (TRACE_RING_SIZE - 1U)
+#define TRACE_HEADER_SIZE 7U
+
+#if (TRACE_RING_SIZE & TRACE_RING_MASK) != 0U
+#error "TRACE_RING_SIZE must be a power of two"
+#endif
+
+// Argument count per message, generated from the same table the decoder uses
+static const uint8_t trace_arg_count[MSG_COUNT] = {
+#define TRACE_MESSAGE_NARGS(id, nargs, fmt) nargs,
+    TRACE_MESSAGES(TRACE_MESSAGE_NARGS)
+#undef TRACE_MESSAGE_NARGS
+};
+
+static uint8_t trace_ring[TRACE_RING_SIZE];
+static volatile uint32_t trace_head = 0;  // Next byte to write
+static volatile uint32_t trace_tail = 0;  // Next byte to send
+static volatile uint32_t trace_lost = 0;  // Records dropped because the ring was full
+
+static inline void trace_put_u32(uint32_t pos, uint32_t value) {
+    trace_ring[pos & TRACE_RING_MASK] = (uint8_t)value;
+    trace_ring[(pos + 1U) & TRACE_RING_MASK] = (uint8_t)(value >> 8);
+    trace_ring[(pos + 2U) & TRACE_RING_MASK] = (uint8_t)(value >> 16);
+    trace_ring[(pos + 3U) & TRACE_RING_MASK] = (uint8_t)(value >> 24);
+}
+
+void trace_log_write(trace_msg_id_t id, uint32_t a0, uint32_t a1, uint32_t a2) {
+    uint32_t args[TRACE_MAX_ARGS] = {a0, a1, a2};
+    uint32_t timestamp = cycle_counter_us();  // Real time across clock switches, unlike raw cycles
+
+    // The table is authoritative - the decoder reads exactly this many arguments
+    if ((uint32_t)id >= MSG_COUNT) {
+        return;
+    }
+    uint32_t nargs = trace_arg_count[id];
+    uint32_t size = TRACE_HEADER_SIZE + (4U * nargs);
+
+    // Writers may be the main loop or an ISR, so reserve space with interrupts masked
+    uint32_t primask = DisableGlobalIRQ();
+    uint32_t head = trace_head;
+    if ((TRACE_RING_SIZE - (head - trace_tail)) < size) {
+        trace_lost++;
+        EnableGlobalIRQ(primask);
+        return;
+    }
+
+    trace_ring[head & TRACE_RING_MASK] = TRACE_SYNC_BYTE;
+    trace_ring[(head + 1U) & TRACE_RING_MASK] = (uint8_t)id;
+    trace_ring[(head + 2U) & TRACE_RING_MASK] = (uint8_t)((uint32_t)id >> 8);
+    trace_put_u32(head + 3U, timestamp);
+    for (uint32_t i = 0; i < nargs; i++) {
+        trace_put_u32(head + TRACE_HEADER_SIZE + (4U * i), args[i]);
+    }
+    trace_head = head + size;
+    EnableGlobalIRQ(primask);
+}
+
+void trace_log_flush(void) {
+    UART_Type *uartBase = (UART_Type *)BOARD_DEBUG_UART_BASEADDR;
+
+    // Report losses in-band so the decoder shows gaps in the log
+    if (trace_lost != 0U) {
+        uint32_t lost = trace_lost;
+        trace_lost = 0;
+        trace_log_write(MSG_TRACE_OVERFLOW, lost, 0U, 0U);
+    }
+
+    while (trace_tail != trace_head) {
+        // Send the largest contiguous span up to the ring wrap point
+        uint32_t tail = trace_tail;
+        uint32_t offset = tail & TRACE_RING_MASK;
+        uint32_t count = trace_head - tail;
+        if (count > (TRACE_RING_SIZE - offset)) {
+            count = TRACE_RING_SIZE - offset;
+        }
+        (void)UART_WriteBlocking(uartBase, &trace_ring[offset], count);
+        trace_tail = tail + count;
+    }
+}
+
+#else
+
+// Format strings for text mode, generated from the message table
+static const char *const trace_formats[MSG_COUNT] = {
+#define TRACE_MESSAGE_FORMAT(id, nargs, fmt) fmt,
+    TRACE_MESSAGES(TRACE_MESSAGE_FORMAT)
+#undef TRACE_MESSAGE_FORMAT
+};
+
+const char *trace_log_format(trace_msg_id_t id) {
+    if ((uint32_t)id >= MSG_COUNT) {
+        return "";
+    }
+    return trace_formats[id];
+}
+
+#endif /* TRACE_LOG_BINARY */
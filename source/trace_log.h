@@ -0,0 +1,60 @@
+/*
+ * SEH500 Project - Binary trace logging
+ *
+ * LOG0..LOG3 replace runtime PRINTFs. With TRACE_LOG_BINARY set to 1 they
+ * record [sync][id][timestamp][args] into a RAM ring which the main loop
+ * streams over UART0; tools/trace_decode rebuilds the text on the host.
+ * With TRACE_LOG_BINARY set to 0 they fall back to PRINTF with the same text.
+ *
+ * Wire format (little-endian, 7 + 4*nargs bytes):
+ *   0xA5 | id (16-bit) | timestamp (32-bit) | nargs x 32-bit arguments
+ * The timestamp is cycle_counter_us(): microseconds of running core time,
+ * which stay in step when the clock mode manager switches the core clock
+ * (raw cycle counts would need the clock in force at each record). The
+ * argument count is not sent - both sides take it from trace_messages.h.
+ */
+
+#ifndef TRACE_LOG_H_
+#define TRACE_LOG_H_
+
+#include <stdint.h>
+#include "trace_messages.h"
+
+#ifndef TRACE_LOG_BINARY
+#define TRACE_LOG_BINARY 0  // 1 = binary records over UART0, 0 = formatted PRINTF
+#endif
+
+#define TRACE_SYNC_BYTE   0xA5U
+#define TRACE_RING_SIZE   512U  // Bytes of RAM buffering (power of two)
+#define TRACE_MAX_ARGS    3U
+
+#if TRACE_LOG_BINARY
+
+// Record a message; safe from the main loop and from interrupt context
+void trace_log_write(trace_msg_id_t id, uint32_t a0, uint32_t a1, uint32_t a2);
+
+// Stream buffered records to UART0 (call from the main loop)
+void trace_log_flush(void);
+
+#define LOG0(id)             trace_log_write((id), 0U, 0U, 0U)
+#define LOG1(id, a)          trace_log_write((id), (uint32_t)(a), 0U, 0U)
+#define LOG2(id, a, b)       trace_log_write((id), (uint32_t)(a), (uint32_t)(b), 0U)
+#define LOG3(id, a, b, c)    trace_log_write((id), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c))
+
+#else
+
+#include "fsl_debug_console.h"
+
+// Format string for a message ID (text mode)
+const char *trace_log_format(trace_msg_id_t id);
+
+#define trace_log_flush()    ((void)0)
+
+#define LOG0(id)             PRINTF(trace_log_format(id))
+#define LOG1(id, a)          PRINTF(trace_log_format(id), (a))
+#define LOG2(id, a, b)       PRINTF(trace_log_format(id), (a), (b))
+#define LOG3(id, a, b, c)    PRINTF(trace_log_format(id), (a), (b), (c))
+
+#endif /* TRACE_LOG_BINARY */
+
+#endif /* TRACE_LOG_H_ */
@@ -0,0 +1,47 @@
+/*
+ * SEH500 Project - Trace message table
+ *
+ * Every runtime log line is listed here once as X(ID, NUM_ARGS, "format").
+ * The target only sends the ID and raw 32-bit arguments; tools/trace_decode.c
+ * includes this same header, so the format strings are extracted at build time
+ * and the text is rebuilt on the host.
+ * Append new messages at the end - IDs are the position in this list, so
+ * messages no longer logged stay where they are for older logs to decode.
+ */
+
+#ifndef TRACE_MESSAGES_H_
+#define TRACE_MESSAGES_H_
+
+#define TRACE_MESSAGES(X)                                                                         \
+    X(MSG_BUTTON_SW2, 0, "[BUTTON PRESS] SW2 pressed!\r\n")                                       \
+    X(MSG_BUTTON_SW3, 0, "[BUTTON PRESS] SW3 pressed!\r\n")                                       \
+    X(MSG_KEY_WATER, 0, "[KEYBOARD] 'W' pressed - Water alert\r\n")                               \
+    X(MSG_KEY_WASHROOM, 0, "[KEYBOARD] 'T' pressed - Washroom alert\r\n")                         \
+    X(MSG_KEY_IGNORED, 2, "[KEYBOARD] Received: '%c' (0x%02X) - ignored\r\n")                     \
+    X(MSG_WATER_CANCELLED, 0, "Water alert cancelled (LED flicker OFF)\r\n")                      \
+    X(MSG_WATER_STARTED, 0, "Water alert started (Green LED flicker ON)\r\n")                     \
+    X(MSG_WASHROOM_CANCELLED, 0, "Washroom alert cancelled (LED flicker OFF)\r\n")                \
+    X(MSG_WASHROOM_STARTED, 0, "Washroom alert started (Red LED flicker ON)\r\n")                 \
+    X(MSG_SWITCH_TO_WATER, 0, "Cancelled washroom alert, starting water alert\r\n")               \
+    X(MSG_SWITCH_TO_WASHROOM, 0, "Cancelled water alert, starting washroom alert\r\n")            \
+    X(MSG_EVENTS_DROPPED, 1, "[EVENT] WARNING: %lu event(s) dropped (queue full)\r\n")            \
+    X(MSG_TRACE_OVERFLOW, 1, "[TRACE] WARNING: %lu record(s) lost (trace ring full)\r\n")       \
+    X(MSG_ALERT_IGNORED, 1, "Alert %u ignored (higher priority alert active)\r\n")                \
+    X(MSG_AUDIO_STARTED, 3, "[AUDIO] Playing %lu Hz, %lu channel(s), %lu ms\r\n")                \
+    X(MSG_AUDIO_FINISHED, 0, "[AUDIO] Clip finished\r\n")                                         \
+    X(MSG_AUDIO_UNDERRUN, 1, "[AUDIO] WARNING: underrun %lu (SD read slower than playback)\r\n")  \
+    X(MSG_AUDIO_ERROR, 1, "[AUDIO] Clip not played (stage %lu: 1=open 2=header 3=format 4=rate 5=seek 6=codec 7=prime)\r\n") \
+    X(MSG_ALERT_VOLUME, 2, "Alert %lu volume %lu/10\r\n")                                       \
+    X(MSG_AUDIO_CODEC_READY, 0, "[AUDIO] Codec powered up\r\n")                                    \
+    X(MSG_AUDIO_CODEC_FAILED, 1, "[AUDIO] Codec power-up failed (burst at register 0x%02lX)\r\n") \
+    X(MSG_ALERT_SWITCHED, 2, "Cancelled alert %lu, starting alert %lu\r\n")
+
+// Message IDs (16-bit on the wire)
+typedef enum {
+#define TRACE_MESSAGE_ID(id, nargs, fmt) id,
+    TRACE_MESSAGES(TRACE_MESSAGE_ID)
+#undef TRACE_MESSAGE_ID
+    MSG_COUNT
+} trace_msg_id_t;
+
+#endif /* TRACE_MESSAGES_H_ */
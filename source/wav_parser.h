@@ -0,0 +1,44 @@
+/*
+ * SEH500 Project - WAV header parser (wav_parser.s)
+ *
+ * The assembly routines fill wav_info_t by fixed offsets, so the field
+ * order and sizes here must match the stores in wav_parser.s.
+ */
+
+#ifndef WAV_PARSER_H_
+#define WAV_PARSER_H_
+
+#include <stdint.h>
+
+// Canonical 44-byte header: RIFF/WAVE, "fmt " at 12, "data" at 36
+#define WAV_HEADER_SIZE 44U
+
+typedef struct {
+    uint16_t audioFormat;    // 1 = PCM, 0x11 = IMA ADPCM (4-bit, blockAlign-byte blocks)
+    uint16_t numChannels;
+    uint32_t sampleRate;
+    uint32_t byteRate;
+    uint16_t blockAlign;     // Bytes per sample frame, all channels
+    uint16_t bitsPerSample;
+    uint32_t dataSize;       // Bytes of sample data
+    uint32_t dataOffset;     // File offset of the first sample
+} wav_info_t;
+
+// Validate a canonical header and fill info. Returns 0 if valid, -1 if not.
+int parse_wav_header(const uint8_t *buffer, wav_info_t *info);
+
+// Clip length in milliseconds from dataSize and byteRate
+uint32_t calculate_audio_duration(const wav_info_t *info);
+
+// 0 if the clip is 16-bit at the given rate and channel count, -1 if not
+int validate_wav_format(const wav_info_t *info, uint32_t sample_rate, uint32_t channels);
+
+// wav_chunk_lookup() results other than a table index
+#define WAV_CHUNK_UNKNOWN (-1)  // Valid ID, not in the table
+#define WAV_CHUNK_BAD_ID  (-2)  // Not four printable ASCII characters
+
+// Index of fourcc in table[0..count), checking first that it is a legal
+// chunk ID. Four IDs per load and SIMD byte-range checks on the M4.
+int wav_chunk_lookup(uint32_t fourcc, const uint32_t *table, uint32_t count);
+
+#endif /* WAV_PARSER_H_ */
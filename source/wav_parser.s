@@ -189,3 +189,77 @@ validate_fail:
     mov r0, #-1             // Fail
     pop {r4-r5, pc}
 
+
+// wav_chunk_lookup(fourcc, table, count)
+// r0 = chunk ID as read little-endian from the stream
+// r1 = table of known IDs
+// r2 = number of table entries
+// Returns: r0 = table index, -1 if not in the table, -2 if not a legal ID
+// Called for every chunk header by wav_reader.c
+.global wav_chunk_lookup
+.type wav_chunk_lookup, %function
+wav_chunk_lookup:
+    push {r4-r7, lr}
+    mov r12, r1             // r12 = table start, for the index
+
+    // A legal ID is four printable ASCII bytes (0x20-0x7E). Checked for all
+    // four bytes at once with the SIMD adds: the GE flags hold one bit per byte.
+    ldr r3, =0x20202020
+    usub8 r4, r0, r3        // GE[n] set where byte n >= 0x20
+    mrs r4, APSR
+    ldr r3, =0x81818181
+    uadd8 r5, r0, r3        // GE[n] set where byte n >= 0x7F (carry out of the byte)
+    mrs r5, APSR
+    and r4, r4, #0x000F0000 // GE bits are APSR[19:16]
+    and r5, r5, #0x000F0000
+    cmp r4, #0x000F0000
+    bne lookup_bad_id
+    cmp r5, #0
+    bne lookup_bad_id
+
+    // Four entries per load
+lookup_block:
+    subs r2, r2, #4
+    blo lookup_tail
+    ldmia r1!, {r4-r7}
+    cmp r0, r4
+    beq lookup_hit4
+    cmp r0, r5
+    beq lookup_hit3
+    cmp r0, r6
+    beq lookup_hit2
+    cmp r0, r7
+    beq lookup_hit1
+    b lookup_block
+
+    // Up to three left over
+lookup_tail:
+    adds r2, r2, #4
+    beq lookup_miss
+lookup_tail_loop:
+    ldr r4, [r1], #4
+    cmp r0, r4
+    beq lookup_hit1
+    subs r2, r2, #1
+    bne lookup_tail_loop
+
+lookup_miss:
+    mov r0, #-1             // Return -1 = not in the table
+    pop {r4-r7, pc}
+
+lookup_bad_id:
+    mvn r0, #1              // Return -2 = not a chunk ID
+    pop {r4-r7, pc}
+
+    // r1 is past the matched word by 4 x the label number
+lookup_hit4:
+    sub r1, r1, #4
+lookup_hit3:
+    sub r1, r1, #4
+lookup_hit2:
+    sub r1, r1, #4
+lookup_hit1:
+    sub r1, r1, #4
+    sub r0, r1, r12
+    lsr r0, r0, #2          // Byte offset -> index
+    pop {r4-r7, pc}
@@ -0,0 +1,333 @@
+/*
+ * SEH500 Project - Streaming RIFF/WAVE chunk walker
+ * See wav_reader.h
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "wav_reader.h"
+#include "adpcm.h"
+#include "cycle_counter.h"
+
+#define WAV_FOURCC(a, b, c, d) \
+    ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+#define WAV_ID_RIFF            WAV_FOURCC('R', 'I', 'F', 'F')
+#define WAV_ID_WAVE            WAV_FOURCC('W', 'A', 'V', 'E')
+#define WAV_FORMAT_PCM         0x0001U
+#define WAV_FORMAT_EXTENSIBLE  0xFFFEU
+#define WAV_FMT_MIN_SIZE       16U
+#define WAV_CUE_POINT_SIZE     24U
+#define WAV_CUE_SAMPLE_OFFSET  20U   // dwSampleOffset within a cue point
+#define WAV_SIZE_UNKNOWN       0xFFFFFFFFU
+
+// Chunk IDs wav_chunk_lookup() recognises; order is the WAV_CHUNK_* index
+enum {
+    WAV_CHUNK_FMT = 0,
+    WAV_CHUNK_DATA,
+    WAV_CHUNK_CUE,
+    WAV_CHUNK_FACT,
+    WAV_CHUNK_LIST,
+    WAV_CHUNK_BEXT,
+    WAV_CHUNK_JUNK,
+    WAV_CHUNK_PAD,
+    WAV_CHUNK_COUNT
+};
+
+static const uint32_t wav_chunk_ids[WAV_CHUNK_COUNT] = {
+    WAV_FOURCC('f', 'm', 't', ' '), WAV_FOURCC('d', 'a', 't', 'a'), WAV_FOURCC('c', 'u', 'e', ' '),
+    WAV_FOURCC('f', 'a', 'c', 't'), WAV_FOURCC('L', 'I', 'S', 'T'), WAV_FOURCC('b', 'e', 'x', 't'),
+    WAV_FOURCC('J', 'U', 'N', 'K'), WAV_FOURCC('P', 'A', 'D', ' '),
+};
+
+typedef enum {
+    WAV_STATE_RIFF = 0,   // Collecting "RIFF" size "WAVE"
+    WAV_STATE_CHUNK,      // Collecting a chunk header
+    WAV_STATE_FMT,        // Collecting the fmt fields
+    WAV_STATE_CUE_COUNT,
+    WAV_STATE_CUE_POINT,
+    WAV_STATE_DONE,
+    WAV_STATE_INVALID,
+} wav_state_t;
+
+#define WAV_FLAG_FMT  0x01U
+#define WAV_FLAG_DATA 0x02U
+
+#if !defined(__arm__)
+// Portable reference for wav_parser.s (host builds)
+int wav_chunk_lookup(uint32_t fourcc, const uint32_t *table, uint32_t count) {
+    for (uint32_t i = 0; i < 4U; i++) {
+        uint32_t c = (fourcc >> (8U * i)) & 0xFFU;
+        if (c < 0x20U || c > 0x7EU) {
+            return WAV_CHUNK_BAD_ID;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (table[i] == fourcc) {
+            return (int)i;
+        }
+    }
+    return WAV_CHUNK_UNKNOWN;
+}
+#endif
+
+static uint16_t wav_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t wav_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void wav_collect(wav_reader_t *reader, wav_state_t state, uint32_t need) {
+    reader->state = state;
+    reader->need = need;
+    reader->have = 0U;
+}
+
+// Drop the rest of the current chunk and wait for the next header
+static void wav_next_chunk(wav_reader_t *reader) {
+    reader->skip += reader->chunk_left;
+    reader->chunk_left = 0U;
+    wav_collect(reader, WAV_STATE_CHUNK, 8U);
+}
+
+static void wav_next_cue(wav_reader_t *reader) {
+    if (reader->cues_left != 0U && reader->chunk_left >= WAV_CUE_POINT_SIZE) {
+        reader->chunk_left -= WAV_CUE_POINT_SIZE;
+        wav_collect(reader, WAV_STATE_CUE_POINT, WAV_CUE_POINT_SIZE);
+    } else {
+        wav_next_chunk(reader);
+    }
+}
+
+static wav_status_t wav_parse_fmt(wav_reader_t *reader) {
+    const uint8_t *f = reader->field;
+    wav_info_t *info = &reader->info;
+
+    info->audioFormat = wav_le16(&f[0]);
+    info->numChannels = wav_le16(&f[2]);
+    info->sampleRate = wav_le32(&f[4]);
+    info->byteRate = wav_le32(&f[8]);
+    info->blockAlign = wav_le16(&f[12]);
+    info->bitsPerSample = wav_le16(&f[14]);
+    // WAVE_FORMAT_EXTENSIBLE: the real format code opens the sub-format GUID
+    if (info->audioFormat == WAV_FORMAT_EXTENSIBLE && reader->need >= WAV_READER_FIELD_MAX) {
+        info->audioFormat = wav_le16(&f[24]);
+    }
+
+    uint32_t bytes = (info->bitsPerSample + 7U) / 8U;
+    bool pcm = (info->audioFormat == WAV_FORMAT_PCM) && bytes != 0U && bytes <= 4U &&
+               info->blockAlign == info->numChannels * bytes;
+    // IMA ADPCM: 4-bit codes in blocks that open with a header per channel
+    bool adpcm = (info->audioFormat == WAV_FORMAT_IMA_ADPCM) && info->bitsPerSample == 4U &&
+                 info->blockAlign > info->numChannels * ADPCM_HEADER_SIZE;
+    if ((!pcm && !adpcm) || info->numChannels == 0U || info->sampleRate == 0U) {
+        return WAV_STATUS_INVALID;
+    }
+    reader->flags |= WAV_FLAG_FMT;
+    wav_next_chunk(reader);
+    return WAV_STATUS_NEED_MORE;
+}
+
+static wav_status_t wav_parse_chunk(wav_reader_t *reader) {
+    uint32_t size = wav_le32(&reader->field[4]);
+    int chunk = wav_chunk_lookup(wav_le32(reader->field), wav_chunk_ids, WAV_CHUNK_COUNT);
+
+    if (chunk == WAV_CHUNK_BAD_ID) {
+        return WAV_STATUS_INVALID;  // Lost sync: a size was wrong or padding was missing
+    }
+    // Bodies are padded to an even length; clamp sizes that run past the RIFF list
+    uint32_t room = reader->riff_end - reader->pos;
+    reader->chunk_left = (size >= room) ? room : (size + (size & 1U));
+
+    switch (chunk) {
+        case WAV_CHUNK_FMT: {
+            if (size < WAV_FMT_MIN_SIZE || reader->chunk_left < WAV_FMT_MIN_SIZE) {
+                return WAV_STATUS_INVALID;
+            }
+            uint32_t need = (size < WAV_READER_FIELD_MAX) ? size : WAV_READER_FIELD_MAX;
+            reader->chunk_left -= need;
+            wav_collect(reader, WAV_STATE_FMT, need);
+            return WAV_STATUS_NEED_MORE;
+        }
+        case WAV_CHUNK_DATA:
+            if ((reader->flags & WAV_FLAG_FMT) == 0U) {
+                return WAV_STATUS_INVALID;  // fmt must come first
+            }
+            if ((reader->flags & WAV_FLAG_DATA) != 0U) {
+                break;  // Only the first data chunk is played
+            }
+            reader->info.dataOffset = reader->pos;
+            // Streaming writers leave the size at 0 or ~0 until they finish
+            if (size == 0U || size == WAV_SIZE_UNKNOWN || size > room) {
+                reader->info.dataSize = room;
+                reader->chunk_left = room;  // The samples run to the end of the list
+            } else {
+                reader->info.dataSize = size;
+            }
+            reader->flags |= WAV_FLAG_DATA;
+            wav_next_chunk(reader);
+            return WAV_STATUS_DATA;
+        case WAV_CHUNK_CUE:
+            if (size >= 4U && reader->chunk_left >= 4U) {
+                reader->chunk_left -= 4U;
+                wav_collect(reader, WAV_STATE_CUE_COUNT, 4U);
+                return WAV_STATUS_NEED_MORE;
+            }
+            break;
+        default:
+            break;
+    }
+    wav_next_chunk(reader);
+    return WAV_STATUS_NEED_MORE;
+}
+
+// A complete field is in reader->field; act on it and pick the next one
+static wav_status_t wav_parse_field(wav_reader_t *reader) {
+    const uint8_t *f = reader->field;
+
+    switch (reader->state) {
+        case WAV_STATE_RIFF: {
+            if (wav_le32(&f[0]) != WAV_ID_RIFF || wav_le32(&f[8]) != WAV_ID_WAVE) {
+                return WAV_STATUS_INVALID;
+            }
+            uint32_t size = wav_le32(&f[4]);
+            reader->riff_end = (size < 4U || size > (WAV_SIZE_UNKNOWN - 8U)) ? WAV_SIZE_UNKNOWN : (size + 8U);
+            wav_collect(reader, WAV_STATE_CHUNK, 8U);
+            return WAV_STATUS_NEED_MORE;
+        }
+        case WAV_STATE_CHUNK:
+            return wav_parse_chunk(reader);
+        case WAV_STATE_FMT:
+            return wav_parse_fmt(reader);
+        case WAV_STATE_CUE_COUNT:
+            reader->cue_count = wav_le32(f);
+            reader->cues_left = reader->cue_count;
+            wav_next_cue(reader);
+            return WAV_STATUS_NEED_MORE;
+        case WAV_STATE_CUE_POINT: {
+            uint32_t index = reader->cue_count - reader->cues_left;
+            if (index < WAV_MAX_CUES) {
+                reader->cue_points[index] = wav_le32(&f[WAV_CUE_SAMPLE_OFFSET]);
+            }
+            reader->cues_left--;
+            wav_next_cue(reader);
+            return WAV_STATUS_NEED_MORE;
+        }
+        default:
+            return WAV_STATUS_INVALID;
+    }
+}
+
+void wav_reader_init(wav_reader_t *reader) {
+    memset(reader, 0, sizeof(*reader));
+    reader->riff_end = WAV_SIZE_UNKNOWN;
+    wav_collect(reader, WAV_STATE_RIFF, 12U);
+}
+
+wav_status_t wav_reader_feed(wav_reader_t *reader, const uint8_t *data, uint32_t len, uint32_t *used) {
+    wav_status_t status = WAV_STATUS_NEED_MORE;
+    uint32_t i = 0;
+
+    while (status == WAV_STATUS_NEED_MORE) {
+        if (reader->state == WAV_STATE_DONE || reader->state == WAV_STATE_INVALID) {
+            status = (reader->state == WAV_STATE_DONE) ? WAV_STATUS_DONE : WAV_STATUS_INVALID;
+            break;
+        }
+        if (reader->skip != 0U) {
+            uint32_t n = len - i;
+            n = (reader->skip < n) ? reader->skip : n;
+            i += n;
+            reader->pos += n;
+            reader->skip -= n;
+            if (reader->skip != 0U) {
+                break;
+            }
+        }
+        if (reader->state == WAV_STATE_CHUNK && reader->have == 0U && reader->pos >= reader->riff_end) {
+            reader->state = WAV_STATE_DONE;
+            continue;
+        }
+        uint32_t n = reader->need - reader->have;
+        n = (n < (len - i)) ? n : (len - i);
+        memcpy(&reader->field[reader->have], &data[i], n);
+        reader->have += n;
+        reader->pos += n;
+        i += n;
+        if (reader->have < reader->need) {
+            break;
+        }
+        status = wav_parse_field(reader);
+        if (status == WAV_STATUS_INVALID) {
+            reader->state = WAV_STATE_INVALID;
+        }
+    }
+    if (used != NULL) {
+        *used = i;
+    }
+    return status;
+}
+
+uint32_t wav_reader_pending_skip(const wav_reader_t *reader) {
+    return reader->skip;
+}
+
+void wav_reader_skipped(wav_reader_t *reader, uint32_t n) {
+    n = (n < reader->skip) ? n : reader->skip;
+    reader->skip -= n;
+    reader->pos += n;
+}
+
+wav_status_t wav_reader_end(wav_reader_t *reader) {
+    uint8_t seen = WAV_FLAG_FMT | WAV_FLAG_DATA;
+    reader->state = ((reader->flags & seen) == seen) ? WAV_STATE_DONE : WAV_STATE_INVALID;
+    return (reader->state == WAV_STATE_DONE) ? WAV_STATUS_DONE : WAV_STATUS_INVALID;
+}
+
+// Little-endian helpers for the benchmark image
+#define WAV_B16(v) (uint8_t)(v), (uint8_t)((v) >> 8)
+#define WAV_B32(v) (uint8_t)(v), (uint8_t)((v) >> 8), (uint8_t)((v) >> 16), (uint8_t)((v) >> 24)
+
+// Extensible fmt, fact, odd-sized LIST with its pad byte, data, trailing cue chunk
+static const uint8_t wav_bench_image[] = {
+    'R', 'I', 'F', 'F', WAV_B32(4U + 48U + 12U + 22U + 16U + 60U), 'W', 'A', 'V', 'E',
+    'f', 'm', 't', ' ', WAV_B32(40U), WAV_B16(WAV_FORMAT_EXTENSIBLE), WAV_B16(2U), WAV_B32(22050U),
+    WAV_B32(88200U), WAV_B16(4U), WAV_B16(16U), WAV_B16(22U), WAV_B16(16U), WAV_B32(3U),
+    WAV_B16(WAV_FORMAT_PCM), 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71,
+    'f', 'a', 'c', 't', WAV_B32(4U), WAV_B32(2U),
+    'L', 'I', 'S', 'T', WAV_B32(13U), 'I', 'N', 'F', 'O', 'I', 'N', 'A', 'M', WAV_B32(1U), 'x', 0x00,
+    'd', 'a', 't', 'a', WAV_B32(8U), 0x01, 0x00, 0x02, 0x00, 0x03, 0x00, 0x04, 0x00,
+    'c', 'u', 'e', ' ', WAV_B32(52U), WAV_B32(2U),
+    WAV_B32(1U), WAV_B32(0U), 'd', 'a', 't', 'a', WAV_B32(0U), WAV_B32(0U), WAV_B32(0U),
+    WAV_B32(2U), WAV_B32(1U), 'd', 'a', 't', 'a', WAV_B32(0U), WAV_B32(0U), WAV_B32(1U),
+};
+
+uint32_t wav_reader_benchmark(uint32_t iterations) {
+    wav_reader_t reader;
+    wav_status_t status = WAV_STATUS_INVALID;
+    uint32_t start = cycle_counter_now();
+
+    for (uint32_t n = 0; n < iterations; n++) {
+        uint32_t offset = 0;
+        wav_reader_init(&reader);
+        do {
+            // 7-byte pieces split every header and field across calls
+            uint32_t used = 0;
+            uint32_t piece = sizeof(wav_bench_image) - offset;
+            piece = (piece < 7U) ? piece : 7U;
+            status = wav_reader_feed(&reader, &wav_bench_image[offset], piece, &used);
+            offset += used;
+        } while ((status == WAV_STATUS_NEED_MORE || status == WAV_STATUS_DATA) && offset < sizeof(wav_bench_image));
+        if (status == WAV_STATUS_NEED_MORE) {
+            status = wav_reader_end(&reader);
+        }
+    }
+    uint32_t cycles = cycle_counter_now() - start;
+
+    if (status != WAV_STATUS_DONE || reader.info.sampleRate != 22050U || reader.info.dataOffset != 102U ||
+        reader.info.dataSize != 8U || reader.cue_count != 2U || reader.cue_points[1] != 1U || iterations == 0U) {
+        return 0U;
+    }
+    return cycles / iterations;
+}
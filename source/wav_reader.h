@@ -0,0 +1,79 @@
+/*
+ * SEH500 Project - Streaming RIFF/WAVE chunk walker
+ *
+ * Replaces the fixed-offset parse_wav_header for real-world files: walks
+ * the RIFF chunk list in order, so LIST/INFO, fact, bext, junk and any
+ * other chunk can sit anywhere before "data", fmt may be longer than 16
+ * bytes (WAVE_FORMAT_EXTENSIBLE is reduced to its sub-format) and odd
+ * chunk sizes are padded as the spec requires. PCM and IMA-ADPCM (see
+ * adpcm.h) fmt chunks are accepted.
+ *
+ * Input is pushed in pieces of any size; the reader keeps at most one
+ * fixed-size field (a chunk header, the fmt fields or one cue point), so a
+ * clip never has to be in memory. Bodies it does not need are skipped: the
+ * caller can seek over wav_reader_pending_skip() bytes instead of reading
+ * them. Chunk IDs are matched by wav_chunk_lookup() in wav_parser.s.
+ *
+ * Results land in the same wav_info_t the assembly parser fills, with the
+ * real data offset and length, plus any cue point sample offsets.
+ */
+
+#ifndef WAV_READER_H_
+#define WAV_READER_H_
+
+#include <stdint.h>
+#include "wav_parser.h"
+
+// Cue points kept; later ones are counted but not stored
+#define WAV_MAX_CUES 8U
+
+// Longest fixed field collected at once (extensible fmt up to its sub-format)
+#define WAV_READER_FIELD_MAX 26U
+
+typedef enum {
+    WAV_STATUS_NEED_MORE = 0,  // Feed more bytes (or seek the pending skip)
+    WAV_STATUS_DATA,           // fmt and data chunk headers parsed, info is valid
+    WAV_STATUS_DONE,           // End of the RIFF list reached
+    WAV_STATUS_INVALID,        // Not a PCM or IMA-ADPCM RIFF/WAVE stream
+} wav_status_t;
+
+typedef struct {
+    wav_info_t info;
+    uint32_t cue_count;                 // Cue points in the file
+    uint32_t cue_points[WAV_MAX_CUES];  // Sample frame offsets of the first WAV_MAX_CUES
+    // Walker state
+    uint32_t state;
+    uint32_t pos;                       // Stream offset of the next byte fed
+    uint32_t riff_end;                  // Stream offset just past the RIFF list
+    uint32_t chunk_left;                // Body bytes of the current chunk still unparsed
+    uint32_t cues_left;
+    uint32_t skip;                      // Bytes to drop before the next field
+    uint32_t need;                      // Field length being collected
+    uint32_t have;
+    uint8_t field[WAV_READER_FIELD_MAX];
+    uint8_t flags;
+} wav_reader_t;
+
+// Start a new stream
+void wav_reader_init(wav_reader_t *reader);
+
+// Push len bytes that follow the ones already fed. Parsing stops early at
+// WAV_STATUS_DATA (feed again to walk on past the samples and pick up
+// trailing cue chunks); *used says how many bytes were taken.
+wav_status_t wav_reader_feed(wav_reader_t *reader, const uint8_t *data, uint32_t len, uint32_t *used);
+
+// Bytes the reader would only discard next; the caller may seek over them
+uint32_t wav_reader_pending_skip(const wav_reader_t *reader);
+
+// Tell the reader the caller seeked over n bytes (n <= pending skip)
+void wav_reader_skipped(wav_reader_t *reader, uint32_t n);
+
+// End of input: DONE if fmt and data were found (a file cut short after
+// its data header is still playable), INVALID if not
+wav_status_t wav_reader_end(wav_reader_t *reader);
+
+// Parse a built-in multi-chunk image fed in odd-sized pieces, iterations
+// times. Returns core cycles per parse, or 0 if the result was wrong.
+uint32_t wav_reader_benchmark(uint32_t iterations);
+
+#endif /* WAV_READER_H_ */
@@ -0,0 +1,278 @@
+/*
+ * SEH500 Project - Host-side IMA-ADPCM encoder
+ *
+ * Converts a 16-bit PCM WAV (mono or stereo, any rate) into a 4:1
+ * WAVE_FORMAT_IMA_ADPCM WAV that audio_player streams through
+ * source/adpcm.c. The output is a standard file (fmt with samplesPerBlock,
+ * fact with the true sample count), so it also plays on a PC.
+ *
+ * Every block is decoded again with the target's own adpcm_decode_block()
+ * and must match the encoder's reconstruction exactly; the SNR of the
+ * decoded clip against the input is printed.
+ *
+ * Build: gcc -O2 -Wall -I../source -o adpcm_encode adpcm_encode.c ../source/adpcm.c -lm
+ * Usage: ./adpcm_encode [-b block_align] in.wav out.wav
+ *        (run once per clip in audio/, keeping the file name for the SD card)
+ *
+ * The default block size is the usual 256 bytes per channel per whole
+ * multiple of 11.025 kHz (1024 bytes for 44.1 kHz mono, 2048 for 48 kHz
+ * stereo, the player's limit). Larger blocks waste less
+ * on headers; smaller ones start faster after a seek.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "adpcm.h"
+
+#define WAV_FORMAT_PCM 0x0001U
+
+// AUDIO_ADPCM_MAX_BLOCK in source/audio_player.c
+#define ADPCM_PLAYER_MAX_BLOCK 2048U
+
+typedef struct {
+    int32_t pred;
+    int32_t index;
+} encoder_channel_t;
+
+static uint32_t le16(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t le32(const uint8_t *p) {
+    return le16(p) | (le16(&p[2]) << 16);
+}
+
+static void put16(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, v);
+    put16(&p[2], v >> 16);
+}
+
+static uint8_t *read_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = (n > 0) ? malloc((size_t)n) : NULL;
+    if (buf != NULL && fread(buf, 1, (size_t)n, f) != (size_t)n) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    *size = (size_t)n;
+    return buf;
+}
+
+// Standard IMA quantiser; the state update mirrors adpcm_expand() in source/adpcm.c
+static uint32_t encode_sample(encoder_channel_t *ch, int32_t sample) {
+    int32_t step = adpcm_steps[ch->index];
+    int32_t delta = sample - ch->pred;
+    uint32_t code = 0U;
+
+    if (delta < 0) {
+        code = 8U;
+        delta = -delta;
+    }
+    int32_t diff = step >> 3;
+    if (delta >= step) {
+        code |= 4U;
+        delta -= step;
+        diff += step;
+    }
+    if (delta >= (step >> 1)) {
+        code |= 2U;
+        delta -= step >> 1;
+        diff += step >> 1;
+    }
+    if (delta >= (step >> 2)) {
+        code |= 1U;
+        diff += step >> 2;
+    }
+
+    int32_t pred = (code & 8U) ? (ch->pred - diff) : (ch->pred + diff);
+    ch->pred = (pred > INT16_MAX) ? INT16_MAX : (pred < INT16_MIN) ? INT16_MIN : pred;
+    int32_t index = ch->index + adpcm_index_adjust[code];
+    ch->index = (index < 0) ? 0 : (index > (int32_t)(ADPCM_STEP_COUNT - 1U)) ? (int32_t)(ADPCM_STEP_COUNT - 1U) : index;
+    return code;
+}
+
+// Encode frames [0, block_frames) of pcm (zero past 'have') into one block;
+// recon receives the encoder's own reconstruction for the exactness check
+static void encode_block(const int16_t *pcm, uint32_t have, uint32_t channels, uint32_t block_align,
+                         encoder_channel_t *state, uint8_t *out, int16_t *recon) {
+    uint32_t block_frames = ADPCM_BLOCK_FRAMES(block_align, channels);
+#define SAMPLE(f, c) (((f) < have) ? pcm[(f) * channels + (c)] : 0)
+
+    for (uint32_t c = 0; c < channels; c++) {
+        state[c].pred = SAMPLE(0U, c);
+        put16(&out[c * ADPCM_HEADER_SIZE], (uint16_t)(int16_t)state[c].pred);
+        out[c * ADPCM_HEADER_SIZE + 2U] = (uint8_t)state[c].index;
+        out[c * ADPCM_HEADER_SIZE + 3U] = 0U;
+        recon[c] = (int16_t)state[c].pred;
+    }
+    uint8_t *p = &out[channels * ADPCM_HEADER_SIZE];
+
+    if (channels == 1U) {
+        for (uint32_t f = 1U; f < block_frames; f += 2U, p++) {
+            uint32_t lo = encode_sample(&state[0], SAMPLE(f, 0U));
+            recon[f] = (int16_t)state[0].pred;
+            uint32_t hi = encode_sample(&state[0], SAMPLE(f + 1U, 0U));
+            recon[f + 1U] = (int16_t)state[0].pred;
+            *p = (uint8_t)(lo | (hi << 4));
+        }
+        return;
+    }
+    for (uint32_t f = 1U; f < block_frames; f += 8U, p += 8) {
+        for (uint32_t c = 0; c < 2U; c++) {
+            for (uint32_t i = 0; i < 4U; i++) {
+                uint32_t lo = encode_sample(&state[c], SAMPLE(f + 2U * i, c));
+                recon[2U * (f + 2U * i) + c] = (int16_t)state[c].pred;
+                uint32_t hi = encode_sample(&state[c], SAMPLE(f + 2U * i + 1U, c));
+                recon[2U * (f + 2U * i + 1U) + c] = (int16_t)state[c].pred;
+                p[4U * c + i] = (uint8_t)(lo | (hi << 4));
+            }
+        }
+    }
+#undef SAMPLE
+}
+
+int main(int argc, char **argv) {
+    uint32_t block_align = 0U;
+    int arg = 1;
+    if (argc > 2 && strcmp(argv[1], "-b") == 0) {
+        block_align = (uint32_t)strtoul(argv[2], NULL, 0);
+        arg = 3;
+    }
+    if (argc - arg != 2) {
+        fprintf(stderr, "usage: %s [-b block_align] in.wav out.wav\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t size = 0;
+    uint8_t *wav = read_file(argv[arg], &size);
+    if (wav == NULL || size < 12U || memcmp(wav, "RIFF", 4) != 0 || memcmp(&wav[8], "WAVE", 4) != 0) {
+        fprintf(stderr, "%s: not a RIFF/WAVE file\n", argv[arg]);
+        return EXIT_FAILURE;
+    }
+
+    // Walk the chunks for fmt and data
+    const uint8_t *fmt = NULL;
+    const uint8_t *data = NULL;
+    uint32_t data_size = 0U;
+    for (size_t pos = 12U; pos + 8U <= size;) {
+        uint32_t len = le32(&wav[pos + 4U]);
+        if (memcmp(&wav[pos], "fmt ", 4) == 0 && len >= 16U) {
+            fmt = &wav[pos + 8U];
+        } else if (memcmp(&wav[pos], "data", 4) == 0) {
+            data = &wav[pos + 8U];
+            data_size = (len > size - pos - 8U) ? (uint32_t)(size - pos - 8U) : len;
+        }
+        pos += 8U + (size_t)len + (len & 1U);
+    }
+    if (fmt == NULL || data == NULL || le16(&fmt[0]) != WAV_FORMAT_PCM || le16(&fmt[14]) != 16U ||
+        le16(&fmt[2]) == 0U || le16(&fmt[2]) > 2U) {
+        fprintf(stderr, "%s: need 16-bit PCM, mono or stereo\n", argv[arg]);
+        return EXIT_FAILURE;
+    }
+    uint32_t channels = le16(&fmt[2]);
+    uint32_t rate = le32(&fmt[4]);
+    if (block_align == 0U) {
+        uint32_t scale = rate / 11025U;
+        block_align = 256U * channels * ((scale == 0U) ? 1U : scale);
+    }
+    // Stereo blocks hold whole 8-byte groups after the headers
+    uint32_t unit = (channels == 1U) ? 1U : 8U;
+    if (block_align < channels * ADPCM_HEADER_SIZE + unit || (block_align - channels * ADPCM_HEADER_SIZE) % unit != 0U) {
+        fprintf(stderr, "block_align %u does not fit %u channel(s)\n", block_align, channels);
+        return EXIT_FAILURE;
+    }
+    if (block_align > ADPCM_PLAYER_MAX_BLOCK) {
+        fprintf(stderr, "block_align %u is larger than audio_player accepts (%u)\n", block_align,
+                ADPCM_PLAYER_MAX_BLOCK);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t frames = data_size / (2U * channels);
+    uint32_t block_frames = ADPCM_BLOCK_FRAMES(block_align, channels);
+    uint32_t blocks = (frames + block_frames - 1U) / block_frames;
+    int16_t *pcm = malloc((size_t)frames * channels * sizeof(int16_t) + 1U);
+    uint8_t *out = calloc((size_t)blocks * block_align, 1);
+    int16_t *recon = malloc((size_t)block_frames * channels * sizeof(int16_t));
+    int16_t *decoded = malloc((size_t)block_frames * channels * sizeof(int16_t));
+    if (pcm == NULL || out == NULL || recon == NULL || decoded == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    for (uint32_t i = 0; i < frames * channels; i++) {
+        pcm[i] = (int16_t)le16(&data[2U * i]);
+    }
+
+    encoder_channel_t state[2] = {{0, 0}, {0, 0}};
+    double signal = 0.0;
+    double noise = 0.0;
+    for (uint32_t b = 0; b < blocks; b++) {
+        uint32_t first = b * block_frames;
+        uint32_t have = frames - first;
+        uint8_t *block = &out[(size_t)b * block_align];
+
+        encode_block(&pcm[(size_t)first * channels], have, channels, block_align, state, block, recon);
+        if (adpcm_decode_block(block, block_align, channels, decoded) != block_frames ||
+            memcmp(decoded, recon, (size_t)block_frames * channels * sizeof(int16_t)) != 0) {
+            fprintf(stderr, "block %u: target decoder disagrees with the encoder\n", b);
+            return EXIT_FAILURE;
+        }
+        for (uint32_t i = 0; i < block_frames * channels && first * channels + i < frames * channels; i++) {
+            double ref = pcm[first * channels + i];
+            double err = decoded[i] - ref;
+            signal += ref * ref;
+            noise += err * err;
+        }
+    }
+
+    // RIFF, fmt (IMA ADPCM with samplesPerBlock), fact (true frame count), data
+    uint32_t out_size = blocks * block_align;
+    uint8_t header[60];
+    memcpy(&header[0], "RIFF", 4);
+    put32(&header[4], 52U + out_size + (out_size & 1U));
+    memcpy(&header[8], "WAVEfmt ", 8);
+    put32(&header[16], 20U);
+    put16(&header[20], WAV_FORMAT_IMA_ADPCM);
+    put16(&header[22], channels);
+    put32(&header[24], rate);
+    put32(&header[28], (uint32_t)(((uint64_t)rate * block_align) / block_frames));
+    put16(&header[32], block_align);
+    put16(&header[34], 4U);
+    put16(&header[36], 2U);
+    put16(&header[38], block_frames);
+    memcpy(&header[40], "fact", 4);
+    put32(&header[44], 4U);
+    put32(&header[48], frames);
+    memcpy(&header[52], "data", 4);
+    put32(&header[56], out_size);
+
+    FILE *f = fopen(argv[arg + 1], "wb");
+    static const uint8_t pad = 0U;
+    if (f == NULL || fwrite(header, 1, sizeof(header), f) != sizeof(header) ||
+        fwrite(out, 1, out_size, f) != out_size || ((out_size & 1U) && fwrite(&pad, 1, 1, f) != 1U)) {
+        fprintf(stderr, "%s: write failed\n", argv[arg + 1]);
+        return EXIT_FAILURE;
+    }
+    fclose(f);
+
+    printf("%s: %u Hz %u ch, %u frames, %u -> %u bytes (%.2f:1), block %u (%u frames), SNR %.1f dB\n",
+           argv[arg + 1], rate, channels, frames, data_size, out_size + (uint32_t)sizeof(header),
+           (double)data_size / (out_size + sizeof(header)), block_align, block_frames,
+           (noise > 0.0) ? 10.0 * log10(signal / noise) : 200.0);
+    return EXIT_SUCCESS;
+}
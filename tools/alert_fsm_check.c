@@ -0,0 +1,176 @@
+/*
+ * SEH500 Project - Host-side exhaustive check of the alert state machine
+ *
+ * Runs source/alert_fsm.c against a plain reference model of the rules in
+ * alert_fsm.h. For tables of 1 to ALERT_MAX_CATEGORIES alerts with random
+ * priorities (plus all-equal and all-distinct ones) it puts the machine in
+ * every state (idle and each alert active) and applies every input (each
+ * alert ID and the out-of-range ones up to 0xFF), checking the action,
+ * from, to and the active alert afterwards. The key and button maps are
+ * checked for every character and button code.
+ *
+ * Then it times alert_fsm_dispatch() over a long random input sequence for
+ * each table size: the cost per dispatch should not grow with the number of
+ * categories.
+ *
+ * Build: gcc -O2 -Wall -I../source -o alert_fsm_check alert_fsm_check.c ../source/alert_fsm.c
+ * Usage: ./alert_fsm_check
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "alert_fsm.h"
+
+#define RANDOM_TABLES  200U
+#define BENCH_DISPATCH 20000000U
+
+static alert_descriptor_t table[ALERT_MAX_CATEGORIES];
+static uint32_t failures;
+
+static uint32_t rng_state = 2463534242U;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// The rules as alert_fsm.h states them
+static alert_transition_t model(alert_id_t current, alert_id_t input, uint32_t count) {
+    alert_transition_t t = {ALERT_ACTION_IGNORE, current, current};
+    if (input >= count) {
+        return t;
+    }
+    if (current == ALERT_NONE) {
+        t.action = ALERT_ACTION_START;
+        t.to = input;
+    } else if (current == input) {
+        t.action = ALERT_ACTION_CANCEL;
+        t.to = ALERT_NONE;
+    } else if (table[input].priority >= table[current].priority) {
+        t.action = ALERT_ACTION_SWITCH;
+        t.to = input;
+    }
+    return t;
+}
+
+// Letter keys in alternating case (digits past 'Z') and buttons on
+// PORTA..PORTE pins, spread out so none collide
+static void make_table(uint32_t count, int mode) {
+    for (uint32_t i = 0; i < count; i++) {
+        table[i] = (alert_descriptor_t){0};
+        table[i].name = "alert";
+        table[i].key = (char)((i >= 26U) ? ('0' + i - 26U) : ((i & 1U) != 0U) ? ('a' + i) : ('A' + i));
+        table[i].button = (i % 3U == 2U) ? ALERT_NO_BUTTON : ALERT_BUTTON(i % 5U, (i * 7U) % 32U);
+        table[i].priority = (mode == 0) ? 1U : (mode == 1) ? (uint8_t)i : (uint8_t)(rng() % 4U);
+    }
+}
+
+static void fail(const char *what, uint32_t count, uint32_t state, uint32_t input) {
+    if (failures++ < 10U) {
+        fprintf(stderr, "%u alerts, state %u, input %u: %s\n", count, state, input, what);
+    }
+}
+
+static uint32_t check_table(uint32_t count) {
+    uint32_t cases = 0U;
+    alert_fsm_init(table, count);
+
+    for (uint32_t state = 0; state <= count; state++) {
+        alert_id_t current = (state == count) ? ALERT_NONE : (alert_id_t)state;
+        for (uint32_t input = 0; input <= 0xFFU; input++) {
+            // Into the state from idle, then the input under test
+            alert_fsm_init(table, count);
+            if (current != ALERT_NONE) {
+                (void)alert_fsm_dispatch(current);
+            }
+            if (alert_fsm_active() != current) {
+                fail("could not reach the state", count, state, input);
+                continue;
+            }
+            alert_transition_t want = model(current, (alert_id_t)input, count);
+            alert_transition_t got = alert_fsm_dispatch((alert_id_t)input);
+            if (got.action != want.action || got.from != want.from || got.to != want.to) {
+                fail("wrong transition", count, state, input);
+            }
+            if (alert_fsm_active() != want.to) {
+                fail("active alert not updated", count, state, input);
+            }
+            cases++;
+        }
+    }
+
+    for (uint32_t ch = 0; ch <= 0xFFU; ch++) {
+        alert_id_t want = ALERT_NONE;
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t key = (uint8_t)table[i].key;
+            bool letter = (ch | 0x20U) >= 'a' && (ch | 0x20U) <= 'z';
+            if (ch == key || (letter && (ch ^ 0x20U) == key)) {
+                want = (alert_id_t)i;
+            }
+        }
+        if (alert_fsm_key_to_input((uint8_t)ch) != want) {
+            fail("wrong key mapping", count, 0U, ch);
+        }
+    }
+    for (uint32_t code = 0; code <= 0xFFU; code++) {
+        alert_id_t want = ALERT_NONE;
+        for (uint32_t i = 0; i < count; i++) {
+            if (table[i].button == code && code != ALERT_NO_BUTTON) {
+                want = (alert_id_t)i;
+            }
+        }
+        if (alert_fsm_button_to_input((uint8_t)code) != want) {
+            fail("wrong button mapping", count, 0U, code);
+        }
+    }
+    return cases;
+}
+
+static double bench(uint32_t count) {
+    static alert_id_t inputs[4096];
+    for (uint32_t i = 0; i < 4096U; i++) {
+        inputs[i] = (alert_id_t)(rng() % count);
+    }
+    alert_fsm_init(table, count);
+    uint32_t sink = 0U;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t i = 0; i < BENCH_DISPATCH; i++) {
+        sink += alert_fsm_dispatch(inputs[i & 4095U]).to;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (sink == 0xFFFFFFFFU) {
+        printf(" ");  // Keeps the loop from being optimised away
+    }
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / BENCH_DISPATCH;
+}
+
+int main(void) {
+    uint32_t cases = 0U;
+    for (uint32_t count = 1; count <= ALERT_MAX_CATEGORIES; count++) {
+        for (int mode = 0; mode < 2; mode++) {
+            make_table(count, mode);
+            cases += check_table(count);
+        }
+    }
+    for (uint32_t i = 0; i < RANDOM_TABLES; i++) {
+        uint32_t count = 1U + rng() % ALERT_MAX_CATEGORIES;
+        make_table(count, 2);
+        cases += check_table(count);
+    }
+    printf("%u (state, input) cases checked\n", cases);
+
+    printf("alerts  ns per dispatch\n");
+    for (uint32_t count = 2; count <= ALERT_MAX_CATEGORIES; count *= 2U) {
+        make_table(count, 2);
+        printf("%6u  %15.2f\n", count, bench(count));
+    }
+    printf("%s\n", (failures == 0U) ? "PASS" : "FAIL");
+    return (failures == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
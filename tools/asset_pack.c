@@ -0,0 +1,253 @@
+/*
+ * SEH500 Project - Host-side clip bank packer
+ *
+ * Packs WAV clips (8/16/24-bit PCM or IMA-ADPCM, mono or stereo, any rate
+ * the player resamples) into one asset bank (source/asset_bank.h). Clip
+ * IDs follow the order of the inputs, so they must match the audio_clip
+ * numbers in SEH500_Project.c's alert table. The first loop of a smpl
+ * chunk becomes the clip's loop points, moved out to whole frames (PCM)
+ * or whole blocks (ADPCM).
+ *
+ * The finished bank is checked with the target's own asset_bank_check()
+ * and every clip is compared with its source before anything is written.
+ *
+ * Build: gcc -O2 -Wall -I../source -o asset_pack asset_pack.c ../source/asset_bank.c
+ * Usage: ./asset_pack [-n] [-c bank.c] out.bnk in.wav...
+ *        (../audio/water.wav ../audio/restroom.wav; copy out.bnk to the SD
+ *        card as clips.bnk, or build bank.c into the firmware for flash)
+ *
+ * -n stores 16-bit mono clips as stereo. At 44.1 kHz that is the SAI's own
+ *    layout, so a flash bank feeds them to the eDMA with no copy at all, at
+ *    twice the space.
+ * -c also writes the bank as a C array (asset_bank_image) to link into flash.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asset_bank.h"
+#include "adpcm.h"
+
+#define WAV_FORMAT_EXTENSIBLE 0xFFFEU
+
+typedef struct {
+    const char *path;
+    asset_clip_t clip;
+    uint8_t *data;  // Sample data as stored in the bank
+} input_t;
+
+static uint32_t le16(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t le32(const uint8_t *p) {
+    return le16(p) | (le16(&p[2]) << 16);
+}
+
+static uint8_t *read_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = (n > 0) ? malloc((size_t)n) : NULL;
+    if (buf != NULL && fread(buf, 1, (size_t)n, f) != (size_t)n) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    *size = (size_t)n;
+    return buf;
+}
+
+// Fill in->clip and in->data from a WAV file; 0 on failure (message printed)
+static int load_wav(input_t *in, int widen) {
+    size_t size = 0;
+    uint8_t *wav = read_file(in->path, &size);
+    if (wav == NULL || size < 12U || memcmp(wav, "RIFF", 4) != 0 || memcmp(&wav[8], "WAVE", 4) != 0) {
+        fprintf(stderr, "%s: not a RIFF/WAVE file\n", in->path);
+        return 0;
+    }
+
+    const uint8_t *fmt = NULL;
+    const uint8_t *data = NULL;
+    const uint8_t *smpl = NULL;
+    uint32_t data_size = 0U;
+    for (size_t pos = 12U; pos + 8U <= size;) {
+        uint32_t len = le32(&wav[pos + 4U]);
+        uint32_t avail = (len > size - pos - 8U) ? (uint32_t)(size - pos - 8U) : len;
+        if (memcmp(&wav[pos], "fmt ", 4) == 0 && avail >= 16U) {
+            fmt = &wav[pos + 8U];
+        } else if (memcmp(&wav[pos], "data", 4) == 0) {
+            data = &wav[pos + 8U];
+            data_size = avail;
+        } else if (memcmp(&wav[pos], "smpl", 4) == 0 && avail >= 60U && le32(&wav[pos + 8U + 28U]) != 0U) {
+            smpl = &wav[pos + 8U];
+        }
+        pos += 8U + (size_t)len + (len & 1U);
+    }
+    if (fmt == NULL || data == NULL) {
+        fprintf(stderr, "%s: no fmt or data chunk\n", in->path);
+        return 0;
+    }
+
+    asset_clip_t *c = &in->clip;
+    c->format = (uint16_t)le16(&fmt[0]);
+    if (c->format == WAV_FORMAT_EXTENSIBLE && le16(&fmt[16]) >= 22U) {
+        c->format = (uint16_t)le16(&fmt[24]);  // Sub-format GUID starts with the tag
+    }
+    c->channels = (uint16_t)le16(&fmt[2]);
+    c->sample_rate = le32(&fmt[4]);
+    c->block_align = (uint16_t)le16(&fmt[12]);
+    c->bits = (uint16_t)le16(&fmt[14]);
+    if (c->format != ASSET_FORMAT_PCM && c->format != ASSET_FORMAT_IMA_ADPCM) {
+        fprintf(stderr, "%s: format 0x%04x is neither PCM nor IMA-ADPCM\n", in->path, c->format);
+        return 0;
+    }
+
+    // Loop: frames [start, end] inclusive -> bytes, out to whole frames or blocks
+    uint32_t frame_bytes = c->block_align;
+    uint32_t unit_frames = 1U;
+    if (c->format == ASSET_FORMAT_IMA_ADPCM && c->channels != 0U && c->block_align > c->channels * ADPCM_HEADER_SIZE) {
+        unit_frames = ADPCM_BLOCK_FRAMES(c->block_align, c->channels);
+    }
+    uint32_t whole = (frame_bytes == 0U) ? 0U : (data_size / frame_bytes) * frame_bytes;
+    if (smpl != NULL && frame_bytes != 0U) {
+        uint32_t start = le32(&smpl[36U + 8U]);
+        uint32_t end = le32(&smpl[36U + 12U]) + 1U;
+        uint64_t loop_start = (uint64_t)(start / unit_frames) * frame_bytes;
+        uint64_t loop_end = (uint64_t)((end + unit_frames - 1U) / unit_frames) * frame_bytes;
+        if (loop_end > whole) {
+            loop_end = whole;
+        }
+        if (loop_start < loop_end) {
+            c->loop_start = (uint32_t)loop_start;
+            c->loop_end = (uint32_t)loop_end;
+        } else {
+            fprintf(stderr, "%s: loop %u-%u is outside the data, ignored\n", in->path, start, end - 1U);
+        }
+    }
+
+    if (widen && c->format == ASSET_FORMAT_PCM && c->bits == 16U && c->channels == 1U) {
+        uint32_t frames = data_size / 2U;
+        in->data = malloc((size_t)frames * 4U + 1U);
+        for (uint32_t i = 0; i < frames; i++) {
+            memcpy(&in->data[4U * i], &data[2U * i], 2U);
+            memcpy(&in->data[4U * i + 2U], &data[2U * i], 2U);
+        }
+        c->channels = 2U;
+        c->block_align = 4U;
+        c->length = frames * 4U;
+        c->loop_start *= 2U;
+        c->loop_end *= 2U;
+    } else {
+        in->data = malloc(data_size + 1U);
+        memcpy(in->data, data, data_size);
+        c->length = data_size;
+    }
+    free(wav);
+    return 1;
+}
+
+static int write_c_array(const char *path, const uint8_t *bank, uint32_t size, int argc, char **argv, int first) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        return 0;
+    }
+    fprintf(f, "// Clip bank generated by tools/asset_pack.c from:");
+    for (int i = first; i < argc; i++) {
+        fprintf(f, " %s", argv[i]);
+    }
+    fprintf(f, "\n// Clip IDs follow that order. Do not edit.\n\n#include <stdint.h>\n\n");
+    fprintf(f, "const uint32_t asset_bank_image_size = %uU;\n\n", size);
+    fprintf(f, "__attribute__((aligned(4))) const uint8_t asset_bank_image[%uU] = {\n", size);
+    for (uint32_t i = 0; i < size; i++) {
+        fprintf(f, "%s0x%02x,%s", (i % 16U == 0U) ? "    " : "", bank[i], (i % 16U == 15U || i + 1U == size) ? "\n" : " ");
+    }
+    fprintf(f, "};\n");
+    return fclose(f) == 0;
+}
+
+int main(int argc, char **argv) {
+    int widen = 0;
+    const char *c_path = NULL;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-n") == 0) {
+            widen = 1;
+        } else if (strcmp(argv[arg], "-c") == 0 && arg + 1 < argc) {
+            c_path = argv[++arg];
+        } else {
+            break;
+        }
+    }
+    int count = argc - arg - 1;
+    if (count < 1 || count > (int)ASSET_BANK_MAX_CLIPS) {
+        fprintf(stderr, "usage: %s [-n] [-c bank.c] out.bnk in.wav... (1 to %u clips)\n", argv[0],
+                ASSET_BANK_MAX_CLIPS);
+        return EXIT_FAILURE;
+    }
+    const char *out_path = argv[arg];
+    int first = arg + 1;
+
+    input_t *inputs = calloc((size_t)count, sizeof(input_t));
+    uint32_t size = (uint32_t)ASSET_BANK_INDEX_SIZE((uint32_t)count);
+    for (int i = 0; i < count; i++) {
+        inputs[i].path = argv[first + i];
+        if (!load_wav(&inputs[i], widen)) {
+            return EXIT_FAILURE;
+        }
+        size = (size + ASSET_BANK_ALIGN - 1U) & ~(ASSET_BANK_ALIGN - 1U);
+        inputs[i].clip.offset = size;
+        size += inputs[i].clip.length;
+    }
+    size = (size + ASSET_BANK_ALIGN - 1U) & ~(ASSET_BANK_ALIGN - 1U);
+
+    // Header, index and data; everything between clips stays zero (silence)
+    uint8_t *bank = calloc(size, 1);
+    asset_bank_header_t header = {ASSET_BANK_MAGIC, ASSET_BANK_VERSION, (uint16_t)count, size, 0U};
+    memcpy(bank, &header, sizeof(header));
+    for (int i = 0; i < count; i++) {
+        memcpy(&bank[sizeof(header) + (size_t)i * sizeof(asset_clip_t)], &inputs[i].clip, sizeof(asset_clip_t));
+        memcpy(&bank[inputs[i].clip.offset], inputs[i].data, inputs[i].clip.length);
+    }
+
+    if (asset_bank_check(bank, size, size) != (uint32_t)count) {
+        fprintf(stderr, "the target rejects the bank (unsupported format or loop in one of the clips)\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < count; i++) {
+        const asset_clip_t *clip = asset_bank_clip(bank, (uint32_t)i);
+        if (clip == NULL || memcmp(&bank[clip->offset], inputs[i].data, clip->length) != 0) {
+            fprintf(stderr, "clip %d does not read back from the bank\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+
+    FILE *f = fopen(out_path, "wb");
+    if (f == NULL || fwrite(bank, 1, size, f) != size || fclose(f) != 0) {
+        fprintf(stderr, "%s: write failed\n", out_path);
+        return EXIT_FAILURE;
+    }
+    if (c_path != NULL && !write_c_array(c_path, bank, size, argc, argv, first)) {
+        fprintf(stderr, "%s: write failed\n", c_path);
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const asset_clip_t *c = &inputs[i].clip;
+        printf("clip %d: %s, %s %u-bit %u ch %u Hz, %u bytes at 0x%x", i, inputs[i].path,
+               (c->format == ASSET_FORMAT_IMA_ADPCM) ? "ADPCM" : "PCM", c->bits, c->channels, c->sample_rate,
+               c->length, c->offset);
+        if (c->loop_end != 0U) {
+            printf(", loop bytes %u-%u", c->loop_start, c->loop_end);
+        }
+        printf("\n");
+    }
+    printf("%s: %u clips, %u bytes\n", out_path, count, size);
+    return EXIT_SUCCESS;
+}
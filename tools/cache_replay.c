@@ -0,0 +1,268 @@
+/*
+ * SEH500 Project - Host-side replay of FatFs workloads over the sector cache
+ *
+ * Runs the target's FatFs (ffconf.h as configured) and sector_cache.c on an
+ * 8 MB RAM disk with 512-byte clusters, and counts the sectors that reach
+ * the medium for each workload, first with no window attached (every
+ * transfer goes straight through, as before the cache) and then with the
+ * volume's window cached. The disk is formatted and the same files created
+ * before each run, so both runs start from identical images and only the
+ * workload itself is counted. Both runs must leave the same disk image,
+ * which checks that write-back loses or reorders nothing FatFs can see.
+ *
+ *   log+scan  append a line to a log file, then list the clip directory
+ *   lookup    open clips by name in turn, read their first sector, close
+ *   sync-log  append and f_sync() after every line (a crash-safe log)
+ *   stream    read a 1 MB clip in 4 KB chunks from a 44-byte data offset
+ *
+ * Build: gcc -O2 -Wall -I../source -I../fatfs/source -o cache_replay cache_replay.c ../source/sector_cache.c
+ *        ../fatfs/source/ff.c ../fatfs/source/ffsystem.c ../fatfs/source/ffunicode.c
+ *        (-DSECTOR_CACHE_ENTRIES=n to try another cache size)
+ * Usage: ./cache_replay
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ff.h"
+#include "diskio.h"
+#include "sector_cache.h"
+
+#define DISK_SECTORS  16384U  // 8 MB
+#define CLIP_COUNT    48U
+#define CLIP_SIZE     2048U
+#define STREAM_SIZE   (1024U * 1024U)
+#define ITERATIONS    200U
+
+static uint8_t disk_image[DISK_SECTORS][SECTOR_CACHE_SIZE];
+static uint32_t medium_reads;
+static uint32_t medium_writes;
+static FATFS volume;
+
+// Disk layer: the RAM disk under the cache, with sector counts
+int sector_cache_media_read(uint8_t drive, uint8_t *buf, uint32_t sector, uint32_t count) {
+    if (drive != 0U || sector + count > DISK_SECTORS) {
+        return RES_PARERR;
+    }
+    memcpy(buf, disk_image[sector], (size_t)count * SECTOR_CACHE_SIZE);
+    medium_reads += count;
+    return RES_OK;
+}
+
+int sector_cache_media_write(uint8_t drive, const uint8_t *buf, uint32_t sector, uint32_t count) {
+    if (drive != 0U || sector + count > DISK_SECTORS) {
+        return RES_PARERR;
+    }
+    memcpy(disk_image[sector], buf, (size_t)count * SECTOR_CACHE_SIZE);
+    medium_writes += count;
+    return RES_OK;
+}
+
+DSTATUS disk_status(BYTE pdrv) {
+    return (pdrv == 0U) ? 0U : STA_NOINIT;
+}
+
+DSTATUS disk_initialize(BYTE pdrv) {
+    return disk_status(pdrv);
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+    return (DRESULT)sector_cache_read(pdrv, buff, (uint32_t)sector, count);
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+    return (DRESULT)sector_cache_write(pdrv, buff, (uint32_t)sector, count);
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
+    switch (cmd) {
+        case CTRL_SYNC:
+            return (DRESULT)sector_cache_flush(pdrv);
+        case GET_SECTOR_COUNT:
+            *(LBA_t *)buff = DISK_SECTORS;
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *(WORD *)buff = SECTOR_CACHE_SIZE;
+            return RES_OK;
+        case GET_BLOCK_SIZE:
+            *(DWORD *)buff = 1U;
+            return RES_OK;
+        default:
+            return RES_PARERR;
+    }
+}
+
+static void check(FRESULT res, const char *what) {
+    if (res != FR_OK) {
+        fprintf(stderr, "%s failed: FRESULT %d\n", what, (int)res);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void write_file(const char *path, uint32_t size) {
+    static uint8_t chunk[4096];
+    FIL f;
+    UINT done;
+    check(f_open(&f, path, FA_WRITE | FA_CREATE_ALWAYS), path);
+    for (uint32_t left = size; left != 0U;) {
+        UINT n = (left < sizeof(chunk)) ? left : sizeof(chunk);
+        memset(chunk, (int)(left & 0xFFU), n);
+        check(f_write(&f, chunk, n, &done), path);
+        left -= n;
+    }
+    check(f_close(&f), path);
+}
+
+// Fresh volume with the clip directory, a clip to stream and an empty log
+static void prepare(void) {
+    static uint8_t work[FF_MAX_SS];
+    const MKFS_PARM opt = {FM_FAT | FM_SFD, 2U, 1U, 512U, SECTOR_CACHE_SIZE};
+    char path[32];
+
+    sector_cache_attach(0U, NULL);
+    check(f_mkfs("0:", &opt, work, sizeof(work)), "f_mkfs");
+    check(f_mount(&volume, "0:", 1U), "f_mount");
+    check(f_mkdir("0:/clips"), "f_mkdir");
+    for (uint32_t i = 0; i < CLIP_COUNT; i++) {
+        snprintf(path, sizeof(path), "0:/clips/clip%02u.wav", i);
+        write_file(path, CLIP_SIZE);
+    }
+    write_file("0:/stream.wav", STREAM_SIZE);
+    write_file("0:/log.txt", 0U);
+    check(f_mount(NULL, "0:", 0U), "f_unmount");
+}
+
+static void append_line(uint32_t i, int sync) {
+    static FIL log;
+    char line[64];
+    UINT done;
+    if (!sync || i == 0U) {
+        check(f_open(&log, "0:/log.txt", FA_WRITE | FA_OPEN_APPEND), "log open");
+    }
+    int n = snprintf(line, sizeof(line), "%06u water alert raised, level %u of 10, clip %02u\n", i, i % 10U,
+                     i % CLIP_COUNT);
+    check(f_write(&log, line, (UINT)n, &done), "log write");
+    if (sync) {
+        check(f_sync(&log), "log sync");
+        if (i + 1U == ITERATIONS) {
+            check(f_close(&log), "log close");
+        }
+    } else {
+        check(f_close(&log), "log close");
+    }
+}
+
+static void list_clips(void) {
+    DIR dir;
+    FILINFO info;
+    check(f_opendir(&dir, "0:/clips"), "f_opendir");
+    while (f_readdir(&dir, &info) == FR_OK && info.fname[0] != '\0') {
+    }
+    check(f_closedir(&dir), "f_closedir");
+}
+
+static void run_log_scan(void) {
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        append_line(i, 0);
+        list_clips();
+    }
+}
+
+static void run_lookup(void) {
+    uint8_t sector[SECTOR_CACHE_SIZE];
+    char path[32];
+    FIL f;
+    UINT got;
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        snprintf(path, sizeof(path), "0:/clips/clip%02u.wav", (i * 7U) % CLIP_COUNT);
+        check(f_open(&f, path, FA_READ), path);
+        check(f_read(&f, sector, sizeof(sector), &got), path);
+        check(f_close(&f), path);
+    }
+}
+
+static void run_sync_log(void) {
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        append_line(i, 1);
+    }
+}
+
+static void run_stream(void) {
+    static uint8_t chunk[4096];
+    FIL f;
+    UINT got;
+    check(f_open(&f, "0:/stream.wav", FA_READ), "stream open");
+    check(f_lseek(&f, 44U), "stream seek");
+    do {
+        check(f_read(&f, chunk, sizeof(chunk), &got), "stream read");
+    } while (got == sizeof(chunk));
+    check(f_close(&f), "stream close");
+}
+
+typedef struct {
+    uint32_t reads;
+    uint32_t writes;
+    uint64_t image;  // FNV-1a of the disk after the run
+    sector_cache_stats_t cache;
+} run_result_t;
+
+static uint64_t image_hash(void) {
+    const uint8_t *p = &disk_image[0][0];
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < sizeof(disk_image); i++) {
+        h = (h ^ p[i]) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+static run_result_t replay(void (*workload)(void), int cached) {
+    run_result_t r;
+    sector_cache_stats_t before;
+
+    prepare();
+    sector_cache_attach(0U, cached ? volume.win : NULL);
+    sector_cache_get_stats(&before);
+    medium_reads = 0U;
+    medium_writes = 0U;
+    check(f_mount(&volume, "0:", 1U), "f_mount");
+    workload();
+    check(f_mount(NULL, "0:", 0U), "f_unmount");
+    check((FRESULT)sector_cache_flush(0U), "flush");
+    r.reads = medium_reads;
+    r.writes = medium_writes;
+    r.image = image_hash();
+    sector_cache_get_stats(&r.cache);
+    r.cache.hits -= before.hits;
+    r.cache.misses -= before.misses;
+    return r;
+}
+
+int main(void) {
+    static const struct {
+        const char *name;
+        void (*run)(void);
+    } workloads[] = {
+        {"log+scan", run_log_scan},
+        {"lookup", run_lookup},
+        {"sync-log", run_sync_log},
+        {"stream", run_stream},
+    };
+
+    printf("%u cached sectors, %u iterations per workload\n", SECTOR_CACHE_ENTRIES, ITERATIONS);
+    printf("workload   reads: direct  cached  saved   writes: direct  cached   hit rate\n");
+    for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+        run_result_t direct = replay(workloads[i].run, 0);
+        run_result_t cached = replay(workloads[i].run, 1);
+        uint32_t lookups = cached.cache.hits + cached.cache.misses;
+        printf("%-9s %14u %7u %5.1f%% %15u %7u %8.1f%%\n", workloads[i].name, direct.reads, cached.reads,
+               (direct.reads != 0U) ? 100.0 * ((double)direct.reads - cached.reads) / direct.reads : 0.0,
+               direct.writes, cached.writes, (lookups != 0U) ? 100.0 * cached.cache.hits / lookups : 0.0);
+        if (cached.image != direct.image) {
+            fprintf(stderr, "%s: the cached run left a different disk image\n", workloads[i].name);
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
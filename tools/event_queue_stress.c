@@ -0,0 +1,163 @@
+/*
+ * SEH500 Project - Host-side stress test for the deferred event queue
+ *
+ * Builds source/event_queue.c with the Cortex-M4 barrier replaced by a
+ * full host fence (host/fsl_common.h) and the cycle counter replaced by
+ * the producer's sequence number, then runs it with one producer thread
+ * (the ISRs) and one consumer thread (the main loop) on separate cores.
+ * The producer posts in bursts of random length with short gaps, the way
+ * interrupts arrive, and the consumer stops now and then so the ring fills
+ * up and posts are dropped. After
+ * both threads finish the test requires that:
+ *
+ *   - the consumer saw exactly the accepted events, in posting order,
+ *     with no duplicates and none of the dropped ones
+ *   - every record arrived whole (payload and source match its sequence)
+ *   - event_queue_dropped() equals the posts that returned false
+ *
+ * Build: gcc -O2 -Wall -pthread -Ihost -I../source -o event_queue_stress event_queue_stress.c
+ * Usage: ./event_queue_stress [events]
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// ---- Stand-in for the cycle counter (host/fsl_common.h has the barrier) ----
+
+#define CYCLE_COUNTER_H_
+
+static volatile uint32_t producer_seq;  // Stamped into each record as its "cycle count"
+
+static uint32_t cycle_counter_now(void) {
+    return producer_seq;
+}
+
+#include "event_queue.c"
+
+#define DEFAULT_EVENTS 20000000U
+#define PAUSE_EVERY    4096U  // Consumer pauses about this often (pops)
+
+static uint32_t event_total;
+static uint8_t *accepted;  // Per sequence: 1 if the post returned true
+static uint32_t *popped;   // Sequences in the order the consumer got them
+static uint32_t popped_count;
+static uint32_t post_failures;
+static volatile int producer_done;
+static uint32_t bad_records;
+
+static uint8_t source_of(uint32_t seq) {
+    return (uint8_t)(seq % 3U);
+}
+
+static void *producer(void *arg) {
+    (void)arg;
+    uint32_t seed = 54321U;
+    uint32_t burst = 0U;
+    for (uint32_t seq = 0; seq < event_total; seq++) {
+        if (burst-- == 0U) {
+            seed = seed * 1103515245U + 12345U;
+            burst = (seed >> 16) % 48U;  // Up to one and a half rings back to back
+            for (volatile uint32_t spin = (seed >> 8) % 512U; spin != 0U; spin--) {
+            }
+            if ((seed >> 24) % 4U == 0U) {
+                sched_yield();  // Lets the consumer in on a single core too
+            }
+        }
+        producer_seq = seq;
+        if (event_queue_post((event_source_t)source_of(seq), (uint8_t)seq)) {
+            accepted[seq] = 1U;
+        } else {
+            post_failures++;
+        }
+    }
+    __atomic_store_n(&producer_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    (void)arg;
+    uint32_t seed = 12345U;
+    for (;;) {
+        app_event_t event;
+        if (!event_queue_pop(&event)) {
+            if (__atomic_load_n(&producer_done, __ATOMIC_ACQUIRE) && event_queue_is_empty()) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+        uint32_t seq = event.timestamp;
+        if (event.payload != (uint8_t)seq || event.source != source_of(seq) || event.reserved != 0U) {
+            bad_records++;
+        }
+        if (popped_count < event_total) {
+            popped[popped_count] = seq;
+        }
+        popped_count++;
+
+        seed = seed * 1103515245U + 12345U;
+        if ((seed >> 16) % PAUSE_EVERY == 0U) {
+            struct timespec pause = {0, 20000};  // Long enough for the producer to fill the ring
+            nanosleep(&pause, NULL);
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    event_total = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : DEFAULT_EVENTS;
+    accepted = calloc(event_total, sizeof(*accepted));
+    popped = calloc(event_total, sizeof(*popped));
+    if (accepted == NULL || popped == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    event_queue_init();
+    pthread_t threads[2];
+    pthread_create(&threads[1], NULL, consumer, NULL);
+    pthread_create(&threads[0], NULL, producer, NULL);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+
+    // The accepted sequences, in order, must be exactly what was popped
+    uint32_t failures = 0U;
+    uint32_t next = 0U;
+    uint32_t accepted_count = 0U;
+    for (uint32_t seq = 0; seq < event_total; seq++) {
+        if (!accepted[seq]) {
+            continue;
+        }
+        accepted_count++;
+        if (next >= popped_count || popped[next] != seq) {
+            if (failures++ < 5U) {
+                fprintf(stderr, "event %u: expected sequence %u, got %d\n", next, seq,
+                        (next < popped_count) ? (int)popped[next] : -1);
+            }
+        }
+        next++;
+    }
+    if (popped_count != accepted_count) {
+        fprintf(stderr, "popped %u events, %u were accepted\n", popped_count, accepted_count);
+        failures++;
+    }
+    if (event_queue_dropped() != post_failures || accepted_count + post_failures != event_total) {
+        fprintf(stderr, "drop count %u, %u posts failed\n", event_queue_dropped(), post_failures);
+        failures++;
+    }
+    if (bad_records != 0U) {
+        fprintf(stderr, "%u records arrived torn\n", bad_records);
+        failures++;
+    }
+
+    printf("%u events posted: %u delivered in order, %u dropped (ring of %u)\n", event_total, popped_count,
+           post_failures, EVENT_QUEUE_SIZE);
+    printf("%s\n", (failures == 0U) ? "PASS" : "FAIL");
+    free(accepted);
+    free(popped);
+    return (failures == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,19 @@
+/*
+ * SEH500 Project - Host stand-in for the SDK's fsl_common.h
+ *
+ * Lets the checks in tools/ build target modules unchanged on the host
+ * (-Ihost ahead of -I../source): only what those modules use from the
+ * SDK and CMSIS, modelled with GCC builtins.
+ */
+
+#ifndef _FSL_COMMON_H_
+#define _FSL_COMMON_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Memory barrier: a full fence orders the same accesses on the host
+#define __DMB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#endif /* _FSL_COMMON_H_ */
@@ -0,0 +1,142 @@
+/*
+ * SEH500 Project - Host-side bit-exactness check for the voice mixer
+ *
+ * Builds source/audio_mixer.c with its SIMD path switched on and the CMSIS
+ * intrinsics it uses (__SMLAD, __QADD16, __PKHBT) replaced by C models of
+ * the Cortex-M4 instructions, then mixes random and worst-case voices with
+ * both audio_mix() and audio_mix_ref() and requires identical output:
+ * every gain class (mute, small, half, just below unity, unity), odd
+ * lengths, unaligned buffers and full-scale voices that must saturate.
+ * Gain ramps (audio_mix_ramp) are checked the same way, fading up and
+ * down between random gains, and must also end on the same level.
+ *
+ * Build: gcc -O2 -Wall -I../source -o mix_check mix_check.c
+ * Usage: ./mix_check [rounds]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ---- C models of the Cortex-M4 instructions ----
+
+static uint32_t model_read32(const void *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void model_write32(void *p, uint32_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+// SMLAD: op3 + op1.lo * op2.lo + op1.hi * op2.hi, signed 16 x 16, 32-bit wrap
+static uint32_t __SMLAD(uint32_t op1, uint32_t op2, uint32_t op3) {
+    int32_t lo = (int32_t)(int16_t)op1 * (int16_t)op2;
+    int32_t hi = (int32_t)(int16_t)(op1 >> 16) * (int16_t)(op2 >> 16);
+    return op3 + (uint32_t)lo + (uint32_t)hi;
+}
+
+static int32_t model_sat16(int32_t v) {
+    return (v > INT16_MAX) ? INT16_MAX : (v < INT16_MIN) ? INT16_MIN : v;
+}
+
+// QADD16: two signed halfword adds, each saturated
+static uint32_t __QADD16(uint32_t op1, uint32_t op2) {
+    int32_t lo = model_sat16((int16_t)op1 + (int16_t)op2);
+    int32_t hi = model_sat16((int16_t)(op1 >> 16) + (int16_t)(op2 >> 16));
+    return ((uint32_t)lo & 0xFFFFU) | ((uint32_t)hi << 16);
+}
+
+#define __PKHBT(ARG1, ARG2, ARG3) \
+    ((((uint32_t)(ARG1)) & 0x0000FFFFUL) | ((((uint32_t)(ARG2)) << (ARG3)) & 0xFFFF0000UL))
+#define __UNALIGNED_UINT32_READ(p)     model_read32(p)
+#define __UNALIGNED_UINT32_WRITE(p, v) model_write32((p), (v))
+
+#define AUDIO_MIX_SIMD 1
+#include "audio_mixer.c"
+
+// ---- Test ----
+
+#define MAX_SAMPLES 4099U
+#define VOICES      4U
+
+static const uint16_t gains[] = {0U, 1U, 0x0123U, AUDIO_GAIN_HALF, 0x5A82U, 0x7FFEU, AUDIO_GAIN_UNITY, 0xFFFFU};
+
+static int16_t voice[VOICES][MAX_SAMPLES + 1U];
+static int16_t out_fast[MAX_SAMPLES + 1U];
+static int16_t out_ref[MAX_SAMPLES + 1U];
+
+static uint32_t rng = 0x1234567U;
+
+static uint32_t next(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// Random audio, full-scale square waves (always saturate when summed) or extremes only
+static void fill(int16_t *v, uint32_t n, uint32_t kind) {
+    for (uint32_t i = 0; i < n; i++) {
+        switch (kind) {
+            case 0:
+                v[i] = (int16_t)next();
+                break;
+            case 1:
+                v[i] = ((i / 7U) & 1U) ? INT16_MIN : INT16_MAX;
+                break;
+            default:
+                v[i] = (next() & 1U) ? INT16_MIN : ((next() & 1U) ? INT16_MAX : 0);
+                break;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t rounds = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 2000U;
+    uint32_t failures = 0U;
+
+    for (uint32_t r = 0; r < rounds; r++) {
+        uint32_t n = (r < 16U) ? r : (next() % MAX_SAMPLES);
+        uint32_t offset = next() & 1U;  // Odd offset = buffers not word aligned
+        uint32_t voices = 1U + (next() % VOICES);
+
+        fill(&out_fast[offset], n, next() % 3U);
+        memcpy(&out_ref[offset], &out_fast[offset], n * sizeof(int16_t));
+        for (uint32_t v = 0; v < voices; v++) {
+            uint16_t gain = gains[next() % (sizeof(gains) / sizeof(gains[0]))];
+            fill(&voice[v][offset], n, next() % 3U);
+            audio_mix(&out_fast[offset], &voice[v][offset], gain, n);
+            audio_mix_ref(&out_ref[offset], &voice[v][offset], gain, n);
+        }
+        // One ramp per round: over up to the whole buffer, towards a random gain
+        uint32_t frames = n / 2U;
+        int32_t from = (int32_t)(next() % (AUDIO_GAIN_UNITY + 1U)) << 16;
+        int32_t to = (int32_t)(next() % (AUDIO_GAIN_UNITY + 1U)) << 16;
+        int32_t step = (frames == 0U) ? 0 : (to - from) / (int32_t)frames;
+        fill(&voice[0][offset], n, next() % 3U);
+        int32_t end_fast = audio_mix_ramp(&out_fast[offset], &voice[0][offset], from, step, frames);
+        int32_t end_ref = audio_mix_ramp_ref(&out_ref[offset], &voice[0][offset], from, step, frames);
+        if (end_fast != end_ref) {
+            printf("round %u: ramp over %u frames ends at 0x%08x SIMD, 0x%08x reference\n", r, frames,
+                   (unsigned)end_fast, (unsigned)end_ref);
+            failures++;
+        }
+
+        if (memcmp(&out_fast[offset], &out_ref[offset], n * sizeof(int16_t)) != 0) {
+            for (uint32_t i = 0; i < n; i++) {
+                if (out_fast[offset + i] != out_ref[offset + i]) {
+                    printf("round %u: %u voices, %u samples, offset %u: sample %u SIMD %d reference %d\n", r, voices,
+                           n, offset, i, out_fast[offset + i], out_ref[offset + i]);
+                    break;
+                }
+            }
+            failures++;
+        }
+    }
+
+    printf("%u rounds, %u mismatches\n", rounds, failures);
+    return (failures == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,118 @@
+/*
+ * SEH500 Project - Host-side quality check for the sample-rate converter
+ *
+ * Streams sine tones through source/audio_resample.c exactly as the player
+ * does (blocks of RESAMPLE_MAX_OUT output frames, input sized by
+ * resample_input_needed, resample_end at the tail) and compares every
+ * output sample with the tone computed in double precision at the output
+ * rate. The error includes passband droop, images/aliases, coefficient
+ * rounding and 16-bit output quantisation; it is reported as SNR in dB.
+ *
+ * Build: gcc -O2 -Wall -I../source -o resample_check resample_check.c ../source/audio_resample.c -lm
+ * Usage: ./resample_check [out_rate]     (default 44100, the player's rate)
+ *
+ * Exits non-zero if any tone in the passband falls below RESAMPLE_MIN_SNR.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "audio_resample.h"
+
+#define INPUT_SECONDS    1.0
+#define TONE_AMPLITUDE   16384.0  // -6 dBFS
+#define RESAMPLE_MIN_SNR 60.0
+
+static const uint32_t input_rates[] = {8000U, 11025U, 16000U, 22050U, 32000U, 44100U, 48000U};
+
+// Tones as a fraction of the lower of the two rates: low, mid, and the top of the passband
+static const double tone_fractions[] = {0.02, 0.1, 0.25, 0.35};
+
+static resampler_t rs;
+static int16_t out_block[2U * RESAMPLE_MAX_OUT];
+
+// Left carries the tone, right the same tone 90 degrees later
+static double tone(double freq, double t, uint32_t ch) {
+    return TONE_AMPLITUDE * sin(2.0 * M_PI * freq * t + (ch ? M_PI / 2.0 : 0.0));
+}
+
+static double run(uint32_t in_rate, uint32_t out_rate, uint32_t channels, double freq, uint32_t *frames_out) {
+    uint32_t total_in = (uint32_t)(in_rate * INPUT_SECONDS);
+    uint32_t fed = 0U;
+    uint32_t produced = 0U;
+    double signal = 0.0;
+    double noise = 0.0;
+
+    if (!resample_init(&rs, in_rate, out_rate, channels)) {
+        return -1.0;
+    }
+    for (;;) {
+        uint32_t want = resample_input_needed(&rs, RESAMPLE_MAX_OUT);
+        if (want > total_in - fed) {
+            want = total_in - fed;
+        }
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            int16_t *in = resample_input(&rs, ch);
+            for (uint32_t i = 0; i < want; i++) {
+                in[i] = (int16_t)lrint(tone(freq, (double)(fed + i) / in_rate, ch));
+            }
+        }
+        resample_commit(&rs, want);
+        fed += want;
+        if (fed == total_in) {
+            resample_end(&rs);
+        }
+
+        uint32_t n = resample_process(&rs, out_block, RESAMPLE_MAX_OUT);
+        if (n == 0U) {
+            break;
+        }
+        for (uint32_t i = 0; i < n; i++, produced++) {
+            double t = (double)produced / out_rate;
+            // Skip the edges, where the tone starts and stops abruptly
+            if (t < 0.01 || t > INPUT_SECONDS - 0.01) {
+                continue;
+            }
+            for (uint32_t ch = 0; ch < 2U; ch++) {
+                double ref = tone(freq, t, (channels == 2U) ? ch : 0U);
+                double err = out_block[2U * i + ch] - ref;
+                signal += ref * ref;
+                noise += err * err;
+            }
+        }
+    }
+    *frames_out = produced;
+    return (noise > 0.0) ? 10.0 * log10(signal / noise) : 200.0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t out_rate = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 44100U;
+    int failed = 0;
+
+    printf("Output %u Hz, %u taps x %u phases, SNR in dB vs double-precision tone\n", out_rate, RESAMPLE_TAPS,
+           RESAMPLE_PHASES);
+    printf("%8s %3s %9s %8s %10s\n", "in Hz", "ch", "tone Hz", "SNR", "frames");
+    for (size_t r = 0; r < sizeof(input_rates) / sizeof(input_rates[0]); r++) {
+        uint32_t in_rate = input_rates[r];
+        uint32_t lower = (in_rate < out_rate) ? in_rate : out_rate;
+        for (size_t f = 0; f < sizeof(tone_fractions) / sizeof(tone_fractions[0]); f++) {
+            double freq = tone_fractions[f] * lower;
+            for (uint32_t channels = 1U; channels <= 2U; channels++) {
+                uint32_t frames = 0U;
+                double snr = run(in_rate, out_rate, channels, freq, &frames);
+                if (snr < 0.0) {
+                    printf("%8u %3u  unsupported\n", in_rate, channels);
+                    continue;
+                }
+                // Every input second must come out as one output second (the flushed tail included)
+                uint32_t expect = (uint32_t)ceil(INPUT_SECONDS * out_rate);
+                int bad = (snr < RESAMPLE_MIN_SNR) || (frames + 1U < expect) || (frames > expect + 1U);
+                failed |= bad;
+                printf("%8u %3u %9.1f %8.1f %10u%s\n", in_rate, channels, freq, snr, frames, bad ? "  FAIL" : "");
+            }
+        }
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
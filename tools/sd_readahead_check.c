@@ -0,0 +1,375 @@
+/*
+ * SEH500 Project - Host-side check of the read-ahead streams over FatFs
+ *
+ * Runs source/sd_readahead.c over the target's FatFs (ffconf.h as
+ * configured) on a 4 MB RAM disk, the way the player uses it: two streams
+ * share one FIL on a clip bank file, one playing a range straight through
+ * (a new range is started when it ends) and one looping within its range.
+ * Every period each stream takes about a buffer's worth in reads of random
+ * sizes, through sd_readahead_read() or in place through
+ * sd_readahead_peek()/sd_readahead_skip() as the decoders do, and then the
+ * main loop's idle pass tops the windows up. Every byte handed over is
+ * checked against the file's pattern at the offset a model of the stream
+ * expects, including across the loop point and at the end of a range.
+ *
+ * sd_async.c is replaced by a stand-in that takes whole, aligned sectors
+ * (refusing some at random, like a file without a link map, so the f_read()
+ * chunks run too), poisons the destination and only delivers the data when
+ * the read lands in sd_async_wait() or sd_async_service().
+ *
+ * The first phase runs every idle pass to the end and requires no stalls.
+ * The second skips idle passes at random and leaves reads in flight, so the
+ * window runs dry: the data must still be exact. Both require the bytes
+ * counted as copied or uncopied to add up to the bytes handed over.
+ *
+ * Build: gcc -O2 -Wall -I../source -I../fatfs/source -o sd_readahead_check sd_readahead_check.c
+ *        ../source/sd_readahead.c ../fatfs/source/ff.c ../fatfs/source/ffsystem.c ../fatfs/source/ffunicode.c
+ * Usage: ./sd_readahead_check [periods]
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ff.h"
+#include "diskio.h"
+#include "sd_async.h"
+#include "sd_readahead.h"
+
+#define SECTOR_SIZE     512U
+#define DISK_SECTORS    8192U  // 4 MB
+#define BANK_SIZE       (300U * 1024U + 123U)
+#define DEFAULT_PERIODS 20000U
+
+static uint8_t disk_image[DISK_SECTORS][SECTOR_SIZE];
+static FATFS volume;
+static FIL bank;
+static uint32_t failures;
+
+static uint32_t rng_state = 2463534242U;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// Byte at a file offset: no run of it repeats within the file
+static uint8_t pattern(uint32_t ofs) {
+    uint32_t x = ofs * 2654435761U;
+    return (uint8_t)((x >> 24) ^ (ofs >> 9));
+}
+
+// Disk layer: the RAM disk
+DSTATUS disk_status(BYTE pdrv) {
+    return (pdrv == 0U) ? 0U : STA_NOINIT;
+}
+
+DSTATUS disk_initialize(BYTE pdrv) {
+    return disk_status(pdrv);
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+    if (pdrv != 0U || sector + count > DISK_SECTORS) {
+        return RES_PARERR;
+    }
+    memcpy(buff, disk_image[sector], (size_t)count * SECTOR_SIZE);
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+    if (pdrv != 0U || sector + count > DISK_SECTORS) {
+        return RES_PARERR;
+    }
+    memcpy(disk_image[sector], buff, (size_t)count * SECTOR_SIZE);
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
+    switch (cmd) {
+        case CTRL_SYNC:
+            return RES_OK;
+        case GET_SECTOR_COUNT:
+            *(LBA_t *)buff = DISK_SECTORS;
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *(WORD *)buff = SECTOR_SIZE;
+            return RES_OK;
+        case GET_BLOCK_SIZE:
+            *(DWORD *)buff = 1U;
+            return RES_OK;
+        default:
+            return RES_PARERR;
+    }
+}
+
+// sd_async stand-in: one read in flight, delivered when it lands
+static struct {
+    bool busy;
+    bool landed;
+    FIL *fp;
+    FSIZE_t ofs;
+    uint8_t *buf;
+    UINT btr;
+    FRESULT res;
+    UINT bytes;
+    sd_async_done_t done;
+    void *arg;
+} async;
+static uint32_t async_reads;
+static uint32_t async_refused;
+
+FRESULT sd_async_read(FIL *fp, FSIZE_t ofs, void *buf, UINT btr, sd_async_done_t done, void *arg) {
+    if (async.busy) {
+        return FR_LOCKED;
+    }
+    if (btr == 0U || (ofs % SECTOR_SIZE) != 0U || (btr % SECTOR_SIZE) != 0U || ((uintptr_t)buf & 3U) != 0U ||
+        (rng() % 4U) == 0U) {
+        async_refused++;
+        return FR_INVALID_PARAMETER;
+    }
+    memset(buf, 0xA5, btr);  // What the window holds until the card's DMA lands
+    async.busy = true;
+    async.landed = false;
+    async.fp = fp;
+    async.ofs = ofs;
+    async.buf = (uint8_t *)buf;
+    async.btr = btr;
+    async.done = done;
+    async.arg = arg;
+    async_reads++;
+    return FR_OK;
+}
+
+FRESULT sd_async_write(FIL *fp, FSIZE_t ofs, const void *buf, UINT btw, sd_async_done_t done, void *arg) {
+    return FR_INVALID_PARAMETER;
+}
+
+bool sd_async_busy(void) {
+    return async.busy;
+}
+
+// Move the data the way the target does: by offset, leaving the FIL's own pointer alone
+void sd_async_wait(void) {
+    if (async.busy && !async.landed) {
+        FIL shadow = *async.fp;
+        async.landed = true;
+        async.bytes = 0U;
+        async.res = f_lseek(&shadow, async.ofs);
+        if (async.res == FR_OK) {
+            async.res = f_read(&shadow, async.buf, async.btr, &async.bytes);
+        }
+    }
+}
+
+bool sd_async_service(void) {
+    if (async.busy) {
+        sd_async_wait();
+        async.busy = false;
+        async.done(async.res, async.bytes, async.arg);
+    }
+    return false;
+}
+
+void sd_async_get_stats(sd_async_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+// What a stream should hand over next
+typedef struct {
+    sd_readahead_t ra;
+    const char *name;
+    FSIZE_t pos;
+    FSIZE_t end;
+    FSIZE_t loop;       // == end: no loop
+    uint32_t per_min;   // Bytes taken per period, min/max
+    uint32_t per_max;
+    uint32_t read_max;  // Largest single read
+    uint64_t handed;    // Bytes handed over since the stats were last taken
+    uint32_t ranges;
+} stream_t;
+
+static stream_t streams[2];
+
+static void fail(const stream_t *s, const char *what, uint32_t ofs) {
+    if (failures++ < 10U) {
+        fprintf(stderr, "%s at file offset %u: %s\n", s->name, ofs, what);
+    }
+}
+
+static void stream_start(stream_t *s, bool loops) {
+    uint32_t start = 44U + rng() % (BANK_SIZE / 2U);
+    uint32_t len = 1U + rng() % (BANK_SIZE - start - 1U);
+    if (loops) {
+        len = (len < 4096U) ? 4096U + rng() % 4096U : len;
+        len = (start + len > BANK_SIZE) ? BANK_SIZE - start : len;
+    }
+    s->pos = start;
+    s->end = start + len;
+    s->loop = loops ? start + rng() % len : s->end;
+    s->ranges++;
+    sd_readahead_start(&s->ra, &bank, s->pos, s->end, s->loop);
+}
+
+// The bytes the reader got: check them against the model and move it on
+static void stream_check(stream_t *s, const uint8_t *data, uint32_t n, uint32_t want) {
+    uint32_t expect = want;
+    if (s->loop == s->end && s->end - s->pos < expect) {
+        expect = (uint32_t)(s->end - s->pos);  // Short only at the end of a straight range
+    }
+    if (n != expect) {
+        fail(s, "wrong length", (uint32_t)s->pos);
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        if (s->pos == s->end) {
+            s->pos = s->loop;
+        }
+        if (data[i] != pattern((uint32_t)s->pos)) {
+            fail(s, "wrong byte", (uint32_t)s->pos);
+            break;
+        }
+        s->pos++;
+    }
+    s->handed += n;
+}
+
+// One period of the reader: a buffer's worth, in random pieces
+static void stream_period(stream_t *s) {
+    static uint8_t dst[SD_READAHEAD_SIZE + 3U] __attribute__((aligned(4)));
+    uint32_t left = s->per_min + rng() % (s->per_max - s->per_min + 1U);
+
+    if (s->pos == s->end && s->loop == s->end) {
+        stream_start(s, false);  // Range over: the next clip starts before a refill, as from an event
+    }
+    while (left != 0U && failures == 0U) {
+        uint32_t want = 1U + rng() % ((left < s->read_max) ? left : s->read_max);
+        const uint8_t *data;
+        uint32_t n;
+        if ((rng() % 2U) == 0U && sd_readahead_peek(&s->ra, &data) >= want) {
+            stream_check(s, data, want, want);  // In place, as a decoder takes it
+            sd_readahead_skip(&s->ra, want);
+            n = want;
+        } else {
+            uint8_t *out = &dst[rng() % 4U];  // Not always word aligned
+            n = sd_readahead_read(&s->ra, out, want);
+            stream_check(s, out, n, want);
+        }
+        left -= want;
+        if (n < want) {
+            break;  // Range over; the rest of the buffer is silence
+        }
+    }
+    sd_readahead_period(&s->ra);
+}
+
+// The main loop before it sleeps: land the read in flight, top the windows up
+static void idle_pass(bool complete) {
+    bool more;
+    do {
+        more = false;
+        if (sd_async_busy()) {
+            if (!complete && (rng() % 2U) == 0U) {
+                return;  // The read is still in flight at the next refill
+            }
+            (void)sd_async_service();
+            more = true;
+        }
+        for (uint32_t i = 0; i < 2U; i++) {
+            more = sd_readahead_fill(&streams[i].ra) || more;
+        }
+    } while (more && (complete || (rng() % 4U) != 0U));
+}
+
+static void run(const char *phase, uint32_t periods, bool skip_fills) {
+    uint32_t stalls_before[2];
+    uint32_t ranges_before[2];
+    for (uint32_t i = 0; i < 2U; i++) {
+        stalls_before[i] = streams[i].ra.stalls;
+        ranges_before[i] = streams[i].ranges;
+        streams[i].ra.fast_bytes = 0U;
+        streams[i].ra.copy_bytes = 0U;
+        streams[i].handed = 0U;
+    }
+
+    idle_pass(true);
+    for (uint32_t p = 0; p < periods && failures == 0U; p++) {
+        for (uint32_t i = 0; i < 2U; i++) {
+            stream_period(&streams[i]);
+        }
+        if (skip_fills && (rng() % 3U) == 0U) {
+            continue;  // The refill came before the main loop went idle
+        }
+        idle_pass(!skip_fills);
+    }
+
+    for (uint32_t i = 0; i < 2U; i++) {
+        stream_t *s = &streams[i];
+        uint32_t stalls = s->ra.stalls - stalls_before[i];
+        printf("%-6s %-8s %10llu bytes, %5u ranges, %5u stalls, %5.1f%% uncopied\n", phase, s->name,
+               (unsigned long long)s->handed, s->ranges - ranges_before[i], stalls,
+               (s->handed != 0U) ? 100.0 * s->ra.fast_bytes / (double)s->handed : 0.0);
+        if ((uint64_t)s->ra.fast_bytes + s->ra.copy_bytes != s->handed) {
+            fail(s, "copied + uncopied bytes do not add up to the bytes handed over", (uint32_t)s->pos);
+        }
+        if (!skip_fills && stalls != 0U) {
+            fail(s, "stalled although every idle pass ran", (uint32_t)s->pos);
+        }
+    }
+}
+
+static void check(FRESULT res, const char *what) {
+    if (res != FR_OK) {
+        fprintf(stderr, "%s failed: FRESULT %d\n", what, (int)res);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Fresh volume holding the bank file, then open it for the streams
+static void prepare(void) {
+    static uint8_t work[FF_MAX_SS];
+    static uint8_t chunk[4096];
+    const MKFS_PARM opt = {FM_FAT | FM_SFD, 2U, 1U, 512U, SECTOR_SIZE};
+    FIL f;
+    UINT done;
+
+    check(f_mkfs("0:", &opt, work, sizeof(work)), "f_mkfs");
+    check(f_mount(&volume, "0:", 1U), "f_mount");
+    check(f_open(&f, "0:/clips.bnk", FA_WRITE | FA_CREATE_ALWAYS), "bank create");
+    for (uint32_t ofs = 0; ofs < BANK_SIZE; ofs += sizeof(chunk)) {
+        UINT n = (BANK_SIZE - ofs < sizeof(chunk)) ? BANK_SIZE - ofs : sizeof(chunk);
+        for (UINT i = 0; i < n; i++) {
+            chunk[i] = pattern(ofs + i);
+        }
+        check(f_write(&f, chunk, n, &done), "bank write");
+    }
+    check(f_close(&f), "bank close");
+    check(f_open(&bank, "0:/clips.bnk", FA_READ), "bank open");
+}
+
+int main(int argc, char **argv) {
+    uint32_t periods = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : DEFAULT_PERIODS;
+    prepare();
+
+    // 44.1 kHz stereo PCM: 4 KB per buffer, straight through
+    streams[0].name = "pcm";
+    streams[0].per_min = 3072U;
+    streams[0].per_max = 4096U;
+    streams[0].read_max = 2048U;
+    stream_start(&streams[0], false);
+    // 8 kHz ADPCM: a few hundred bytes per buffer, looping
+    streams[1].name = "adpcm";
+    streams[1].per_min = 200U;
+    streams[1].per_max = 700U;
+    streams[1].read_max = 512U;
+    stream_start(&streams[1], true);
+
+    run("full", periods, false);
+    run("skip", periods, true);
+
+    printf("%u background reads, %u refused (f_read chunks instead)\n", async_reads, async_refused);
+    printf("%s\n", (failures == 0U) ? "PASS" : "FAIL");
+    return (failures == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
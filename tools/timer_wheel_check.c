@@ -0,0 +1,206 @@
+/*
+ * SEH500 Project - Host-side check of the timer wheel on a simulated clock
+ *
+ * Drives source/timer_wheel.c the way timer_service.c does in tickless
+ * mode: ask for the ticks to the next deadline, then advance by that much,
+ * by less (an early wake-up) or by more (a late interrupt or a long
+ * sleep). A model keeps each timer's absolute deadline. The test requires
+ * that:
+ *
+ *   - every timer fires exactly at its deadline (wheel time == model time),
+ *     periodic ones again every period, and none is missed or fires twice
+ *   - timer_wheel_ticks_to_next() is never 0 and never past the earliest
+ *     deadline, and says NO_EXPIRY only when nothing is armed
+ *
+ * Callbacks start, restart and cancel other timers (including ones due on
+ * the same tick) and cancel themselves, as the service allows. Delays run
+ * from 1 tick to past the top level's span, and the clock starts just below
+ * the 32-bit wrap so that is crossed too.
+ *
+ * Build: gcc -O2 -Wall -I../source -o timer_wheel_check timer_wheel_check.c ../source/timer_wheel.c
+ * Usage: ./timer_wheel_check [steps]
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timer_wheel.h"
+
+#define TIMER_COUNT   64U
+#define DEFAULT_STEPS 2000000U
+#define TOP_SPAN      (1UL << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS))
+
+typedef struct {
+    bool armed;
+    uint32_t expires;  // Absolute deadline while armed
+    uint32_t period;
+} model_timer_t;
+
+static timer_wheel_t wheel;
+static sw_timer_t timers[TIMER_COUNT];
+static model_timer_t model[TIMER_COUNT];
+static uint32_t failures;
+static uint32_t fired;
+static uint32_t callback_actions;
+
+static uint32_t rng_state = 88172645U;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void fail(const char *what, uint32_t id) {
+    if (failures++ < 10U) {
+        fprintf(stderr, "tick %u, timer %u: %s (model deadline %u)\n", wheel.now, id, what, model[id].expires);
+    }
+}
+
+// Mostly short delays, some long, a few past the top level
+static uint32_t random_delay(void) {
+    uint32_t pick = rng() % 100U;
+    if (pick < 70U) {
+        return rng() % 40U;  // 0 is taken as 1
+    }
+    if (pick < 95U) {
+        return rng() % 5000U;
+    }
+    if (pick < 99U) {
+        return rng() % (1U << 20);
+    }
+    return (uint32_t)(TOP_SPAN - 64U + rng() % (TOP_SPAN / 2U));
+}
+
+static void timer_callback(sw_timer_t *timer, void *arg);
+
+static void start(uint32_t id) {
+    uint32_t delay = random_delay();
+    uint32_t period = ((rng() % 4U) == 0U) ? 1U + rng() % 100U : 0U;
+    timer_wheel_start(&wheel, &timers[id], delay, period, timer_callback, (void *)(uintptr_t)id);
+    model[id].armed = true;
+    model[id].expires = wheel.now + ((delay == 0U) ? 1U : delay);
+    model[id].period = period;
+}
+
+static void cancel(uint32_t id) {
+    timer_wheel_cancel(&wheel, &timers[id]);
+    model[id].armed = false;
+}
+
+static void timer_callback(sw_timer_t *timer, void *arg) {
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+    fired++;
+    if (timer != &timers[id]) {
+        fail("callback got the wrong timer", id);
+    }
+    if (!model[id].armed) {
+        fail("fired while cancelled", id);
+        return;
+    }
+    if (wheel.now != model[id].expires) {
+        fail("fired off its deadline", id);
+    }
+    if (model[id].period != 0U) {
+        model[id].expires += model[id].period;
+    } else {
+        model[id].armed = false;
+    }
+
+    // What callbacks do on the target: touch other timers, or stop their own
+    switch (rng() % 8U) {
+        case 0:
+            start(rng() % TIMER_COUNT);
+            callback_actions++;
+            break;
+        case 1:
+            cancel(rng() % TIMER_COUNT);
+            callback_actions++;
+            break;
+        case 2:
+            cancel(id);
+            callback_actions++;
+            break;
+        default:
+            break;
+    }
+}
+
+// Earliest armed deadline, as ticks from now (UINT32_MAX if none)
+static uint32_t model_ticks_to_next(void) {
+    uint32_t best = UINT32_MAX;
+    for (uint32_t id = 0; id < TIMER_COUNT; id++) {
+        if (model[id].armed && model[id].expires - wheel.now < best) {
+            best = model[id].expires - wheel.now;
+        }
+    }
+    return best;
+}
+
+static void check_state(void) {
+    for (uint32_t id = 0; id < TIMER_COUNT; id++) {
+        if (model[id].armed != timers[id].active) {
+            fail(model[id].armed ? "armed timer not active" : "cancelled timer still active", id);
+        }
+        if (model[id].armed && (int32_t)(model[id].expires - wheel.now) <= 0) {
+            fail("deadline passed without firing", id);
+            model[id].armed = false;
+        }
+    }
+    uint32_t want = model_ticks_to_next();
+    uint32_t got = timer_wheel_ticks_to_next(&wheel);
+    if (want == UINT32_MAX) {
+        if (got != TIMER_WHEEL_NO_EXPIRY) {
+            fail("empty wheel reports a deadline", 0U);
+        }
+    } else if (got == 0U || got > want) {
+        fail("ticks to next out of range", 0U);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t steps = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : DEFAULT_STEPS;
+    timer_wheel_init(&wheel);
+    wheel.now = 0xFFFFFFFFU - 100000U;  // Cross the wrap early on
+
+    uint32_t start_now = wheel.now;
+    uint64_t elapsed = 0U;
+    for (uint32_t step = 0; step < steps && failures == 0U; step++) {
+        // Arm or drop timers from the "main loop" now and then
+        uint32_t pick = rng() % 16U;
+        if (pick < 3U) {
+            start(rng() % TIMER_COUNT);
+        } else if (pick == 3U) {
+            cancel(rng() % TIMER_COUNT);
+        }
+
+        uint32_t next = timer_wheel_ticks_to_next(&wheel);
+        uint32_t ticks;
+        if (next == TIMER_WHEEL_NO_EXPIRY) {
+            ticks = 1U + rng() % 1000U;  // Nothing pending: the clock still runs
+        } else {
+            switch (rng() % 4U) {
+                case 0:
+                    ticks = 1U + rng() % next;  // Woken early
+                    break;
+                case 1:
+                    ticks = next + rng() % (next + 100U);  // Late or long sleep
+                    break;
+                default:
+                    ticks = next;  // The PIT fires on time
+                    break;
+            }
+        }
+        timer_wheel_advance(&wheel, ticks);
+        elapsed += ticks;
+        check_state();
+    }
+
+    printf("%u timers fired over %llu ticks (clock %08X -> %08X), %u started/cancelled from callbacks\n", fired,
+           (unsigned long long)elapsed, start_now, wheel.now, callback_actions);
+    printf("%s\n", (failures == 0U) ? "PASS" : "FAIL");
+    return (failures == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,178 @@
+/*
+ * SEH500 Project - Host-side trace decoder
+ *
+ * Rebuilds log text from the binary records produced by source/trace_log.c
+ * (TRACE_LOG_BINARY = 1). Format strings come from source/trace_messages.h,
+ * compiled into this tool, so target and decoder always share one table.
+ *
+ * Each line starts with the record's timestamp and the time since the
+ * previous record, both in microseconds of running core time (the target
+ * converts cycles at whatever clock the clock mode manager had selected).
+ *
+ * Build: gcc -O2 -Wall -I../source -o trace_decode trace_decode.c
+ * Usage: stty -F /dev/ttyACM0 115200 raw && ./trace_decode < /dev/ttyACM0
+ *        ./trace_decode capture.bin
+ *
+ * Plain text (boot banners printed before binary mode) is passed through as-is.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace_messages.h"
+
+#define TRACE_SYNC_BYTE 0xA5U
+
+typedef struct {
+    const char *name;
+    unsigned nargs;
+    const char *format;
+} trace_entry_t;
+
+static const trace_entry_t trace_table[MSG_COUNT] = {
+#define TRACE_MESSAGE_ENTRY(id, nargs, fmt) {#id, nargs, fmt},
+    TRACE_MESSAGES(TRACE_MESSAGE_ENTRY)
+#undef TRACE_MESSAGE_ENTRY
+};
+
+static int read_bytes(FILE *in, uint8_t *buf, size_t len) {
+    return fread(buf, 1, len, in) == len;
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// printf one conversion spec with a 32-bit target argument, using the host type it names
+static void print_arg(const char *spec, size_t spec_len, uint32_t value) {
+    char fmt[32];
+    char conv = spec[spec_len - 1];
+    size_t keep = spec_len - 1;
+
+    if (spec_len >= sizeof(fmt)) {
+        fputs("<bad-format>", stdout);
+        return;
+    }
+    // Drop target length modifiers (l, h, hh) - the value is always 32 bits on the wire
+    while (keep > 1 && (spec[keep - 1] == 'l' || spec[keep - 1] == 'h')) {
+        keep--;
+    }
+    memcpy(fmt, spec, keep);
+
+    switch (conv) {
+        case 'd':
+        case 'i':
+            fmt[keep] = conv;
+            fmt[keep + 1] = '\0';
+            printf(fmt, (int)(int32_t)value);
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            fmt[keep] = conv;
+            fmt[keep + 1] = '\0';
+            printf(fmt, (unsigned)value);
+            break;
+        case 'c':
+            fmt[keep] = 'c';
+            fmt[keep + 1] = '\0';
+            printf(fmt, (int)(value & 0xFFU));
+            break;
+        case 'p':
+            printf("0x%08X", (unsigned)value);
+            break;
+        default:
+            // Strings cannot travel as a 32-bit argument
+            printf("<%%%c:0x%08X>", conv, (unsigned)value);
+            break;
+    }
+}
+
+static void print_message(const trace_entry_t *entry, const uint32_t *args) {
+    const char *p = entry->format;
+    unsigned argi = 0;
+
+    while (*p != '\0') {
+        if (*p != '%') {
+            // Print line endings as a single newline
+            if (*p != '\r') {
+                putchar(*p);
+            }
+            p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            putchar('%');
+            p += 2;
+            continue;
+        }
+        // Find the end of the conversion spec: %[flags][width][.prec][length]conv
+        size_t len = 1;
+        while (p[len] != '\0' && strchr("-+ #0123456789.lh", p[len]) != NULL) {
+            len++;
+        }
+        if (p[len] == '\0') {
+            break;
+        }
+        len++;
+        print_arg(p, len, (argi < entry->nargs) ? args[argi] : 0U);
+        argi++;
+        p += len;
+    }
+}
+
+int main(int argc, char **argv) {
+    FILE *in = stdin;
+    uint32_t last_ts = 0;
+    int have_last = 0;
+
+    if (argc > 1 && (in = fopen(argv[1], "rb")) == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        if ((unsigned)c != TRACE_SYNC_BYTE) {
+            putchar(c);  // Plain text outside binary records
+            continue;
+        }
+
+        uint8_t header[6];
+        if (!read_bytes(in, header, sizeof(header))) {
+            break;
+        }
+        unsigned id = (unsigned)header[0] | ((unsigned)header[1] << 8);
+        uint32_t ts = get_u32(&header[2]);
+        if (id >= MSG_COUNT) {
+            printf("[decode] unknown message id %u - resyncing\n", id);
+            continue;
+        }
+
+        const trace_entry_t *entry = &trace_table[id];
+        uint8_t raw[4 * 8];
+        uint32_t args[8] = {0};
+        if (entry->nargs > 8U || !read_bytes(in, raw, 4U * entry->nargs)) {
+            break;
+        }
+        for (unsigned i = 0; i < entry->nargs; i++) {
+            args[i] = get_u32(&raw[4 * i]);
+        }
+
+        // The microsecond count wraps every ~71 minutes; unsigned subtraction handles one wrap
+        uint32_t delta_us = have_last ? (uint32_t)(ts - last_ts) : 0U;
+        last_ts = ts;
+        have_last = 1;
+        printf("[%10u us +%9u us] ", (unsigned)ts, (unsigned)delta_us);
+        print_message(entry, args);
+    }
+
+    if (in != stdin) {
+        fclose(in);
+    }
+    return 0;
+}
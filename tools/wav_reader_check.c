@@ -0,0 +1,591 @@
+/*
+ * SEH500 Project - Host-side corpus check and throughput test for the WAV reader
+ *
+ * Builds source/wav_reader.c (with the portable wav_chunk_lookup() it has
+ * for non-ARM builds) and feeds it a corpus of generated files the way
+ * audio_player.c does: pieces of random size, from single bytes to whole
+ * sectors, walking on past the data chunk for trailing cue chunks, and
+ * sometimes seeking over wav_reader_pending_skip() instead of feeding it.
+ * Every file carries the result it must give - status, format fields, data
+ * offset and length, cue count and points - and is run many times with
+ * different piece sizes. The corpus covers:
+ *
+ *   - the canonical 44-byte header, fmt of 16, 17 (odd, padded) and 18 bytes
+ *   - LIST/INFO, JUNK, bext and unknown chunks, odd sizes with their pad byte,
+ *     before fmt, between fmt and data and after data
+ *   - WAVE_FORMAT_EXTENSIBLE (reduced to its sub-format), IMA ADPCM with fact
+ *   - cue chunks before and after data, more cues than WAV_MAX_CUES
+ *   - streaming writers' data sizes (0 and 0xFFFFFFFF)
+ *   - files cut short at every kind of point (playable once the data header
+ *     is in, rejected before that)
+ *   - rejects: data before fmt, a missing pad byte, float data, not RIFF
+ *
+ * Files named on the command line are added to the corpus: they must give
+ * the same result whatever the piece sizes. Last, the parse rate is
+ * measured in MB/s over the corpus, feeding every byte in sector-sized
+ * pieces and in 3-byte ones (every field split, a feed call per 3 bytes).
+ *
+ * Build: gcc -O2 -Wall -I../source -o wav_reader_check wav_reader_check.c
+ * Usage: ./wav_reader_check [file.wav ...]
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ---- Stand-in for the cycle counter (only wav_reader_benchmark uses it) ----
+
+#define CYCLE_COUNTER_H_
+
+static uint32_t cycle_counter_now(void) {
+    return 0U;
+}
+
+#include "wav_reader.c"
+
+#define FILE_MAX       (256U * 1024U)
+#define RANDOM_FILES   3000U
+#define RUNS_PER_FILE  24U
+#define BENCH_SECONDS  0.5
+
+typedef struct {
+    char name[64];
+    uint8_t *bytes;
+    uint32_t len;
+    // Expected result (info and cues only checked for WAV_STATUS_DONE)
+    wav_status_t want;
+    wav_info_t info;
+    uint32_t cue_count;
+    uint32_t cue_points[WAV_MAX_CUES];
+    uint32_t cue_end;    // Offset just past the cue chunk (0 if none)
+    bool check_cues;
+} wav_case_t;
+
+static uint32_t failures;
+static uint32_t rng_state = 362436069U;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// ---- Building files ----
+
+static void put8(wav_case_t *c, uint32_t v) {
+    if (c->len < FILE_MAX) {
+        c->bytes[c->len] = (uint8_t)v;
+    }
+    c->len++;
+}
+
+static void put16(wav_case_t *c, uint32_t v) {
+    put8(c, v);
+    put8(c, v >> 8);
+}
+
+static void put32(wav_case_t *c, uint32_t v) {
+    put16(c, v);
+    put16(c, v >> 16);
+}
+
+static void put_id(wav_case_t *c, const char *id) {
+    for (uint32_t i = 0; i < 4U; i++) {
+        put8(c, (uint8_t)id[i]);
+    }
+}
+
+static void begin(wav_case_t *c, const char *name) {
+    snprintf(c->name, sizeof(c->name), "%s", name);
+    c->len = 0U;
+    c->want = WAV_STATUS_DONE;
+    memset(&c->info, 0, sizeof(c->info));
+    c->cue_count = 0U;
+    c->cue_end = 0U;
+    c->check_cues = true;
+    put_id(c, "RIFF");
+    put32(c, 0U);  // Patched by finish()
+    put_id(c, "WAVE");
+}
+
+static void finish(wav_case_t *c) {
+    uint32_t size = c->len - 8U;
+    memcpy(&c->bytes[4], &size, 4U);
+}
+
+// A chunk with filler body of `size` bytes; the pad byte is added for odd sizes unless told not to
+static void chunk(wav_case_t *c, const char *id, uint32_t size, bool pad) {
+    put_id(c, id);
+    put32(c, size);
+    for (uint32_t i = 0; i < size; i++) {
+        put8(c, 'a' + (i % 26U));
+    }
+    if (pad && (size & 1U) != 0U) {
+        put8(c, 0U);
+    }
+}
+
+static void list_info(wav_case_t *c) {
+    uint32_t text = 1U + rng() % 40U;
+    put_id(c, "LIST");
+    put32(c, 4U + 8U + text);
+    put_id(c, "INFO");
+    put_id(c, "INAM");
+    put32(c, text);
+    for (uint32_t i = 0; i < text; i++) {
+        put8(c, (i + 1U == text) ? 0U : 'A' + (i % 26U));
+    }
+    if ((text & 1U) != 0U) {
+        put8(c, 0U);
+    }
+}
+
+static void fmt_pcm(wav_case_t *c, uint32_t fmt_size, uint32_t format, uint32_t channels, uint32_t rate,
+                    uint32_t bits) {
+    uint32_t align = channels * ((bits + 7U) / 8U);
+    put_id(c, "fmt ");
+    put32(c, fmt_size);
+    put16(c, format);
+    put16(c, channels);
+    put32(c, rate);
+    put32(c, rate * align);
+    put16(c, align);
+    put16(c, bits);
+    for (uint32_t i = 16U; i < fmt_size; i++) {
+        put8(c, 0U);  // cbSize and padding
+    }
+    if ((fmt_size & 1U) != 0U) {
+        put8(c, 0U);
+    }
+    c->info = (wav_info_t){(uint16_t)format, (uint16_t)channels, rate, rate * align, (uint16_t)align,
+                           (uint16_t)bits, 0U, 0U};
+}
+
+static void fmt_extensible(wav_case_t *c, uint32_t channels, uint32_t rate, uint32_t bits) {
+    static const uint8_t guid_tail[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80,
+                                          0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+    uint32_t align = channels * ((bits + 7U) / 8U);
+    put_id(c, "fmt ");
+    put32(c, 40U);
+    put16(c, WAV_FORMAT_EXTENSIBLE);
+    put16(c, channels);
+    put32(c, rate);
+    put32(c, rate * align);
+    put16(c, align);
+    put16(c, bits);
+    put16(c, 22U);                // cbSize
+    put16(c, bits);               // Valid bits
+    put32(c, (1U << channels) - 1U);
+    put16(c, WAV_FORMAT_PCM);     // Sub-format GUID
+    for (uint32_t i = 0; i < sizeof(guid_tail); i++) {
+        put8(c, guid_tail[i]);
+    }
+    c->info = (wav_info_t){WAV_FORMAT_PCM, (uint16_t)channels, rate, rate * align, (uint16_t)align,
+                           (uint16_t)bits, 0U, 0U};
+}
+
+static void fmt_adpcm(wav_case_t *c, uint32_t channels, uint32_t rate) {
+    uint32_t align = 256U * channels;
+    uint32_t frames = ADPCM_BLOCK_FRAMES(align, channels);
+    put_id(c, "fmt ");
+    put32(c, 20U);
+    put16(c, WAV_FORMAT_IMA_ADPCM);
+    put16(c, channels);
+    put32(c, rate);
+    put32(c, rate * align / frames);
+    put16(c, align);
+    put16(c, 4U);
+    put16(c, 2U);                 // cbSize
+    put16(c, frames);             // Samples per block
+    c->info = (wav_info_t){WAV_FORMAT_IMA_ADPCM, (uint16_t)channels, rate, rate * align / frames,
+                           (uint16_t)align, 4U, 0U, 0U};
+    put_id(c, "fact");
+    put32(c, 4U);
+    put32(c, frames * 3U);
+}
+
+// Data chunk; size_field is what the header claims (the body is `size` bytes)
+static void data(wav_case_t *c, uint32_t size, uint32_t size_field) {
+    put_id(c, "data");
+    put32(c, size_field);
+    c->info.dataOffset = c->len;
+    c->info.dataSize = size;
+    for (uint32_t i = 0; i < size; i++) {
+        put8(c, i * 7U);
+    }
+    if ((size & 1U) != 0U) {
+        put8(c, 0U);
+    }
+}
+
+static void cues(wav_case_t *c, uint32_t count) {
+    put_id(c, "cue ");
+    put32(c, 4U + 24U * count);
+    put32(c, count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t offset = rng() % 100000U;
+        put32(c, i + 1U);
+        put32(c, 0U);
+        put_id(c, "data");
+        put32(c, 0U);
+        put32(c, 0U);
+        put32(c, offset);
+        if (i < WAV_MAX_CUES) {
+            c->cue_points[i] = offset;
+        }
+    }
+    c->cue_count = count;
+    c->cue_end = c->len;
+}
+
+// Chunks a tool might leave anywhere outside fmt and data
+static void random_extras(wav_case_t *c, uint32_t max) {
+    for (uint32_t n = rng() % (max + 1U); n != 0U; n--) {
+        switch (rng() % 4U) {
+            case 0:
+                list_info(c);
+                break;
+            case 1:
+                chunk(c, "JUNK", rng() % 64U, true);
+                break;
+            case 2:
+                chunk(c, "bext", 602U + rng() % 9U, true);  // Fixed part plus a coding history
+                break;
+            default:
+                chunk(c, "abcd", 1U + rng() % 33U, true);   // Unknown, often odd
+                break;
+        }
+    }
+}
+
+static void random_file(wav_case_t *c, uint32_t index) {
+    char name[64];
+    snprintf(name, sizeof(name), "random #%u", index);
+    begin(c, name);
+    random_extras(c, 3U);
+
+    uint32_t channels = 1U + rng() % 2U;
+    uint32_t rates[] = {8000U, 11025U, 22050U, 44100U, 48000U};
+    uint32_t rate = rates[rng() % 5U];
+    switch (rng() % 4U) {
+        case 0:
+            fmt_extensible(c, channels, rate, (rng() % 2U) ? 16U : 24U);
+            break;
+        case 1:
+            fmt_adpcm(c, channels, rate);
+            break;
+        default: {
+            uint32_t sizes[] = {16U, 17U, 18U};
+            fmt_pcm(c, sizes[rng() % 3U], WAV_FORMAT_PCM, channels, rate, 8U << (rng() % 2U));
+            break;
+        }
+    }
+    random_extras(c, 2U);
+    bool cue_after = (rng() % 2U) != 0U;
+    if (!cue_after && (rng() % 2U) != 0U) {
+        cues(c, rng() % 12U);
+    }
+    uint32_t size = rng() % 40000U;
+    data(c, size, size);
+    random_extras(c, 2U);
+    if (cue_after && (rng() % 2U) != 0U) {
+        cues(c, rng() % 12U);
+    }
+    random_extras(c, 1U);
+    finish(c);
+}
+
+// Fixed cases for what random files rarely hit
+static uint32_t fixed_files(wav_case_t *cases) {
+    uint32_t n = 0;
+    wav_case_t *c;
+
+    c = &cases[n++];
+    begin(c, "canonical 44-byte header");
+    fmt_pcm(c, 16U, WAV_FORMAT_PCM, 2U, 44100U, 16U);
+    data(c, 1000U, 1000U);
+    finish(c);
+
+    c = &cases[n++];
+    begin(c, "LIST/INFO, bext, odd chunks around fmt");
+    list_info(c);
+    chunk(c, "bext", 603U, true);
+    fmt_pcm(c, 18U, WAV_FORMAT_PCM, 1U, 22050U, 16U);
+    chunk(c, "abcd", 7U, true);
+    list_info(c);
+    data(c, 333U, 333U);
+    list_info(c);
+    finish(c);
+
+    c = &cases[n++];
+    begin(c, "EXTENSIBLE, trailing cues");
+    fmt_extensible(c, 2U, 48000U, 24U);
+    data(c, 600U, 600U);
+    cues(c, 3U);
+    finish(c);
+
+    c = &cases[n++];
+    begin(c, "IMA ADPCM with fact");
+    fmt_adpcm(c, 1U, 22050U);
+    data(c, 1024U, 1024U);
+    finish(c);
+
+    c = &cases[n++];
+    begin(c, "more cues than kept");
+    fmt_pcm(c, 16U, WAV_FORMAT_PCM, 1U, 8000U, 8U);
+    cues(c, WAV_MAX_CUES + 5U);
+    data(c, 10U, 10U);
+    finish(c);
+
+    c = &cases[n++];
+    begin(c, "streaming data size 0");
+    fmt_pcm(c, 16U, WAV_FORMAT_PCM, 1U, 8000U, 16U);
+    data(c, 400U, 0U);
+    finish(c);
+
+    c = &cases[n++];
+    begin(c, "streaming data and RIFF size ~0");
+    fmt_pcm(c, 16U, WAV_FORMAT_PCM, 1U, 8000U, 16U);
+    data(c, 400U, 0xFFFFFFFFU);
+    memset(&c->bytes[4], 0xFF, 4U);  // No finish(): the RIFF size is unknown too
+    c->info.dataSize = 0xFFFFFFFFU - c->info.dataOffset;
+
+    c = &cases[n++];
+    begin(c, "data before fmt");
+    chunk(c, "data", 8U, true);
+    fmt_pcm(c, 16U, WAV_FORMAT_PCM, 1U, 8000U, 16U);
+    finish(c);
+    c->want = WAV_STATUS_INVALID;
+
+    c = &cases[n++];
+    begin(c, "odd chunk without its pad byte");
+    chunk(c, "abcd", 5U, false);
+    fmt_pcm(c, 16U, WAV_FORMAT_PCM, 1U, 8000U, 16U);
+    data(c, 10U, 10U);
+    finish(c);
+    c->want = WAV_STATUS_INVALID;
+
+    c = &cases[n++];
+    begin(c, "float samples");
+    fmt_pcm(c, 16U, 0x0003U, 1U, 8000U, 32U);
+    data(c, 16U, 16U);
+    finish(c);
+    c->want = WAV_STATUS_INVALID;
+
+    c = &cases[n++];
+    begin(c, "not RIFF");
+    fmt_pcm(c, 16U, WAV_FORMAT_PCM, 1U, 8000U, 16U);
+    data(c, 16U, 16U);
+    finish(c);
+    memcpy(c->bytes, "RIFX", 4U);
+    c->want = WAV_STATUS_INVALID;
+    return n;
+}
+
+// Cut a finished file short: playable once the data header is in
+static void truncate_file(wav_case_t *dst, const wav_case_t *src, uint32_t cut) {
+    uint8_t *bytes = dst->bytes;
+    *dst = *src;
+    dst->bytes = bytes;
+    memcpy(dst->bytes, src->bytes, cut);
+    dst->len = cut;
+    snprintf(dst->name, sizeof(dst->name), "%.40s cut at %u", src->name, cut);
+    if (src->want == WAV_STATUS_DONE && cut < src->info.dataOffset) {
+        dst->want = WAV_STATUS_INVALID;
+    }
+    dst->check_cues = (src->cue_end == 0U || cut >= src->cue_end);
+}
+
+// ---- Running the reader ----
+
+static uint32_t piece_size(uint32_t left) {
+    uint32_t size;
+    switch (rng() % 3U) {
+        case 0:
+            size = 1U + rng() % 4U;    // Splits every field
+            break;
+        case 1:
+            size = 1U + rng() % 64U;
+            break;
+        default:
+            size = 1U + rng() % 4096U;
+            break;
+    }
+    return (size < left) ? size : left;
+}
+
+// Feed a whole file; pieces 0 = random sizes. Seeks over skips when asked.
+static wav_status_t run(const uint8_t *bytes, uint32_t len, wav_reader_t *reader, uint32_t pieces, bool seek) {
+    uint32_t offset = 0;
+    wav_reader_init(reader);
+    while (offset < len) {
+        uint32_t skip = wav_reader_pending_skip(reader);
+        if (seek && skip != 0U) {
+            skip = (skip < len - offset) ? skip : (len - offset);  // A seek past the end stops there
+            wav_reader_skipped(reader, skip);
+            offset += skip;
+            continue;
+        }
+        uint32_t piece = (pieces != 0U) ? ((pieces < len - offset) ? pieces : (len - offset)) : piece_size(len - offset);
+        uint32_t used = 0;
+        wav_status_t status = wav_reader_feed(reader, &bytes[offset], piece, &used);
+        offset += used;
+        if (status == WAV_STATUS_DONE || status == WAV_STATUS_INVALID) {
+            return status;
+        }
+        // WAV_STATUS_DATA: walk on past the samples for trailing cue chunks
+    }
+    return wav_reader_end(reader);
+}
+
+static void fail(const wav_case_t *c, uint32_t run_index, const char *what) {
+    if (failures++ < 10U) {
+        fprintf(stderr, "%s (run %u): %s\n", c->name, run_index, what);
+    }
+}
+
+static void check(const wav_case_t *c, uint32_t runs) {
+    for (uint32_t i = 0; i < runs; i++) {
+        wav_reader_t reader;
+        wav_status_t status = run(c->bytes, c->len, &reader, (i == 0U) ? c->len : 0U, (i % 2U) != 0U);
+        if (status != c->want) {
+            fail(c, i, (status == WAV_STATUS_DONE) ? "accepted, should be rejected" : "rejected, should be accepted");
+            continue;
+        }
+        if (status != WAV_STATUS_DONE) {
+            continue;
+        }
+        const wav_info_t *got = &reader.info;
+        const wav_info_t *want = &c->info;
+        if (got->audioFormat != want->audioFormat || got->numChannels != want->numChannels ||
+            got->sampleRate != want->sampleRate || got->byteRate != want->byteRate ||
+            got->blockAlign != want->blockAlign || got->bitsPerSample != want->bitsPerSample) {
+            fail(c, i, "wrong format");
+        }
+        if (got->dataOffset != want->dataOffset || got->dataSize != want->dataSize) {
+            fail(c, i, "wrong data offset or length");
+        }
+        if (c->check_cues) {
+            bool ok = (reader.cue_count == c->cue_count);
+            for (uint32_t k = 0; ok && k < c->cue_count && k < WAV_MAX_CUES; k++) {
+                ok = (reader.cue_points[k] == c->cue_points[k]);
+            }
+            if (!ok) {
+                fail(c, i, "wrong cue points");
+            }
+        }
+    }
+}
+
+// Files from the command line: every way of feeding must agree with one big piece
+static uint32_t check_file(const char *path, wav_case_t *c) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        failures++;
+        return 0U;
+    }
+    c->len = (uint32_t)fread(c->bytes, 1, FILE_MAX, f);
+    fclose(f);
+    snprintf(c->name, sizeof(c->name), "%.63s", path);
+
+    wav_reader_t reader;
+    c->want = run(c->bytes, c->len, &reader, c->len, false);
+    c->info = reader.info;
+    c->cue_count = reader.cue_count;
+    memcpy(c->cue_points, reader.cue_points, sizeof(c->cue_points));
+    c->cue_end = 0U;
+    c->check_cues = true;
+    if (c->want == WAV_STATUS_DONE) {
+        printf("%s: format 0x%04X, %u ch, %u Hz, %u bits, data %u bytes at %u, %u cues\n", path,
+               reader.info.audioFormat, reader.info.numChannels, reader.info.sampleRate,
+               reader.info.bitsPerSample, reader.info.dataSize, reader.info.dataOffset, reader.cue_count);
+    } else {
+        printf("%s: rejected\n", path);
+    }
+    check(c, RUNS_PER_FILE * 8U);
+    return c->len;
+}
+
+static double seconds(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// MB/s over the corpus, every byte fed in pieces of the given size
+static double bench(const wav_case_t *cases, uint32_t count, uint32_t pieces) {
+    uint64_t bytes = 0;
+    uint32_t sink = 0;
+    double start = seconds();
+    double elapsed;
+    do {
+        for (uint32_t i = 0; i < count; i++) {
+            wav_reader_t reader;
+            sink += (uint32_t)run(cases[i].bytes, cases[i].len, &reader, pieces, false) + reader.info.dataSize;
+            bytes += cases[i].len;
+        }
+        elapsed = seconds() - start;
+    } while (elapsed < BENCH_SECONDS);
+    if (sink == 0xFFFFFFFFU) {
+        printf(" ");  // Keeps the runs from being optimised away
+    }
+    return (double)bytes / elapsed / 1e6;
+}
+
+int main(int argc, char **argv) {
+    uint32_t total = 64U + RANDOM_FILES + (uint32_t)argc;
+    wav_case_t *cases = calloc(total, sizeof(*cases));
+    wav_case_t cut = {0};
+    cut.bytes = malloc(FILE_MAX);
+    if (cases == NULL || cut.bytes == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    for (uint32_t i = 0; i < total; i++) {
+        if ((cases[i].bytes = malloc(FILE_MAX)) == NULL) {
+            fprintf(stderr, "out of memory\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    uint32_t count = fixed_files(cases);
+    uint32_t fixed = count;
+    for (uint32_t i = 0; i < RANDOM_FILES; i++) {
+        random_file(&cases[count++], i);
+    }
+
+    uint32_t truncated = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (cases[i].len > FILE_MAX) {
+            fail(&cases[i], 0U, "too big for the test buffer");
+            continue;
+        }
+        check(&cases[i], RUNS_PER_FILE);
+        // Cut short at a few points, including just before and at the data header's end
+        uint32_t points[4] = {rng() % cases[i].len, cases[i].info.dataOffset - 1U, cases[i].info.dataOffset,
+                              cases[i].info.dataOffset + rng() % (cases[i].info.dataSize / 2U + 1U)};
+        for (uint32_t p = 0; p < 4U && cases[i].want == WAV_STATUS_DONE; p++) {
+            if (points[p] >= 12U && points[p] < cases[i].len) {
+                truncate_file(&cut, &cases[i], points[p]);
+                check(&cut, RUNS_PER_FILE / 4U);
+                truncated++;
+            }
+        }
+    }
+    printf("%u fixed and %u random files, %u truncations, %u runs each\n", fixed, count - fixed, truncated,
+           RUNS_PER_FILE);
+
+    for (int i = 1; i < argc; i++) {
+        (void)check_file(argv[i], &cases[count++]);
+    }
+
+    printf("512-byte pieces: %8.1f MB/s\n", bench(cases, count, 512U));
+    printf("  3-byte pieces: %8.1f MB/s\n", bench(cases, count, 3U));
+    printf("%s\n", (failures == 0U) ? "PASS" : "FAIL");
+    return (failures == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}